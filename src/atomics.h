@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * Minimal atomic operations and a spinlock for the concurrent containers.
+ * These are thin wrappers around the GCC/clang __atomic builtins, which
+ * don't depend on any runtime library and so also work in kernel code.
+ */
+
+#ifndef GENCCONT_ATOMICS_H
+#define GENCCONT_ATOMICS_H
+
+#include "util.h"
+
+#if !defined(__GNUC__)
+#error The concurrent containers currently require GCC-compatible __atomic builtins
+#endif
+
+#define genc_atomic_load_relaxed(PTR) __atomic_load_n((PTR), __ATOMIC_RELAXED)
+#define genc_atomic_load_acquire(PTR) __atomic_load_n((PTR), __ATOMIC_ACQUIRE)
+#define genc_atomic_store_relaxed(PTR, VAL) __atomic_store_n((PTR), (VAL), __ATOMIC_RELAXED)
+#define genc_atomic_store_release(PTR, VAL) __atomic_store_n((PTR), (VAL), __ATOMIC_RELEASE)
+#define genc_atomic_fetch_add(PTR, VAL) __atomic_fetch_add((PTR), (VAL), __ATOMIC_ACQ_REL)
+#define genc_atomic_fetch_sub(PTR, VAL) __atomic_fetch_sub((PTR), (VAL), __ATOMIC_ACQ_REL)
+#define genc_atomic_exchange(PTR, VAL) __atomic_exchange_n((PTR), (VAL), __ATOMIC_ACQ_REL)
+/* Strong compare-and-swap; on failure, *EXPECTED_PTR is updated with the current value. */
+#define genc_atomic_cas(PTR, EXPECTED_PTR, DESIRED) \
+	__atomic_compare_exchange_n((PTR), (EXPECTED_PTR), (DESIRED), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define genc_atomic_thread_fence_acquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define genc_atomic_thread_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Spin-wait hint to the CPU */
+static GENC_INLINE void genc_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+/* Test-and-test-and-set spinlock. Zero-initialised means unlocked. */
+struct genc_spinlock
+{
+	int locked;
+};
+typedef struct genc_spinlock genc_spinlock_t;
+
+static GENC_INLINE void genc_spinlock_init(genc_spinlock_t* lock)
+{
+	lock->locked = 0;
+}
+
+static GENC_INLINE genc_bool_t genc_spinlock_trylock(genc_spinlock_t* lock)
+{
+	return !__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE);
+}
+
+static GENC_INLINE void genc_spinlock_lock(genc_spinlock_t* lock)
+{
+	while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+	{
+		/* wait for it to look free before hammering the cache line again */
+		while (genc_atomic_load_relaxed(&lock->locked))
+			genc_cpu_relax();
+	}
+}
+
+static GENC_INLINE void genc_spinlock_unlock(genc_spinlock_t* lock)
+{
+	genc_atomic_store_release(&lock->locked, 0);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -28,12 +28,37 @@
 
 static genc_bt_node_head_t* genc_bt_rightmost_in_subtree(genc_bt_node_head_t* subtree);
 static genc_bt_node_head_t* genc_bt_leftmost_in_subtree(genc_bt_node_head_t* subtree);
+static void genc_bt_rb_insert_fixup(genc_binary_tree_t* tree, genc_bt_node_head_t* item);
+static void genc_bt_rb_remove(genc_binary_tree_t* tree, genc_bt_node_head_t* item);
 
 void genc_binary_tree_init(genc_binary_tree_t* tree, genc_binary_tree_less_fn less_fn, void* less_fn_opaque)
 {
 	tree->root = tree->min_node = tree->max_node = NULL;
 	tree->less_fn = less_fn;
 	tree->less_fn_opaque = less_fn_opaque;
+	tree->red_black = 0;
+	tree->update_fn = NULL;
+}
+
+void genc_binary_tree_init_rb(genc_binary_tree_t* tree, genc_binary_tree_less_fn less_fn, void* less_fn_opaque)
+{
+	genc_binary_tree_init(tree, less_fn, less_fn_opaque);
+	tree->red_black = 1;
+}
+
+void genc_bt_set_update_fn(genc_binary_tree_t* tree, genc_binary_tree_update_fn update_fn)
+{
+	assert(tree->root == NULL);
+	tree->update_fn = update_fn;
+}
+
+void genc_bt_propagate_update(genc_binary_tree_t* tree, genc_bt_node_head_t* node)
+{
+	genc_binary_tree_update_fn update = tree->update_fn;
+	if (!update)
+		return;
+	for (; node; node = node->parent)
+		update(node, tree->less_fn_opaque);
 }
 
 genc_bt_node_head_t** genc_bt_find_insertion_point(genc_binary_tree_t* tree, genc_bt_node_head_t* item, genc_bt_node_head_t** out_parent)
@@ -66,11 +91,13 @@ genc_bool_t genc_bt_insert(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 {
 	item->left = NULL;
 	item->right = NULL;
+	item->colour = GENC_BT_BLACK;
 	if (!tree->root)
 	{
 		/* Inserting into empty tree. */
 		tree->root = tree->min_node = tree->max_node = item;
 		item->parent = NULL;
+		genc_bt_propagate_update(tree, item);
 		return 1;
 	}
 			
@@ -94,6 +121,13 @@ genc_bool_t genc_bt_insert(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 		tree->max_node = item;
 	}
 	
+	genc_bt_propagate_update(tree, item);
+	if (tree->red_black)
+	{
+		item->colour = GENC_BT_RED;
+		genc_bt_rb_insert_fixup(tree, item);
+	}
+	
 	return 1;
 }
 
@@ -101,6 +135,11 @@ void genc_bt_remove(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 {
 	genc_bt_node_head_t* replacement = NULL;
 	genc_bt_node_head_t** parent_child_ref = NULL;
+	if (tree->red_black)
+	{
+		genc_bt_rb_remove(tree, item);
+		return;
+	}
 	if (item->left)
 	{
 		if (item->right)
@@ -148,6 +187,7 @@ void genc_bt_remove(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 	}
 	
 	*parent_child_ref = replacement;
+	genc_bt_propagate_update(tree, replacement ? replacement : item->parent);
 	
 	if (item == tree->max_node)
 		tree->max_node = replacement ? genc_bt_rightmost_in_subtree(replacement) : item->parent;
@@ -160,6 +200,275 @@ void genc_bt_remove(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 }
 
 
+/* Returns the reference through which node is linked into the tree: either
+ * its parent's left or right pointer, or the tree's root pointer. */
+static genc_bt_node_head_t** genc_bt_parent_ref(genc_binary_tree_t* tree, genc_bt_node_head_t* node)
+{
+	genc_bt_node_head_t* parent = node->parent;
+	if (!parent)
+	{
+		assert(node == tree->root);
+		return &tree->root;
+	}
+	if (parent->left == node)
+		return &parent->left;
+	assert(parent->right == node);
+	return &parent->right;
+}
+
+/* Rotates x's right child y up into x's position, x becomes y's left child and
+ * y's former left subtree becomes x's right subtree. */
+static void genc_bt_rotate_left(genc_binary_tree_t* tree, genc_bt_node_head_t* x)
+{
+	genc_bt_node_head_t* y = x->right;
+	genc_bt_node_head_t** x_ref = genc_bt_parent_ref(tree, x);
+	x->right = y->left;
+	if (y->left)
+		y->left->parent = x;
+	y->parent = x->parent;
+	*x_ref = y;
+	y->left = x;
+	x->parent = y;
+	if (tree->update_fn)
+	{
+		/* x is now y's child, so must be updated first */
+		tree->update_fn(x, tree->less_fn_opaque);
+		tree->update_fn(y, tree->less_fn_opaque);
+	}
+}
+
+/* Mirror image of genc_bt_rotate_left() */
+static void genc_bt_rotate_right(genc_binary_tree_t* tree, genc_bt_node_head_t* x)
+{
+	genc_bt_node_head_t* y = x->left;
+	genc_bt_node_head_t** x_ref = genc_bt_parent_ref(tree, x);
+	x->left = y->right;
+	if (y->right)
+		y->right->parent = x;
+	y->parent = x->parent;
+	*x_ref = y;
+	y->right = x;
+	x->parent = y;
+	if (tree->update_fn)
+	{
+		tree->update_fn(x, tree->less_fn_opaque);
+		tree->update_fn(y, tree->less_fn_opaque);
+	}
+}
+
+static GENC_INLINE genc_bool_t genc_bt_is_red(genc_bt_node_head_t* node)
+{
+	return node && node->colour == GENC_BT_RED;
+}
+
+/* Restores the red-black invariants after inserting the red node 'item'. */
+static void genc_bt_rb_insert_fixup(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
+{
+	genc_bt_node_head_t* parent;
+	while ((parent = item->parent) && parent->colour == GENC_BT_RED)
+	{
+		/* parent is red, so it can't be the root; grandparent must exist */
+		genc_bt_node_head_t* grandparent = parent->parent;
+		if (parent == grandparent->left)
+		{
+			genc_bt_node_head_t* uncle = grandparent->right;
+			if (genc_bt_is_red(uncle))
+			{
+				/* push blackness down from the grandparent, continue further up */
+				parent->colour = GENC_BT_BLACK;
+				uncle->colour = GENC_BT_BLACK;
+				grandparent->colour = GENC_BT_RED;
+				item = grandparent;
+			}
+			else
+			{
+				if (item == parent->right)
+				{
+					/* turn the zig-zag into a straight line first */
+					item = parent;
+					genc_bt_rotate_left(tree, item);
+					parent = item->parent;
+				}
+				parent->colour = GENC_BT_BLACK;
+				grandparent->colour = GENC_BT_RED;
+				genc_bt_rotate_right(tree, grandparent);
+			}
+		}
+		else
+		{
+			genc_bt_node_head_t* uncle = grandparent->left;
+			if (genc_bt_is_red(uncle))
+			{
+				parent->colour = GENC_BT_BLACK;
+				uncle->colour = GENC_BT_BLACK;
+				grandparent->colour = GENC_BT_RED;
+				item = grandparent;
+			}
+			else
+			{
+				if (item == parent->left)
+				{
+					item = parent;
+					genc_bt_rotate_right(tree, item);
+					parent = item->parent;
+				}
+				parent->colour = GENC_BT_BLACK;
+				grandparent->colour = GENC_BT_RED;
+				genc_bt_rotate_left(tree, grandparent);
+			}
+		}
+	}
+	tree->root->colour = GENC_BT_BLACK;
+}
+
+/* Replaces the subtree rooted at 'node' with the one rooted at 'with' (may be NULL) */
+static void genc_bt_transplant(genc_binary_tree_t* tree, genc_bt_node_head_t* node, genc_bt_node_head_t* with)
+{
+	*genc_bt_parent_ref(tree, node) = with;
+	if (with)
+		with->parent = node->parent;
+}
+
+/* Restores the red-black invariants after removing a black node. 'item' is the
+ * node (possibly NULL) which took the removed node's place, and carries an
+ * extra level of blackness. Its parent is passed explicitly, as item may be NULL. */
+static void genc_bt_rb_remove_fixup(genc_binary_tree_t* tree, genc_bt_node_head_t* item, genc_bt_node_head_t* parent)
+{
+	while (item != tree->root && !genc_bt_is_red(item))
+	{
+		genc_bt_node_head_t* sibling;
+		if (item == parent->left)
+		{
+			/* item is doubly black, so its sibling must exist */
+			sibling = parent->right;
+			if (sibling->colour == GENC_BT_RED)
+			{
+				sibling->colour = GENC_BT_BLACK;
+				parent->colour = GENC_BT_RED;
+				genc_bt_rotate_left(tree, parent);
+				sibling = parent->right;
+			}
+			if (!genc_bt_is_red(sibling->left) && !genc_bt_is_red(sibling->right))
+			{
+				/* move the extra blackness up the tree */
+				sibling->colour = GENC_BT_RED;
+				item = parent;
+				parent = item->parent;
+			}
+			else
+			{
+				if (!genc_bt_is_red(sibling->right))
+				{
+					sibling->left->colour = GENC_BT_BLACK;
+					sibling->colour = GENC_BT_RED;
+					genc_bt_rotate_right(tree, sibling);
+					sibling = parent->right;
+				}
+				sibling->colour = parent->colour;
+				parent->colour = GENC_BT_BLACK;
+				sibling->right->colour = GENC_BT_BLACK;
+				genc_bt_rotate_left(tree, parent);
+				item = tree->root;
+				break;
+			}
+		}
+		else
+		{
+			sibling = parent->left;
+			if (sibling->colour == GENC_BT_RED)
+			{
+				sibling->colour = GENC_BT_BLACK;
+				parent->colour = GENC_BT_RED;
+				genc_bt_rotate_right(tree, parent);
+				sibling = parent->left;
+			}
+			if (!genc_bt_is_red(sibling->left) && !genc_bt_is_red(sibling->right))
+			{
+				sibling->colour = GENC_BT_RED;
+				item = parent;
+				parent = item->parent;
+			}
+			else
+			{
+				if (!genc_bt_is_red(sibling->left))
+				{
+					sibling->right->colour = GENC_BT_BLACK;
+					sibling->colour = GENC_BT_RED;
+					genc_bt_rotate_left(tree, sibling);
+					sibling = parent->left;
+				}
+				sibling->colour = parent->colour;
+				parent->colour = GENC_BT_BLACK;
+				sibling->left->colour = GENC_BT_BLACK;
+				genc_bt_rotate_right(tree, parent);
+				item = tree->root;
+				break;
+			}
+		}
+	}
+	if (item)
+		item->colour = GENC_BT_BLACK;
+}
+
+static void genc_bt_rb_remove(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
+{
+	genc_bt_node_head_t* moved;
+	genc_bt_node_head_t* moved_parent;
+	unsigned char removed_colour = item->colour;
+	
+	/* update the cached extremes while the neighbours are still easy to find */
+	if (item == tree->min_node)
+		tree->min_node = genc_bt_next_item(tree, item);
+	if (item == tree->max_node)
+		tree->max_node = genc_bt_prev_item(tree, item);
+	
+	if (!item->left)
+	{
+		moved = item->right;
+		moved_parent = item->parent;
+		genc_bt_transplant(tree, item, item->right);
+	}
+	else if (!item->right)
+	{
+		moved = item->left;
+		moved_parent = item->parent;
+		genc_bt_transplant(tree, item, item->left);
+	}
+	else
+	{
+		/* 2 children: the successor (which has no left child) takes the item's
+		 * place and colour, so the colour that is effectively removed is the
+		 * successor's. */
+		genc_bt_node_head_t* successor = genc_bt_leftmost_in_subtree(item->right);
+		removed_colour = successor->colour;
+		moved = successor->right;
+		if (successor->parent == item)
+		{
+			moved_parent = successor;
+		}
+		else
+		{
+			moved_parent = successor->parent;
+			genc_bt_transplant(tree, successor, successor->right);
+			successor->right = item->right;
+			successor->right->parent = successor;
+		}
+		genc_bt_transplant(tree, item, successor);
+		successor->left = item->left;
+		successor->left->parent = successor;
+		successor->colour = item->colour;
+	}
+	/* moved_parent is the deepest node whose subtree changed */
+	genc_bt_propagate_update(tree, moved_parent);
+	
+	if (removed_colour == GENC_BT_BLACK)
+		genc_bt_rb_remove_fixup(tree, moved, moved_parent);
+
+	item->parent = NULL;
+	item->left = NULL;
+	item->right = NULL;
+}
+
 genc_bt_node_head_t* genc_bt_find(genc_binary_tree_t* tree, genc_bt_node_head_t* item)
 {
 	genc_bt_node_head_t* parent_unused = NULL;
@@ -314,3 +623,54 @@ genc_bool_t genc_bt_is_empty(genc_binary_tree_t* tree)
 {
 	return tree->root == NULL;
 }
+
+/* Returns the black height of the subtree, or -1 if any invariant is violated. */
+static int genc_bt_verify_subtree(genc_binary_tree_t* tree, genc_bt_node_head_t* node)
+{
+	int left_height, right_height;
+	if (!node)
+		return 0;
+	if (node->left && node->left->parent != node)
+		return -1;
+	if (node->right && node->right->parent != node)
+		return -1;
+	left_height = genc_bt_verify_subtree(tree, node->left);
+	right_height = genc_bt_verify_subtree(tree, node->right);
+	if (left_height < 0 || right_height < 0)
+		return -1;
+	if (!tree->red_black)
+		return 0;
+	
+	/* red nodes may not have red children, all paths must have equal black height */
+	if (node->colour == GENC_BT_RED && (genc_bt_is_red(node->left) || genc_bt_is_red(node->right)))
+		return -1;
+	if (left_height != right_height)
+		return -1;
+	return left_height + (node->colour == GENC_BT_BLACK ? 1 : 0);
+}
+
+genc_bool_t genc_bt_verify(genc_binary_tree_t* tree)
+{
+	genc_bt_node_head_t* cur;
+	genc_bt_node_head_t* prev = NULL;
+	if (!tree->root)
+		return tree->min_node == NULL && tree->max_node == NULL;
+	if (tree->root->parent)
+		return 0;
+	if (tree->red_black && tree->root->colour != GENC_BT_BLACK)
+		return 0;
+	if (tree->min_node != genc_bt_leftmost_in_subtree(tree->root)
+		|| tree->max_node != genc_bt_rightmost_in_subtree(tree->root))
+		return 0;
+	
+	/* in-order walk must be strictly ascending */
+	for (cur = tree->min_node; cur; prev = cur, cur = genc_bt_next_item(tree, cur))
+	{
+		if (prev && !tree->less_fn(prev, cur, tree->less_fn_opaque))
+			return 0;
+	}
+	if (prev != tree->max_node)
+		return 0;
+	
+	return genc_bt_verify_subtree(tree, tree->root) >= 0;
+}
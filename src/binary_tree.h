@@ -37,6 +37,13 @@ struct genc_bt_iterator;
 typedef struct genc_binary_tree genc_binary_tree_t;
 typedef struct genc_bt_node_head genc_bt_node_head_t;
 
+/* Node colours for red-black trees. */
+enum genc_bt_colour
+{
+	GENC_BT_BLACK = 0,
+	GENC_BT_RED = 1
+};
+
 /* Each element in a binary tree must contain such a structure. Automatically
  * initialised upon insertion into a tree. */
 struct genc_bt_node_head
@@ -44,6 +51,8 @@ struct genc_bt_node_head
 	genc_bt_node_head_t* parent;
 	genc_bt_node_head_t* left;
 	genc_bt_node_head_t* right;
+	/* enum genc_bt_colour; only meaningful in red-black trees. */
+	unsigned char colour;
 };
 
 /* Must return true(1) if a should appear before b, false(0) otherwise.
@@ -55,6 +64,12 @@ struct genc_bt_node_head
  */
 typedef genc_bool_t(*genc_binary_tree_less_fn)(genc_bt_node_head_t* a, genc_bt_node_head_t* b, void* opaque);
 
+/* Optional hook for augmented trees: recomputes any per-subtree data the client
+ * keeps in the node from the node itself and its (already up to date) children.
+ * Called by the tree on every node whose subtree changes during insertion,
+ * removal or rebalancing. The opaque pointer is the tree's less_fn_opaque. */
+typedef void(*genc_binary_tree_update_fn)(genc_bt_node_head_t* node, void* opaque);
+
 struct genc_binary_tree
 {
 	genc_bt_node_head_t* root;
@@ -62,10 +77,23 @@ struct genc_binary_tree
 	genc_bt_node_head_t* max_node;
 	genc_binary_tree_less_fn less_fn;
 	void* less_fn_opaque;
+	/* Rebalance on insertion and removal, keeping the red-black tree invariants */
+	genc_bool_t red_black;
+	genc_binary_tree_update_fn update_fn;
 };
 
 /* Initialise a blank binary tree, using the specified comparison function */
 void genc_binary_tree_init(genc_binary_tree_t* tree, genc_binary_tree_less_fn less_fn, void* less_fn_opaque);
+/* Initialise a blank, self-balancing (red-black) binary tree. Insertion, removal
+ * and lookup are guaranteed O(log N) regardless of insertion order, at the
+ * cost of some rotations on modification. Otherwise, the tree is used exactly
+ * like an unbalanced one. */
+void genc_binary_tree_init_rb(genc_binary_tree_t* tree, genc_binary_tree_less_fn less_fn, void* less_fn_opaque);
+/* Installs the augmentation hook. Must be called while the tree is empty. */
+void genc_bt_set_update_fn(genc_binary_tree_t* tree, genc_binary_tree_update_fn update_fn);
+/* Calls the update function on node and all its ancestors. Use this after
+ * modifying a node's augmented source data (without changing its ordering) in-place. */
+void genc_bt_propagate_update(genc_binary_tree_t* tree, genc_bt_node_head_t* node);
 /* Insert an item into the tree by searching the tree to find the appropriate
  * location. Returns true (1) on success or false (0) if an equal item is already present. */
 genc_bool_t genc_bt_insert(genc_binary_tree_t* tree, genc_bt_node_head_t* item);
@@ -95,6 +123,11 @@ genc_bt_node_head_t* genc_bt_prev_item(genc_binary_tree_t* tree, genc_bt_node_he
 void genc_bt_swap_trees(genc_binary_tree_t* tree_a, genc_binary_tree_t* tree_b);
 genc_bool_t genc_bt_is_empty(genc_binary_tree_t* tree);
 
+/* Checks the tree's structural integrity: parent links, ordering, cached
+ * min/max nodes and, for red-black trees, the colour invariants. Returns
+ * true(1) if everything is consistent. O(N), intended for debugging/testing. */
+genc_bool_t genc_bt_verify(genc_binary_tree_t* tree);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
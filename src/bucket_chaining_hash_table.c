@@ -0,0 +1,425 @@
+#include "bucket_chaining_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+/* The tag comes from the top bits of a multiplicative remix of the hash, so
+ * it is independent of the low bits which select the bucket even for weak
+ * client hashes. 0 is reserved for empty slots. */
+static GENC_INLINE uint16_t bcht_tag(genc_hash_t hash)
+{
+	uint16_t tag;
+#if defined(__LP64__) || defined(_WIN64)
+	tag = (uint16_t)(((uint64_t)hash * UINT64_C(0x9e3779b97f4a7c15)) >> 48);
+#else
+	tag = (uint16_t)(((uint32_t)hash * UINT32_C(0x9e3779b9)) >> 16);
+#endif
+	return tag ? tag : 1;
+}
+
+/* Buckets must fill exactly one cache line for lookups to touch only one */
+typedef char bcht_bucket_size_check[sizeof(struct genc_bcht_bucket) == GENC_BCHT_BUCKET_BYTES ? 1 : -1];
+
+static GENC_INLINE size_t bcht_max_items(size_t capacity, uint8_t load_percent)
+{
+	size_t slots = capacity * GENC_BCHT_SLOTS;
+	return slots / 100u * load_percent + (slots % 100u) * load_percent / 100u;
+}
+
+/* Allocates a zeroed bucket array, aligned to the bucket size. */
+static struct genc_bcht_bucket* bcht_alloc_buckets(
+	genc_bucket_chaining_hash_table_t* table, size_t capacity, void** out_alloc)
+{
+	void* alloc;
+	uintptr_t aligned;
+	if ((SIZE_MAX - GENC_BCHT_BUCKET_BYTES) / sizeof(struct genc_bcht_bucket) < capacity)
+		return NULL;
+	alloc = table->realloc_fn(NULL, 0, capacity * sizeof(struct genc_bcht_bucket) + GENC_BCHT_BUCKET_BYTES, table->opaque);
+	if (!alloc)
+		return NULL;
+	aligned = ((uintptr_t)alloc + GENC_BCHT_BUCKET_BYTES - 1) & ~(uintptr_t)(GENC_BCHT_BUCKET_BYTES - 1);
+	memset((void*)aligned, 0, capacity * sizeof(struct genc_bcht_bucket));
+	*out_alloc = alloc;
+	return (struct genc_bcht_bucket*)aligned;
+}
+
+static void bcht_free_buckets(genc_bucket_chaining_hash_table_t* table, void* alloc, size_t capacity)
+{
+	table->realloc_fn(alloc, capacity * sizeof(struct genc_bcht_bucket) + GENC_BCHT_BUCKET_BYTES, 0, table->opaque);
+}
+
+/* Allocates a zeroed overflow bucket, aligned like the main array. The
+ * allocation's address is kept just before the bucket, which the alignment
+ * slack always leaves room for as allocations are at least pointer aligned. */
+static struct genc_bcht_bucket* bcht_alloc_overflow(genc_bucket_chaining_hash_table_t* table)
+{
+	void* alloc = table->realloc_fn(NULL, 0, sizeof(struct genc_bcht_bucket) + GENC_BCHT_BUCKET_BYTES, table->opaque);
+	uintptr_t aligned;
+	if (!alloc)
+		return NULL;
+	aligned = ((uintptr_t)alloc + sizeof(void*) + GENC_BCHT_BUCKET_BYTES - 1) & ~(uintptr_t)(GENC_BCHT_BUCKET_BYTES - 1);
+	((void**)aligned)[-1] = alloc;
+	memset((void*)aligned, 0, sizeof(struct genc_bcht_bucket));
+	return (struct genc_bcht_bucket*)aligned;
+}
+
+static void bcht_free_overflow_bucket(genc_bucket_chaining_hash_table_t* table, struct genc_bcht_bucket* bucket)
+{
+	void* alloc = ((void**)bucket)[-1];
+	table->realloc_fn(alloc, sizeof(struct genc_bcht_bucket) + GENC_BCHT_BUCKET_BYTES, 0, table->opaque);
+}
+
+/* Frees the overflow buckets of all chains in the array */
+static void bcht_free_overflow(genc_bucket_chaining_hash_table_t* table, struct genc_bcht_bucket* buckets, size_t capacity)
+{
+	size_t i;
+	for (i = 0; i < capacity; ++i)
+	{
+		struct genc_bcht_bucket* overflow = buckets[i].overflow;
+		while (overflow)
+		{
+			struct genc_bcht_bucket* next = overflow->overflow;
+			bcht_free_overflow_bucket(table, overflow);
+			overflow = next;
+		}
+		buckets[i].overflow = NULL;
+	}
+}
+
+genc_bool_t genc_bucket_chaining_hash_table_init(
+	genc_bucket_chaining_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t initial_capacity_pow2)
+{
+	return genc_bucket_chaining_hash_table_init_ext(
+		table, hash_fn, get_key_fn, key_equality_fn, realloc_fn, opaque, initial_capacity_pow2, 75);
+}
+
+genc_bool_t genc_bucket_chaining_hash_table_init_ext(
+	genc_bucket_chaining_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold)
+{
+	if (!genc_is_pow2(initial_capacity_pow2))
+		return 0;
+	if (load_percent_grow_threshold < 1 || load_percent_grow_threshold > 100)
+		return 0;
+
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->key_equality_fn = key_equality_fn;
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	table->item_count = 0;
+	table->overflow_count = 0;
+	table->load_percent_grow_threshold = load_percent_grow_threshold;
+	table->buckets = bcht_alloc_buckets(table, initial_capacity_pow2, &table->buckets_alloc);
+	if (!table->buckets)
+		return 0;
+	table->capacity = initial_capacity_pow2;
+	return 1;
+}
+
+size_t genc_bcht_count(genc_bucket_chaining_hash_table_t* table)
+{
+	return table->item_count;
+}
+
+size_t genc_bcht_capacity(genc_bucket_chaining_hash_table_t* table)
+{
+	return table->capacity;
+}
+
+void genc_bcht_destroy(genc_bucket_chaining_hash_table_t* table)
+{
+	if (table->buckets)
+	{
+		bcht_free_overflow(table, table->buckets, table->capacity);
+		bcht_free_buckets(table, table->buckets_alloc, table->capacity);
+	}
+	table->buckets = NULL;
+	table->buckets_alloc = NULL;
+	table->capacity = 0;
+	table->item_count = 0;
+	table->overflow_count = 0;
+}
+
+/* Location of an item: the bucket and slot holding it, and the bucket before
+ * it in the chain (NULL if it's the home bucket). */
+struct bcht_location
+{
+	struct genc_bcht_bucket* bucket;
+	struct genc_bcht_bucket* prev;
+	unsigned slot;
+};
+
+/* Looks for the item with the given key, or (if item is non-NULL) that exact item. */
+static genc_bool_t bcht_locate(
+	genc_bucket_chaining_hash_table_t* table, void* key, void* item, genc_hash_t hash, struct bcht_location* out_loc)
+{
+	const uint16_t tag = bcht_tag(hash);
+	struct genc_bcht_bucket* prev = NULL;
+	struct genc_bcht_bucket* bucket = table->buckets + (hash & (table->capacity - 1));
+	do
+	{
+		unsigned i;
+		for (i = 0; i < GENC_BCHT_SLOTS; ++i)
+		{
+			if (bucket->tags[i] != tag)
+				continue;
+			if (item
+			    ? bucket->items[i] == item
+			    : table->key_equality_fn(table->get_key_fn(bucket->items[i], table->opaque), key, table->opaque))
+			{
+				out_loc->bucket = bucket;
+				out_loc->prev = prev;
+				out_loc->slot = i;
+				return 1;
+			}
+		}
+		prev = bucket;
+		bucket = bucket->overflow;
+	} while (bucket);
+	return 0;
+}
+
+/* Stores the item in the first free slot of its chain in the given array,
+ * adding an overflow bucket if necessary. */
+static genc_bool_t bcht_insert_new(
+	genc_bucket_chaining_hash_table_t* table, struct genc_bcht_bucket* buckets, size_t capacity,
+	void* item, genc_hash_t hash, size_t* overflow_count)
+{
+	struct genc_bcht_bucket* bucket = buckets + (hash & (capacity - 1));
+	unsigned i;
+	for (;;)
+	{
+		for (i = 0; i < GENC_BCHT_SLOTS; ++i)
+		{
+			if (bucket->tags[i] == 0)
+			{
+				bucket->tags[i] = bcht_tag(hash);
+				bucket->items[i] = item;
+				return 1;
+			}
+		}
+		if (!bucket->overflow)
+			break;
+		bucket = bucket->overflow;
+	}
+
+	bucket->overflow = bcht_alloc_overflow(table);
+	if (!bucket->overflow)
+		return 0;
+	bucket = bucket->overflow;
+	++*overflow_count;
+	bucket->tags[0] = bcht_tag(hash);
+	bucket->items[0] = item;
+	return 1;
+}
+
+/* Moves all items to a new bucket array. On failure, the table is left unchanged. */
+static genc_bool_t bcht_rehash(genc_bucket_chaining_hash_table_t* table, size_t new_capacity)
+{
+	void* new_alloc;
+	struct genc_bcht_bucket* new_buckets = bcht_alloc_buckets(table, new_capacity, &new_alloc);
+	size_t new_overflow_count = 0;
+	size_t i;
+	if (!new_buckets)
+		return 0;
+
+	/* The old chains are left intact until everything has been inserted into
+	 * the new array, so we can back out if an overflow bucket can't be allocated. */
+	for (i = 0; i < table->capacity; ++i)
+	{
+		struct genc_bcht_bucket* bucket;
+		for (bucket = table->buckets + i; bucket; bucket = bucket->overflow)
+		{
+			unsigned slot;
+			for (slot = 0; slot < GENC_BCHT_SLOTS; ++slot)
+			{
+				void* item = bucket->items[slot];
+				if (bucket->tags[slot] == 0)
+					continue;
+				if (!bcht_insert_new(
+					table, new_buckets, new_capacity, item,
+					table->hash_fn(table->get_key_fn(item, table->opaque), table->opaque), &new_overflow_count))
+				{
+					bcht_free_overflow(table, new_buckets, new_capacity);
+					bcht_free_buckets(table, new_alloc, new_capacity);
+					return 0;
+				}
+			}
+		}
+	}
+
+	bcht_free_overflow(table, table->buckets, table->capacity);
+	bcht_free_buckets(table, table->buckets_alloc, table->capacity);
+	table->buckets = new_buckets;
+	table->buckets_alloc = new_alloc;
+	table->capacity = new_capacity;
+	table->overflow_count = new_overflow_count;
+	return 1;
+}
+
+genc_bool_t genc_bcht_reserve_space(genc_bucket_chaining_hash_table_t* table, size_t target_count)
+{
+	size_t new_capacity = table->capacity;
+	while (target_count > bcht_max_items(new_capacity, table->load_percent_grow_threshold))
+	{
+		if (new_capacity > SIZE_MAX / 2 / sizeof(struct genc_bcht_bucket))
+			return 0;
+		new_capacity *= 2;
+	}
+	if (new_capacity == table->capacity)
+		return 1;
+	return bcht_rehash(table, new_capacity);
+}
+
+genc_bool_t genc_bcht_insert_item(genc_bucket_chaining_hash_table_t* table, void* item)
+{
+	struct bcht_location loc;
+	void* key;
+	genc_hash_t hash;
+	if (!item)
+		return 0;
+
+	key = table->get_key_fn(item, table->opaque);
+	hash = table->hash_fn(key, table->opaque);
+	if (bcht_locate(table, key, NULL, hash, &loc))
+		return 0; // duplicate
+
+	/* if growing fails, we can still insert into overflow buckets */
+	if (table->item_count + 1 > bcht_max_items(table->capacity, table->load_percent_grow_threshold))
+		genc_bcht_reserve_space(table, table->item_count + 1);
+
+	if (!bcht_insert_new(table, table->buckets, table->capacity, item, hash, &table->overflow_count))
+		return 0;
+	++table->item_count;
+	return 1;
+}
+
+void* genc_bcht_find(genc_bucket_chaining_hash_table_t* table, void* key)
+{
+	struct bcht_location loc;
+	if (!bcht_locate(table, key, NULL, table->hash_fn(key, table->opaque), &loc))
+		return NULL;
+	return loc.bucket->items[loc.slot];
+}
+
+static void bcht_remove_at(genc_bucket_chaining_hash_table_t* table, struct bcht_location* loc)
+{
+	struct genc_bcht_bucket* bucket = loc->bucket;
+	unsigned i;
+	bucket->tags[loc->slot] = 0;
+	bucket->items[loc->slot] = NULL;
+	--table->item_count;
+
+	/* release overflow buckets as soon as they become empty */
+	if (!loc->prev)
+		return;
+	for (i = 0; i < GENC_BCHT_SLOTS; ++i)
+		if (bucket->tags[i] != 0)
+			return;
+	loc->prev->overflow = bucket->overflow;
+	bcht_free_overflow_bucket(table, bucket);
+	--table->overflow_count;
+}
+
+void* genc_bcht_remove(genc_bucket_chaining_hash_table_t* table, void* key)
+{
+	struct bcht_location loc;
+	void* item;
+	if (!bcht_locate(table, key, NULL, table->hash_fn(key, table->opaque), &loc))
+		return NULL;
+	item = loc.bucket->items[loc.slot];
+	bcht_remove_at(table, &loc);
+	return item;
+}
+
+genc_bool_t genc_bcht_remove_item(genc_bucket_chaining_hash_table_t* table, void* item)
+{
+	struct bcht_location loc;
+	void* key = table->get_key_fn(item, table->opaque);
+	if (!bcht_locate(table, key, item, table->hash_fn(key, table->opaque), &loc))
+		return 0;
+	bcht_remove_at(table, &loc);
+	return 1;
+}
+
+genc_bool_t genc_bcht_verify(genc_bucket_chaining_hash_table_t* table)
+{
+	size_t i, items = 0, overflow = 0;
+	for (i = 0; i < table->capacity; ++i)
+	{
+		struct genc_bcht_bucket* bucket;
+		for (bucket = table->buckets + i; bucket; bucket = bucket->overflow)
+		{
+			unsigned slot, used = 0;
+			if (bucket != table->buckets + i)
+				++overflow;
+			for (slot = 0; slot < GENC_BCHT_SLOTS; ++slot)
+			{
+				genc_hash_t hash;
+				if (bucket->tags[slot] == 0)
+				{
+					if (bucket->items[slot] != NULL)
+						return 0;
+					continue;
+				}
+				hash = table->hash_fn(table->get_key_fn(bucket->items[slot], table->opaque), table->opaque);
+				if ((hash & (table->capacity - 1)) != i || bcht_tag(hash) != bucket->tags[slot])
+					return 0;
+				++used;
+			}
+			if (used == 0 && bucket != table->buckets + i)
+				return 0; // empty overflow buckets should have been freed
+			items += used;
+		}
+	}
+	return items == table->item_count && overflow == table->overflow_count;
+}
+
+/* Returns the first item at or after the given slot in the chain, or in any subsequent chain. */
+static void* bcht_first_item_from(
+	genc_bucket_chaining_hash_table_t* table, size_t idx, struct genc_bcht_bucket* bucket, unsigned slot)
+{
+	for (;;)
+	{
+		for (; bucket; bucket = bucket->overflow, slot = 0)
+		{
+			for (; slot < GENC_BCHT_SLOTS; ++slot)
+				if (bucket->tags[slot] != 0)
+					return bucket->items[slot];
+		}
+		if (++idx >= table->capacity)
+			return NULL;
+		bucket = table->buckets + idx;
+	}
+}
+
+void* genc_bcht_first_item(genc_bucket_chaining_hash_table_t* table)
+{
+	if (table->capacity == 0)
+		return NULL;
+	return bcht_first_item_from(table, 0, table->buckets, 0);
+}
+
+void* genc_bcht_next_item(genc_bucket_chaining_hash_table_t* table, void* cur_item)
+{
+	struct bcht_location loc;
+	void* key = table->get_key_fn(cur_item, table->opaque);
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	if (!bcht_locate(table, key, cur_item, hash, &loc))
+		return NULL;
+	return bcht_first_item_from(table, hash & (table->capacity - 1), loc.bucket, loc.slot + 1);
+}
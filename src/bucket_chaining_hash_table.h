@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * A chaining hash table whose buckets are cache line sized blocks of
+ * (16-bit hash tag, item pointer) pairs, rather than single list heads.
+ * A lookup reads the home bucket's line, compares the key only for items
+ * whose tag matches (a false match happens for 1 in 65535 other items), and
+ * so normally touches one line of the index and at most one item. Items
+ * which don't fit in their home bucket go into overflow buckets chained off
+ * it, which are allocated individually (also aligned to the cache line) and
+ * freed once empty again.
+ *
+ * Unlike genc_chaining_hash_table, items need no embedded list head: the
+ * table stores plain item pointers, and the items themselves are never moved
+ * or copied. Growing rehashes every item, as the tags don't hold enough of the
+ * hash to pick new buckets. The table does not shrink.
+ */
+
+#ifndef GENCCONT_BUCKET_CHAINING_HASH_TABLE_H
+#define GENCCONT_BUCKET_CHAINING_HASH_TABLE_H
+
+#include "hash_shared.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GENC_BCHT_BUCKET_BYTES 64
+/* Items per bucket: 5 with 64-bit pointers, 10 with 32-bit ones */
+#define GENC_BCHT_SLOTS ((GENC_BCHT_BUCKET_BYTES - sizeof(void*)) / (sizeof(void*) + sizeof(uint16_t)))
+
+struct genc_bcht_bucket
+{
+	/* Hash tags of the items in the slots; 0 marks an empty slot */
+	uint16_t tags[GENC_BCHT_SLOTS];
+	void* items[GENC_BCHT_SLOTS];
+	struct genc_bcht_bucket* overflow;
+};
+
+struct genc_bucket_chaining_hash_table
+{
+	genc_key_hash_fn hash_fn;
+	genc_hash_get_item_key_fn get_key_fn;
+	genc_hash_key_equality_fn key_equality_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+	/* Number of buckets in the main array, a power of 2 */
+	size_t capacity;
+	size_t item_count;
+	/* Number of overflow buckets currently allocated */
+	size_t overflow_count;
+	/* Main bucket array, aligned to the cache line within the allocation at buckets_alloc */
+	struct genc_bcht_bucket* buckets;
+	void* buckets_alloc;
+	/* Percentage of all main bucket slots which may be filled before growing */
+	uint8_t load_percent_grow_threshold;
+};
+typedef struct genc_bucket_chaining_hash_table genc_bucket_chaining_hash_table_t;
+
+/* Initialises the empty hash table with the given function implementations
+ * and number of buckets (each holding GENC_BCHT_SLOTS items). The default load
+ * factor threshold for growing (75% of slots) is used. */
+genc_bool_t genc_bucket_chaining_hash_table_init(
+	genc_bucket_chaining_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t initial_capacity_pow2);
+
+/* Initialises the hash table with a non-default growth threshold (1-100). */
+genc_bool_t genc_bucket_chaining_hash_table_init_ext(
+	genc_bucket_chaining_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold);
+
+/* Returns the current number of items in the hash table. */
+size_t genc_bcht_count(genc_bucket_chaining_hash_table_t* table);
+
+/* Returns the number of buckets in the main array. */
+size_t genc_bcht_capacity(genc_bucket_chaining_hash_table_t* table);
+
+/* Drops all items from the table (without deleting them) and deallocates bucket memory. */
+void genc_bcht_destroy(genc_bucket_chaining_hash_table_t* table);
+
+/* Inserts the given item into the hash table.
+ * Returns false/0 to report failure due to a duplicate or allocation failure,
+ * true/1 on success. */
+genc_bool_t genc_bcht_insert_item(genc_bucket_chaining_hash_table_t* table, void* item);
+
+/* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
+void* genc_bcht_find(genc_bucket_chaining_hash_table_t* table, void* key);
+
+/* Removes the item with the given key from the table and returns it, or NULL if not found. */
+void* genc_bcht_remove(genc_bucket_chaining_hash_table_t* table, void* key);
+
+/* Removes the given item from the table, returning true if it was present. */
+genc_bool_t genc_bcht_remove_item(genc_bucket_chaining_hash_table_t* table, void* item);
+
+/* Resizes the table, if necessary, so that it will not need resizing to hold
+ * target_count items. */
+genc_bool_t genc_bcht_reserve_space(genc_bucket_chaining_hash_table_t* table, size_t target_count);
+
+/* Walks all the items in the hash table and checks they're in the right bucket with the right tag. */
+genc_bool_t genc_bcht_verify(genc_bucket_chaining_hash_table_t* table);
+
+/* Iterating over all the items in the table (which must not be modified meanwhile): */
+void* genc_bcht_first_item(genc_bucket_chaining_hash_table_t* table);
+void* genc_bcht_next_item(genc_bucket_chaining_hash_table_t* table, void* cur_item);
+
+#define genc_bcht_first_obj(table, type) \
+GENC_CXX_CAST(type*, genc_bcht_first_item(table))
+
+#define genc_bcht_next_obj(table, cur_obj, type) \
+GENC_CXX_CAST(type*, genc_bcht_next_item(table, GENC_CXX_CAST(type*, cur_obj)))
+
+#define genc_bcht_find_obj(table, key, type) \
+GENC_CXX_CAST(type*, genc_bcht_find(table, key))
+
+#define genc_bcht_for_each_obj(type, obj_var, table) \
+for (type* obj_var = genc_bcht_first_obj(table, type); obj_var != NULL; obj_var = genc_bcht_next_obj(table, obj_var, type))
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,331 @@
+#include "cache.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#include <assert.h>
+#endif
+
+/* Saturation value of the S3-FIFO access counter */
+#define CACHE_S3FIFO_MAX_FREQ 3
+
+static GENC_INLINE genc_hash_t cache_entry_hash(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	return cache->hash_fn(cache->get_key_fn(&entry->hash_head, cache->opaque), cache->opaque);
+}
+
+static GENC_INLINE genc_cache_entry_t* cache_entry_from_list_head(struct dlist_head* head)
+{
+	return genc_container_of_notnull(head, genc_cache_entry_t, list_head);
+}
+
+/* Ghost set slots hold the full hash, with 0 reserved for empty slots */
+static GENC_INLINE genc_hash_t cache_ghost_tag(genc_hash_t hash)
+{
+	return hash ? hash : 1;
+}
+
+static GENC_INLINE size_t cache_ghost_slot(genc_cache_t* cache, genc_hash_t hash)
+{
+	return genc_hash_size(hash) & cache->ghost_mask;
+}
+
+static void cache_ghost_add(genc_cache_t* cache, genc_hash_t hash)
+{
+	cache->ghost[cache_ghost_slot(cache, hash)] = cache_ghost_tag(hash);
+}
+
+/* Returns true and forgets the hash if it was in the ghost set */
+static genc_bool_t cache_ghost_take(genc_cache_t* cache, genc_hash_t hash)
+{
+	genc_hash_t* slot = &cache->ghost[cache_ghost_slot(cache, hash)];
+	if (*slot != cache_ghost_tag(hash))
+		return 0;
+	*slot = 0;
+	return 1;
+}
+
+genc_bool_t genc_cache_init(
+	genc_cache_t* cache,
+	genc_cache_policy_t policy,
+	size_t capacity,
+	size_t expected_entries,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_cache_evict_fn evict_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque)
+{
+	size_t entries = expected_entries ? expected_entries : capacity;
+	size_t slots;
+	int log2;
+	unsigned i;
+	
+	if (entries == 0)
+		entries = 1;
+	log2 = genc_log2_size_roundup(entries);
+	if (log2 >= (int)(sizeof(size_t) * 8 - 1))
+		return 0;
+	slots = (size_t)1 << log2;
+	
+	/* one bucket per expected entry, and never shrink, so a cache that stays
+	 * within its expected size doesn't allocate after initialisation */
+	if (!genc_chaining_hash_table_init_ext(&cache->table, hash_fn, get_key_fn, key_equality_fn, realloc_fn, opaque, slots, 100, 0))
+		return 0;
+	
+	cache->ghost = NULL;
+	cache->ghost_mask = 0;
+	if (policy == GENC_CACHE_S3FIFO)
+	{
+		if (SIZE_MAX / sizeof(genc_hash_t) < slots)
+			cache->ghost = NULL;
+		else
+			cache->ghost = GENC_CXX_CAST(genc_hash_t*, realloc_fn(NULL, 0, slots * sizeof(genc_hash_t), opaque));
+		if (!cache->ghost)
+		{
+			genc_cht_destroy(&cache->table);
+			return 0;
+		}
+		memset(cache->ghost, 0, slots * sizeof(genc_hash_t));
+		cache->ghost_mask = slots - 1;
+	}
+	
+	for (i = 0; i < GENC_CACHE_QUEUE_COUNT; ++i)
+	{
+		genc_dlist_init(&cache->queues[i]);
+		cache->queue_charge[i] = 0;
+	}
+	cache->capacity = capacity;
+	cache->small_capacity = capacity / 10;
+	cache->charge = 0;
+	cache->policy = policy;
+	cache->hash_fn = hash_fn;
+	cache->get_key_fn = get_key_fn;
+	cache->evict_fn = evict_fn;
+	cache->realloc_fn = realloc_fn;
+	cache->opaque = opaque;
+	return 1;
+}
+
+/* Adds the entry at the front of the queue */
+static void cache_enqueue(genc_cache_t* cache, genc_cache_entry_t* entry, unsigned queue)
+{
+	entry->queue = (uint8_t)queue;
+	genc_dlist_insert_after(&entry->list_head, &cache->queues[queue]);
+	cache->queue_charge[queue] += entry->charge;
+}
+
+static void cache_dequeue(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	genc_dlist_remove(&entry->list_head);
+	cache->queue_charge[entry->queue] -= entry->charge;
+}
+
+static void cache_unlink(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	cache_dequeue(cache, entry);
+	cache->charge -= entry->charge;
+}
+
+/* Removes the entry that's been picked for eviction and hands it to the client */
+static void cache_evict(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	genc_bool_t removed GENC_UNUSED = genc_cht_remove_item(&cache->table, &entry->hash_head);
+	assert(removed);
+	cache_unlink(cache, entry);
+	if (cache->evict_fn)
+		cache->evict_fn(entry, cache->opaque);
+}
+
+/* Evicts one entry according to the policy. Returns false if the cache is empty. */
+static genc_bool_t cache_evict_one(genc_cache_t* cache)
+{
+	struct dlist_head* main_queue = &cache->queues[GENC_CACHE_QUEUE_MAIN];
+	struct dlist_head* small_queue = &cache->queues[GENC_CACHE_QUEUE_SMALL];
+	genc_cache_entry_t* entry;
+	
+	if (cache->policy == GENC_CACHE_LRU)
+	{
+		if (genc_dlist_is_empty(main_queue))
+			return 0;
+		cache_evict(cache, cache_entry_from_list_head(genc_dlist_last(main_queue)));
+		return 1;
+	}
+	
+	/* CLOCK and S3-FIFO: every pass round the loop either evicts, or reduces
+	 * some entry's counter or moves it out of the small queue, so this
+	 * terminates. */
+	for (;;)
+	{
+		if (cache->policy == GENC_CACHE_S3FIFO
+		    && !genc_dlist_is_empty(small_queue)
+		    && (cache->queue_charge[GENC_CACHE_QUEUE_SMALL] > cache->small_capacity || genc_dlist_is_empty(main_queue)))
+		{
+			entry = cache_entry_from_list_head(genc_dlist_last(small_queue));
+			if (entry->freq > 0)
+			{
+				/* hit while on probation: promote */
+				entry->freq = 0;
+				cache_dequeue(cache, entry);
+				cache_enqueue(cache, entry, GENC_CACHE_QUEUE_MAIN);
+				continue;
+			}
+			cache_ghost_add(cache, cache_entry_hash(cache, entry));
+			cache_evict(cache, entry);
+			return 1;
+		}
+		
+		if (genc_dlist_is_empty(main_queue))
+			return 0;
+		entry = cache_entry_from_list_head(genc_dlist_last(main_queue));
+		if (entry->freq > 0)
+		{
+			/* second chance */
+			--entry->freq;
+			cache_dequeue(cache, entry);
+			cache_enqueue(cache, entry, GENC_CACHE_QUEUE_MAIN);
+			continue;
+		}
+		cache_evict(cache, entry);
+		return 1;
+	}
+}
+
+void genc_cache_evict_to(genc_cache_t* cache, size_t target_charge)
+{
+	while (cache->charge > target_charge)
+	{
+		if (!cache_evict_one(cache))
+			break;
+	}
+}
+
+void genc_cache_destroy(genc_cache_t* cache)
+{
+	genc_cache_evict_to(cache, 0);
+	genc_cht_destroy(&cache->table);
+	if (cache->ghost)
+		cache->realloc_fn(cache->ghost, (cache->ghost_mask + 1) * sizeof(genc_hash_t), 0, cache->opaque);
+	cache->ghost = NULL;
+}
+
+static void cache_record_hit(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	switch (cache->policy)
+	{
+	case GENC_CACHE_LRU:
+		if (cache->queues[GENC_CACHE_QUEUE_MAIN].next != &entry->list_head)
+		{
+			genc_dlist_remove(&entry->list_head);
+			genc_dlist_insert_after(&entry->list_head, &cache->queues[GENC_CACHE_QUEUE_MAIN]);
+		}
+		break;
+	case GENC_CACHE_CLOCK:
+		entry->freq = 1;
+		break;
+	case GENC_CACHE_S3FIFO:
+		if (entry->freq < CACHE_S3FIFO_MAX_FREQ)
+			++entry->freq;
+		break;
+	}
+}
+
+genc_cache_entry_t* genc_cache_peek(genc_cache_t* cache, void* key)
+{
+	struct slist_head* found = genc_cht_find(&cache->table, key);
+	return genc_container_of(found, genc_cache_entry_t, hash_head);
+}
+
+genc_cache_entry_t* genc_cache_find(genc_cache_t* cache, void* key)
+{
+	genc_cache_entry_t* entry = genc_cache_peek(cache, key);
+	if (entry)
+		cache_record_hit(cache, entry);
+	return entry;
+}
+
+genc_bool_t genc_cache_insert(genc_cache_t* cache, genc_cache_entry_t* entry, size_t charge)
+{
+	unsigned queue = GENC_CACHE_QUEUE_MAIN;
+	if (charge > cache->capacity)
+		return 0;
+	if (!genc_cht_insert_item(&cache->table, &entry->hash_head))
+		return 0;
+	
+	/* the new entry isn't queued yet, so it can't be evicted itself */
+	genc_cache_evict_to(cache, cache->capacity - charge);
+	
+	entry->charge = charge;
+	entry->freq = 0;
+	if (cache->policy == GENC_CACHE_S3FIFO && !cache_ghost_take(cache, cache_entry_hash(cache, entry)))
+		queue = GENC_CACHE_QUEUE_SMALL;
+	cache_enqueue(cache, entry, queue);
+	cache->charge += charge;
+	return 1;
+}
+
+void genc_cache_remove_entry(genc_cache_t* cache, genc_cache_entry_t* entry)
+{
+	genc_bool_t removed GENC_UNUSED = genc_cht_remove_item(&cache->table, &entry->hash_head);
+	assert(removed);
+	cache_unlink(cache, entry);
+}
+
+genc_cache_entry_t* genc_cache_remove(genc_cache_t* cache, void* key)
+{
+	struct slist_head** ref = genc_cht_find_ref(&cache->table, key);
+	genc_cache_entry_t* entry;
+	if (!ref || !*ref)
+		return NULL;
+	entry = genc_container_of_notnull(genc_cht_remove_ref(&cache->table, ref), genc_cache_entry_t, hash_head);
+	cache_unlink(cache, entry);
+	return entry;
+}
+
+void genc_cache_set_capacity(genc_cache_t* cache, size_t capacity)
+{
+	cache->capacity = capacity;
+	cache->small_capacity = capacity / 10;
+	genc_cache_evict_to(cache, capacity);
+}
+
+size_t genc_cache_count(genc_cache_t* cache)
+{
+	return genc_cht_count(&cache->table);
+}
+
+size_t genc_cache_charge(genc_cache_t* cache)
+{
+	return cache->charge;
+}
+
+size_t genc_cache_capacity(genc_cache_t* cache)
+{
+	return cache->capacity;
+}
+
+void genc_cache_verify(genc_cache_t* cache)
+{
+	size_t count = 0, total = 0, queue_total;
+	unsigned i;
+	struct dlist_head* cur;
+	for (i = 0; i < GENC_CACHE_QUEUE_COUNT; ++i)
+	{
+		genc_assert_dlist_is_healthy(&cache->queues[i]);
+		queue_total = 0;
+		for (cur = cache->queues[i].next; cur != &cache->queues[i]; cur = cur->next)
+		{
+			genc_cache_entry_t* entry GENC_UNUSED = cache_entry_from_list_head(cur);
+			assert(entry->queue == i);
+			assert(genc_cache_peek(cache, cache->get_key_fn(&entry->hash_head, cache->opaque)) == entry);
+			queue_total += entry->charge;
+			++count;
+		}
+		assert(queue_total == cache->queue_charge[i]);
+		total += queue_total;
+	}
+	assert(cache->policy == GENC_CACHE_S3FIFO || genc_dlist_is_empty(&cache->queues[GENC_CACHE_QUEUE_SMALL]));
+	assert(count == genc_cache_count(cache));
+	assert(total == cache->charge);
+	assert(cache->charge <= cache->capacity);
+}
@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+/*
+ * A fixed-capacity cache of client-allocated, intrusive entries: each cached
+ * object embeds a genc_cache_entry_t, which contains both the slist_head
+ * linking it into a genc_chaining_hash_table for lookup and the dlist_head
+ * linking it into the eviction policy's queue(s). Hits, insertions and
+ * evictions are O(1) (amortised over the policies' second chances), and the
+ * cache itself never allocates except when its hash table grows, which can be
+ * avoided by passing a suitable expected_entries at initialisation.
+ *
+ * Capacity is counted in client-reported charges: insert every entry with a
+ * charge of 1 to limit the number of entries, or with its size in bytes to
+ * limit memory usage. When an insertion would exceed the capacity, entries are
+ * evicted as chosen by the policy and handed to the eviction callback, which
+ * may free them.
+ *
+ * Policies:
+ * - GENC_CACHE_LRU: least recently used. Every hit moves the entry to the
+ *   front of the queue.
+ * - GENC_CACHE_CLOCK: second chance FIFO. A hit only sets the entry's
+ *   reference bit; eviction skips (and clears) referenced entries.
+ * - GENC_CACHE_S3FIFO: new entries go to a small FIFO queue (10% of the
+ *   capacity), entries hit while in it are promoted to the main queue, the
+ *   rest are evicted early, which protects the main queue from scans and
+ *   one-hit wonders. Hashes of entries evicted from the small queue are kept
+ *   in a "ghost" set (a direct-mapped array, so it may forget some) and such
+ *   keys are readmitted straight into the main queue. The main queue is a
+ *   CLOCK with a 2-bit access counter.
+ *
+ * The cache does no locking. Note that all operations, including lookups,
+ * modify the cache, so they must be serialised by the client.
+ */
+
+#ifndef GENCCONT_CACHE_H
+#define GENCCONT_CACHE_H
+
+#include "chaining_hash_table.h"
+#include "dlist.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum genc_cache_policy
+{
+	GENC_CACHE_LRU,
+	GENC_CACHE_CLOCK,
+	GENC_CACHE_S3FIFO
+};
+typedef enum genc_cache_policy genc_cache_policy_t;
+
+/* Embed this in the cached object. The key getter passed to genc_cache_init()
+ * receives a pointer to its hash_head member. */
+struct genc_cache_entry
+{
+	struct slist_head hash_head;
+	struct dlist_head list_head;
+	size_t charge;
+	/* reference bit/access counter, depending on policy */
+	uint8_t freq;
+	/* S3-FIFO queue the entry is in */
+	uint8_t queue;
+};
+typedef struct genc_cache_entry genc_cache_entry_t;
+
+/* Called with each entry evicted to make room, after it has been removed from
+ * the cache. The callback must not call back into the cache. */
+typedef void(*genc_cache_evict_fn)(genc_cache_entry_t* entry, void* opaque);
+
+struct genc_cache;
+typedef struct genc_cache genc_cache_t;
+
+/* Initialises an empty cache. The hash, key and equality functions are used as
+ * in genc_chaining_hash_table_init(); the opaque pointer is passed to them and
+ * to evict_fn (which may be NULL) and realloc_fn. expected_entries sizes the
+ * hash table and the S3-FIFO ghost set; 0 means capacity, which suits caches
+ * whose entries all have a charge of 1. */
+genc_bool_t genc_cache_init(
+	genc_cache_t* cache,
+	genc_cache_policy_t policy,
+	size_t capacity,
+	size_t expected_entries,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_cache_evict_fn evict_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque);
+
+/* Passes all remaining entries to the eviction callback and deallocates the
+ * cache's memory. */
+void genc_cache_destroy(genc_cache_t* cache);
+
+/* Looks up the key and records a hit for the entry if found. */
+genc_cache_entry_t* genc_cache_find(genc_cache_t* cache, void* key);
+
+/* Looks up the key without affecting eviction order. */
+genc_cache_entry_t* genc_cache_peek(genc_cache_t* cache, void* key);
+
+/* Inserts the entry with the given charge, first evicting other entries as
+ * needed to keep the total charge within capacity. Returns false/0 without
+ * evicting anything if an entry with the same key is already cached, or if
+ * the charge on its own exceeds the capacity. */
+genc_bool_t genc_cache_insert(genc_cache_t* cache, genc_cache_entry_t* entry, size_t charge);
+
+/* Removes the entry with the given key and returns it, or NULL if not found.
+ * The eviction callback is not called. */
+genc_cache_entry_t* genc_cache_remove(genc_cache_t* cache, void* key);
+
+/* Removes the given cached entry; the eviction callback is not called. */
+void genc_cache_remove_entry(genc_cache_t* cache, genc_cache_entry_t* entry);
+
+/* Changes the capacity, evicting entries if the new capacity is smaller than
+ * the current total charge. */
+void genc_cache_set_capacity(genc_cache_t* cache, size_t capacity);
+
+/* Evicts entries until the total charge is at most target_charge. */
+void genc_cache_evict_to(genc_cache_t* cache, size_t target_charge);
+
+size_t genc_cache_count(genc_cache_t* cache);
+size_t genc_cache_charge(genc_cache_t* cache);
+size_t genc_cache_capacity(genc_cache_t* cache);
+
+/* Checks the queues' and hash table's consistency with assert()s */
+void genc_cache_verify(genc_cache_t* cache);
+
+enum
+{
+	GENC_CACHE_QUEUE_MAIN = 0,
+	GENC_CACHE_QUEUE_SMALL = 1,
+	GENC_CACHE_QUEUE_COUNT = 2
+};
+
+struct genc_cache
+{
+	struct genc_chaining_hash_table table;
+	/* Most recently inserted (or, for LRU, used) entries first. LRU and CLOCK
+	 * only use the main queue. */
+	struct dlist_head queues[GENC_CACHE_QUEUE_COUNT];
+	size_t queue_charge[GENC_CACHE_QUEUE_COUNT];
+	size_t capacity;
+	size_t charge;
+	/* S3-FIFO target charge of the small queue */
+	size_t small_capacity;
+	genc_cache_policy_t policy;
+	/* S3-FIFO ghost set: hashes of recently evicted keys (0 for none), indexed
+	 * by the remixed hash */
+	genc_hash_t* ghost;
+	size_t ghost_mask;
+	genc_chaining_key_hash_fn hash_fn;
+	genc_chaining_hash_get_item_key_fn get_key_fn;
+	genc_cache_evict_fn evict_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+};
+
+#define genc_cache_entry_obj(entry, type, member_name) \
+	genc_container_of(entry, type, member_name)
+
+#define genc_cache_find_obj(cache, key, type, member_name) \
+	genc_container_of(genc_cache_find((cache), (key)), type, member_name)
+
+#define genc_cache_peek_obj(cache, key, type, member_name) \
+	genc_container_of(genc_cache_peek((cache), (key)), type, member_name)
+
+#define genc_cache_remove_obj(cache, key, type, member_name) \
+	genc_container_of(genc_cache_remove((cache), (key)), type, member_name)
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
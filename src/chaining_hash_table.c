@@ -90,6 +90,18 @@ genc_bool_t genc_chaining_hash_table_init_ext(
 	table->buckets = GENC_CXX_CAST(genc_slist_head_t**, buckets);
 	table->load_percent_grow_threshold = load_percent_grow_threshold;
 	table->load_percent_shrink_threshold = load_percent_shrink_threshold;
+	table->old_buckets = NULL;
+	table->old_capacity = 0;
+	table->migrate_pos = 0;
+	table->migrate_buckets_per_op = 0;
+	table->seeded_hash_fn = NULL;
+	table->seed = 0;
+	table->max_chain_length = 0;
+	table->reseed_count = 0;
+	table->multimap = 0;
+#if GENC_HASH_TABLE_STATS
+	GENC_MEMSET(&table->stats, 0, sizeof(table->stats));
+#endif
 	
 	return 1;
 }
@@ -106,9 +118,174 @@ size_t genc_cht_capacity(struct genc_chaining_hash_table* table)
 }
 
 
+void genc_cht_set_incremental_resize(struct genc_chaining_hash_table* table, size_t buckets_per_op)
+{
+	table->migrate_buckets_per_op = buckets_per_op;
+}
+
+genc_bool_t genc_cht_is_resizing(struct genc_chaining_hash_table* table)
+{
+	return table->old_buckets != NULL;
+}
+
+/* All key hashing goes through here so the seeded hash function takes over when set */
+static GENC_INLINE genc_hash_t genc_cht_hash_key(struct genc_chaining_hash_table* table, void* key)
+{
+	if (table->seeded_hash_fn)
+		return table->seeded_hash_fn(key, table->seed, table->opaque);
+	return table->hash_fn(key, table->opaque);
+}
+
+/* Moves the chains of up to count old buckets into the new bucket array,
+ * freeing the old array once it is empty. */
+static void genc_cht_migrate_buckets(struct genc_chaining_hash_table* table, size_t count)
+{
+	void* op = table->opaque;
+	size_t mask = table->capacity - 1;
+	genc_slist_head_t** old_buckets = table->old_buckets;
+	
+	while (count > 0 && table->migrate_pos < table->old_capacity)
+	{
+		genc_slist_head_t** old_ref = old_buckets + table->migrate_pos;
+		genc_slist_head_t* cur;
+		/* New buckets fed by this old one are still empty, so inserting each
+		 * item at the head of its new chain keeps equal keys adjacent. */
+		while ((cur = genc_slist_remove_at(old_ref)))
+		{
+			genc_hash_t hash = genc_cht_hash_key(table, table->get_key_fn(cur, op));
+			genc_slist_insert_at(cur, table->buckets + (hash & mask));
+			GENC_HASH_STATS_INC(table->stats, items_moved);
+		}
+		++table->migrate_pos;
+		--count;
+	}
+	if (table->migrate_pos >= table->old_capacity)
+	{
+		table->realloc_fn(old_buckets, table->old_capacity * sizeof(genc_slist_head_t*), 0, op);
+		table->old_buckets = NULL;
+		table->old_capacity = 0;
+		table->migrate_pos = 0;
+	}
+}
+
+/* Performs the per-operation share of an incremental resize, if one is in progress */
+static GENC_INLINE void genc_cht_migrate_step(struct genc_chaining_hash_table* table)
+{
+	if (table->old_buckets)
+		genc_cht_migrate_buckets(table, table->migrate_buckets_per_op);
+}
+
+void genc_cht_complete_resize(struct genc_chaining_hash_table* table)
+{
+	if (table->old_buckets)
+		genc_cht_migrate_buckets(table, SIZE_MAX);
+}
+
+/* Redistributes all items after a change of hash function or seed. */
+static void genc_cht_rehash(struct genc_chaining_hash_table* table)
+{
+	void* op = table->opaque;
+	size_t mask = table->capacity - 1;
+	size_t i;
+	genc_slist_head_t* all = NULL;
+	genc_slist_head_t* cur;
+	
+	genc_cht_complete_resize(table);
+	GENC_HASH_STATS_INC(table->stats, rehashes);
+	GENC_HASH_STATS_ADD(table->stats, items_moved, table->item_count);
+	/* Detach all chains into one list, keeping each chain's order. Runs of
+	 * equal keys are then reinserted back to back into the same bucket, so
+	 * they stay adjacent. */
+	for (i = 0; i < table->capacity; ++i)
+	{
+		genc_slist_head_t* chain = table->buckets[i];
+		if (!chain)
+			continue;
+		table->buckets[i] = NULL;
+		for (cur = chain; cur->next; cur = cur->next)
+			;
+		cur->next = all;
+		all = chain;
+	}
+	while ((cur = genc_slist_remove_at(&all)))
+	{
+		genc_hash_t hash = genc_cht_hash_key(table, table->get_key_fn(cur, op));
+		genc_slist_insert_at(cur, table->buckets + (hash & mask));
+	}
+}
+
+void genc_cht_set_seeded_hash(struct genc_chaining_hash_table* table, genc_seeded_key_hash_fn hash_fn, uint64_t seed)
+{
+	table->seeded_hash_fn = hash_fn;
+	table->seed = seed;
+	genc_cht_rehash(table);
+}
+
+void genc_cht_reseed(struct genc_chaining_hash_table* table, uint64_t seed)
+{
+	assert(table->seeded_hash_fn);
+	table->seed = seed;
+	genc_cht_rehash(table);
+}
+
+void genc_cht_set_max_chain_length(struct genc_chaining_hash_table* table, size_t max_length)
+{
+	table->max_chain_length = max_length;
+}
+
+void genc_cht_set_multimap(struct genc_chaining_hash_table* table, genc_bool_t multimap)
+{
+	table->multimap = multimap;
+}
+
+static size_t genc_cht_longest_chain(struct genc_chaining_hash_table* table)
+{
+	size_t i, longest = 0;
+	for (i = 0; i < table->capacity; ++i)
+	{
+		size_t length = 0;
+		genc_slist_head_t* cur;
+		for (cur = table->buckets[i]; cur; cur = cur->next)
+			++length;
+		if (length > longest)
+			longest = length;
+	}
+	return longest;
+}
+
+/* Called when an insertion found an overlong chain: mixing in the table's
+ * address means even a known initial seed won't predict the new one. */
+static void genc_cht_guard_reseed(struct genc_chaining_hash_table* table)
+{
+	genc_cht_reseed(table, genc_hash_next_seed(table->seed ^ (uintptr_t)table));
+	++table->reseed_count;
+	if (genc_cht_longest_chain(table) > table->max_chain_length && table->max_chain_length <= SIZE_MAX / 2)
+		table->max_chain_length *= 2;
+}
+
+/* Returns the chain in which items with the given hash live, taking into
+ * account any incremental resize in progress. */
+static GENC_INLINE genc_slist_head_t** genc_cht_bucket_ref_for_hash(struct genc_chaining_hash_table* table, genc_hash_t hash)
+{
+	if (table->old_buckets)
+	{
+		size_t old_idx = hash & (table->old_capacity - 1ul);
+		if (old_idx >= table->migrate_pos)
+			return table->old_buckets + old_idx;
+	}
+	return table->buckets + (hash & (table->capacity - 1ul));
+}
+
 /* Drops all items from the table and deallocates used memory. */
 void genc_cht_destroy(struct genc_chaining_hash_table* table)
 {
+	if (table->old_buckets)
+	{
+		table->realloc_fn(table->old_buckets, table->old_capacity * sizeof(genc_slist_head_t*), 0, table->opaque);
+		table->old_buckets = NULL;
+		table->old_capacity = 0;
+		table->migrate_pos = 0;
+	}
 	if (table->buckets)
 	{
 		table->realloc_fn(table->buckets, table->capacity * sizeof(genc_slist_head_t*), 0, table->opaque);
@@ -136,6 +313,22 @@ static genc_bool_t genc_item_matches_key(struct slist_head* entry, void* data)
 	return table->key_equality_fn(entry_key, ctx->key, op);
 }
 
+/* Returns the reference to the first item in the chain matching ctx's key, or
+ * to the chain's terminating NULL, adding the number of items passed over to
+ * *skipped. */
+static GENC_INLINE genc_slist_head_t** genc_cht_find_in_chain(
+	genc_slist_head_t** ref, genc_cht_match_ctx_t* ctx, size_t* skipped)
+{
+	genc_slist_head_t* cur;
+	for (; (cur = *ref); ref = &cur->next)
+	{
+		if (genc_item_matches_key(cur, ctx))
+			break;
+		++*skipped;
+	}
+	return ref;
+}
+
 /* Inserts the given item into the hash table.
  * Returns 0 to report failure due to a duplicate, 1 on success. */
 genc_bool_t genc_cht_insert_item(struct genc_chaining_hash_table* table, struct slist_head* item)
@@ -143,6 +336,7 @@ genc_bool_t genc_cht_insert_item(struct genc_chaining_hash_table* table, struct
 	unsigned new_load;
 	if (!item) return 0;
 	
+	genc_cht_migrate_step(table);
 	new_load = (unsigned)(100ul * (table->item_count + 1ul) / table->capacity);
 	if (new_load > table->load_percent_grow_threshold)
 	{
@@ -159,21 +353,32 @@ genc_bool_t genc_cht_insert_item(struct genc_chaining_hash_table* table, struct
 		genc_cht_match_ctx_t ctx;
 		void* op = table->opaque;
 		void* key = table->get_key_fn(item, op);
-		genc_hash_t hash = table->hash_fn(key, op);
-		size_t idx = hash & (table->capacity - 1ul);
+		genc_hash_t hash = genc_cht_hash_key(table, key);
+		genc_slist_head_t** bucket = genc_cht_bucket_ref_for_hash(table, hash);
+		genc_slist_head_t** ref;
+		size_t chain_length = 0;
 	
 		ctx.table = table;
 		ctx.key = key;
 		
-		found = genc_slist_find_entry(table->buckets[idx], genc_item_matches_key, &ctx);
+		/* scan for duplicates (in multimap mode, for the first item with the
+		 * same key), measuring the chain for the collision guard */
+		ref = genc_cht_find_in_chain(bucket, &ctx, &chain_length);
+		found = *ref;
+		GENC_HASH_STATS_INC(table->stats, inserts);
+		GENC_HASH_STATS_PROBE(table->stats, chain_length);
 		if (found)
 		{
-			/* duplicate exists */
-			return 0;
+			GENC_HASH_STATS_INC(table->stats, insert_duplicates);
+			if (!table->multimap)
+				return 0;
 		}
-		/* insert at beginning of chain */
-		genc_slist_insert_at(item, table->buckets + idx);
+		/* insert before the run of equal keys, or at beginning of chain */
+		genc_slist_insert_at(item, found ? ref : bucket);
 		++table->item_count;
+		
+		if (table->max_chain_length > 0 && chain_length >= table->max_chain_length && table->seeded_hash_fn)
+			genc_cht_guard_reseed(table);
 	}
 	return 1;
 }
@@ -188,17 +393,15 @@ struct slist_head* genc_cht_find(struct genc_chaining_hash_table* table, void* k
 
 static size_t genc_cht_get_bucket_index_for_key(struct genc_chaining_hash_table* table, void* key)
 {
-	void* op = table->opaque;
 	genc_hash_t hash = 0;
 	
-	hash = table->hash_fn(key, op);
+	hash = genc_cht_hash_key(table, key);
 	return hash & (table->capacity - 1ul);
 }
 
 struct slist_head** genc_cht_get_bucket_ref_for_key(struct genc_chaining_hash_table* table, void* key)
 {
-	size_t idx = genc_cht_get_bucket_index_for_key(table, key);
-	return table->buckets + idx;
+	return genc_cht_bucket_ref_for_hash(table, genc_cht_hash_key(table, key));
 }
 
 static size_t genc_cht_get_bucket_index_for_item(struct genc_chaining_hash_table* table, genc_cht_head_t* item)
@@ -210,15 +413,94 @@ static size_t genc_cht_get_bucket_index_for_item(struct genc_chaining_hash_table
 /* Looks up the key in the table, returning the reference pointing to the
  * matching item, or NULL if not found. The reference may be passed to
  * genc_cht_find_ref() for efficient removal. */
-struct slist_head** genc_cht_find_ref(struct genc_chaining_hash_table* table, void* key)
+static struct slist_head** genc_cht_find_ref_counting(struct genc_chaining_hash_table* table, void* key, size_t* skipped)
 {
-	struct slist_head** bucket = genc_cht_get_bucket_ref_for_key(table, key);
+	struct slist_head** bucket;
+	genc_cht_migrate_step(table);
+	bucket = genc_cht_get_bucket_ref_for_key(table, key);
 	
 	genc_cht_match_ctx_t ctx;
 	ctx.table = table;
 	ctx.key = key;
 
-	return genc_slist_find_entry_ref(bucket, genc_item_matches_key, &ctx);
+	return genc_cht_find_in_chain(bucket, &ctx, skipped);
+}
+
+struct slist_head** genc_cht_find_ref(struct genc_chaining_hash_table* table, void* key)
+{
+	size_t skipped GENC_UNUSED = 0;
+	struct slist_head** ref = genc_cht_find_ref_counting(table, key, &skipped);
+	GENC_HASH_STATS_INC(table->stats, lookups);
+	GENC_HASH_STATS_ADD(table->stats, lookup_hits, *ref != NULL);
+	GENC_HASH_STATS_PROBE(table->stats, skipped);
+	return ref;
+}
+
+genc_cht_range_t genc_cht_find_range(struct genc_chaining_hash_table* table, void* key)
+{
+	genc_cht_range_t range;
+	genc_slist_head_t* cur;
+	genc_cht_match_ctx_t ctx;
+	ctx.table = table;
+	ctx.key = key;
+	
+	range.first = genc_cht_find(table, key);
+	range.last = range.first;
+	if (range.first)
+	{
+		for (cur = range.first->next; cur && genc_item_matches_key(cur, &ctx); cur = cur->next)
+			range.last = cur;
+	}
+	return range;
+}
+
+/* Number of keys hashed and prefetched ahead of resolving them in batch lookups */
+#define CHT_BATCH_CHUNK 16
+
+size_t genc_cht_find_batch(
+	struct genc_chaining_hash_table* table, void* const* keys, struct slist_head** out_items, size_t count)
+{
+	genc_slist_head_t** bucket_refs[CHT_BATCH_CHUNK];
+	size_t found_count = 0;
+	size_t start, i;
+	genc_cht_match_ctx_t ctx;
+	ctx.table = table;
+	
+	genc_cht_migrate_step(table);
+	
+	for (start = 0; start < count; start += CHT_BATCH_CHUNK)
+	{
+		size_t chunk = count - start;
+		if (chunk > CHT_BATCH_CHUNK)
+			chunk = CHT_BATCH_CHUNK;
+		
+		/* hash the whole chunk and request the bucket heads */
+		for (i = 0; i < chunk; ++i)
+		{
+			bucket_refs[i] = genc_cht_bucket_ref_for_hash(table, genc_cht_hash_key(table, keys[start + i]));
+			GENC_PREFETCH(bucket_refs[i]);
+		}
+		/* then request the first item in each chain */
+		for (i = 0; i < chunk; ++i)
+		{
+			genc_slist_head_t* first = *bucket_refs[i];
+			if (first)
+				GENC_PREFETCH(first);
+		}
+		/* and finally resolve */
+		for (i = 0; i < chunk; ++i)
+		{
+			size_t skipped GENC_UNUSED = 0;
+			ctx.key = keys[start + i];
+			out_items[start + i] = *genc_cht_find_in_chain(bucket_refs[i], &ctx, &skipped);
+			if (out_items[start + i])
+				++found_count;
+			GENC_HASH_STATS_PROBE(table->stats, skipped);
+		}
+	}
+	GENC_HASH_STATS_ADD(table->stats, lookups, count);
+	GENC_HASH_STATS_ADD(table->stats, lookup_hits, found_count);
+	return found_count;
 }
 
 /* Removes the item referred to by item_ref from the hash table, returning it.
@@ -231,6 +513,9 @@ struct slist_head* genc_cht_remove_ref(struct genc_chaining_hash_table* table, s
 	{
 		unsigned new_load = 0;
 		--table->item_count;
+		GENC_HASH_STATS_INC(table->stats, removes);
+		/* item_ref is invalid from here on, so only migrate after unlinking */
+		genc_cht_migrate_step(table);
 		new_load = (unsigned)(100ull * (table->item_count) / table->capacity);
 
 		if (new_load > 0 && new_load < table->load_percent_shrink_threshold)
@@ -245,7 +530,8 @@ struct slist_head* genc_cht_remove_ref(struct genc_chaining_hash_table* table, s
 /* Calls genc_cht_find_ref() and calls genc_cht_remove_ref() with the result if a match was found. */
 struct slist_head* genc_cht_remove(struct genc_chaining_hash_table* table, void* key)
 {
-	genc_slist_head_t** found = genc_cht_find_ref(table, key);
+	size_t skipped = 0;
+	genc_slist_head_t** found = genc_cht_find_ref_counting(table, key, &skipped);
 	if (found && *found)
 		return genc_cht_remove_ref(table, found);
 	return NULL;
@@ -259,6 +545,7 @@ void genc_cht_shrink_by(struct genc_chaining_hash_table* table, unsigned log2_sh
 	
 	if (table->capacity <= 1 || log2_shrink_factor == 0)
 		return;
+	genc_cht_complete_resize(table);
 	/*  */
 	new_capacity = table->capacity >> log2_shrink_factor;
 	if (new_capacity < 1)
@@ -275,9 +562,13 @@ void genc_cht_shrink_by(struct genc_chaining_hash_table* table, unsigned log2_sh
 		size_t i;
 		for (i = new_capacity; i < table->capacity; ++i)
 		{
+#if GENC_HASH_TABLE_STATS
+			GENC_HASH_STATS_ADD(table->stats, items_moved, genc_slist_length(buckets[i]));
+#endif
 			genc_slist_splice(&buckets[i & mask], buckets + i);
 		}
 	}
+	GENC_HASH_STATS_INC(table->stats, resizes);
 	
 	table->buckets = GENC_CXX_CAST(genc_slist_head_t**, table->realloc_fn(buckets, table->capacity * sizeof(genc_slist_head_t*), new_capacity * sizeof(genc_slist_head_t*), table->opaque));
 	table->capacity = new_capacity;
@@ -297,6 +588,23 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 	}
 	if (new_capacity == table->capacity)
 		return;
+	genc_cht_complete_resize(table);
+	
+	if (table->migrate_buckets_per_op > 0)
+	{
+		/* incremental: keep the old array around and migrate chains later */
+		buckets = GENC_CXX_CAST(genc_slist_head_t**, table->realloc_fn(NULL, 0, new_capacity * sizeof(genc_slist_head_t*), table->opaque));
+		if (!buckets)
+			return;
+		GENC_MEMSET(buckets, 0, new_capacity * sizeof(buckets[0]));
+		table->old_buckets = table->buckets;
+		table->old_capacity = table->capacity;
+		table->migrate_pos = 0;
+		table->buckets = buckets;
+		table->capacity = new_capacity;
+		GENC_HASH_STATS_INC(table->stats, resizes);
+		return;
+	}
 
 	buckets = GENC_CXX_CAST(genc_slist_head_t**, table->realloc_fn(table->buckets, table->capacity * sizeof(genc_slist_head_t*), new_capacity * sizeof(genc_slist_head_t*), table->opaque));
 	if (!buckets)
@@ -307,11 +615,11 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 	
 	table->buckets = buckets;
 	table->capacity = new_capacity;
+	GENC_HASH_STATS_INC(table->stats, resizes);
 	
 	{
 		void* op = table->opaque;
 		genc_chaining_hash_get_item_key_fn get_key = table->get_key_fn;
-		genc_chaining_key_hash_fn key_hash = table->hash_fn;
 	
 		/* Re-hash each existing bucket chain. */
 		size_t mask = new_capacity - 1;
@@ -325,7 +633,7 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 				while (cur) /* Need this as we'd end up skipping an item after every one we remove otherwise */
 				{
 					void* key = get_key(cur, op);
-					genc_hash_t hash = key_hash(key, op);
+					genc_hash_t hash = genc_cht_hash_key(table, key);
 					size_t idx = hash & mask;
 				
 					if (idx == i)
@@ -334,6 +642,7 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 					genc_slist_head_t* rem GENC_UNUSED = genc_slist_remove_at(cur_ref);
 					assert(rem == cur);
 					genc_slist_insert_at(cur, buckets + idx);
+					GENC_HASH_STATS_INC(table->stats, items_moved);
 					cur = *cur_ref;
 				}
 			}
@@ -341,6 +650,47 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 	}
 }
 
+static void genc_cht_stats_add_chain(genc_hash_table_stats_snapshot_t* snapshot, genc_slist_head_t* chain)
+{
+	size_t length = genc_slist_length(chain);
+	++snapshot->chain_lengths[genc_hash_stats_histogram_bin(length)];
+	if (length > snapshot->longest_chain)
+		snapshot->longest_chain = length;
+}
+
+void genc_cht_stats_snapshot(struct genc_chaining_hash_table* table, genc_hash_table_stats_snapshot_t* out_snapshot)
+{
+	size_t i;
+	GENC_MEMSET(out_snapshot, 0, sizeof(*out_snapshot));
+#if GENC_HASH_TABLE_STATS
+	out_snapshot->ops = table->stats;
+#endif
+	out_snapshot->item_count = table->item_count;
+	out_snapshot->capacity = table->capacity;
+	/* during an incremental resize, count the chains lookups actually use */
+	for (i = 0; i < table->capacity; ++i)
+	{
+		if (!table->old_buckets || (i & (table->old_capacity - 1)) < table->migrate_pos)
+			genc_cht_stats_add_chain(out_snapshot, table->buckets[i]);
+	}
+	for (i = table->migrate_pos; i < table->old_capacity; ++i)
+		genc_cht_stats_add_chain(out_snapshot, table->old_buckets[i]);
+}
+
+/* In a multimap, checks that no item with entry's key follows the end of
+ * entry's run of equal keys. */
+static void genc_cht_verify_run_ends(struct genc_chaining_hash_table* table, genc_slist_head_t* entry)
+{
+	genc_slist_head_t* later;
+	genc_cht_match_ctx_t ctx;
+	ctx.table = table;
+	ctx.key = table->get_key_fn(entry, table->opaque);
+	if (!entry->next || genc_item_matches_key(entry->next, &ctx))
+		return;
+	for (later = entry->next; later; later = later->next)
+		assert(!genc_item_matches_key(later, &ctx));
+}
+
 /* Walks all the elements in the hash table and checks they're still in the correct bucket. */
 void genc_cht_verify(struct genc_chaining_hash_table* table)
 {
@@ -348,16 +698,39 @@ void genc_cht_verify(struct genc_chaining_hash_table* table)
 	genc_slist_head_t** bucket_head = NULL;
 	genc_slist_head_t* entry = NULL;
 	genc_hash_t mask GENC_UNUSED = table->capacity - 1;
+	genc_hash_t old_mask GENC_UNUSED = table->old_capacity - 1;
 	genc_cht_for_each_ref(table, entry, bucket_head, bucket)
 	{
-		genc_hash_t hash GENC_UNUSED = table->hash_fn(table->get_key_fn(entry, table->opaque), table->opaque);
+		genc_hash_t hash GENC_UNUSED = genc_cht_hash_key(table, table->get_key_fn(entry, table->opaque));
 		assert((hash & mask) == bucket);
+		/* during migration, new buckets only fill up once their old one has been migrated */
+		assert(!table->old_buckets || (hash & old_mask) < table->migrate_pos);
+		if (table->multimap)
+			genc_cht_verify_run_ends(table, entry);
+	}
+	if (table->old_buckets)
+	{
+		for (bucket = table->migrate_pos; bucket < table->old_capacity; ++bucket)
+		{
+			bucket_head = table->old_buckets + bucket;
+			genc_slist_for_each_head_ref(entry, bucket_head)
+			{
+				genc_hash_t hash GENC_UNUSED = genc_cht_hash_key(table, table->get_key_fn(entry, table->opaque));
+				assert((hash & old_mask) == bucket);
+			}
+		}
+		for (bucket = 0; bucket < table->migrate_pos; ++bucket)
+			assert(table->old_buckets[bucket] == NULL);
 	}
 }
 
 genc_bool_t genc_cht_remove_item(struct genc_chaining_hash_table* table, genc_slist_head_t* item)
 {
-	genc_slist_head_t** found = genc_cht_find_ref(table, table->get_key_fn(item, table->opaque));
+	size_t skipped = 0;
+	genc_slist_head_t** found = genc_cht_find_ref_counting(table, table->get_key_fn(item, table->opaque), &skipped);
+	/* in a multimap, the item may be anywhere in the run of equal keys */
+	while (found && *found && *found != item && table->multimap)
+		found = &(*found)->next;
 	if (found && *found == item)
 	{
 		genc_cht_remove_ref(table, found);
@@ -385,6 +758,7 @@ genc_cht_head_t* genc_cht_next_item(struct genc_chaining_hash_table* table, genc
 
 genc_cht_head_t* genc_cht_first_item(struct genc_chaining_hash_table* table)
 {
+	genc_cht_complete_resize(table);
 	genc_cht_head_t** const buckets = table->buckets;
 	for (size_t idx = 0; idx < table->capacity; ++idx)
 	{
@@ -397,6 +771,8 @@ genc_cht_head_t* genc_cht_first_item(struct genc_chaining_hash_table* table)
 genc_cht_location_t genc_cht_next_item_with_bucket(struct genc_chaining_hash_table* table, genc_cht_location_t prev)
 {
 	genc_cht_location_t location = prev;
+	if (location.item == NULL && location.bucket == 0)
+		genc_cht_complete_resize(table);
 	if (location.item != NULL)
 	{
 		genc_cht_head_t* next = prev.item->next;
@@ -99,18 +99,87 @@ genc_bool_t genc_chaining_hash_table_init_ext(
 /* Returns the current number of items in the hash table. */
 size_t genc_cht_count(struct genc_chaining_hash_table* table);
 
+/* Incremental resizing: with buckets_per_op > 0, growing the table allocates
+ * the new bucket array but leaves the items in the old one. Every subsequent
+ * insertion, lookup and removal then moves the chains of buckets_per_op old
+ * buckets across, until the old array is empty and freed. Lookups consult
+ * whichever array holds the key's chain, so the worst-case cost of any single
+ * operation is bounded rather than proportional to the table size. 0 (the
+ * default) resizes in one go. Values of at least 2 ensure that migration
+ * normally completes before the table needs to grow again; otherwise, the
+ * remaining migration is completed at that point.
+ * While a resize is in progress, the genc_cht_for_each_* macros will miss
+ * items; call genc_cht_complete_resize() first. (The iteration functions
+ * genc_cht_first_item() and genc_cht_next_item_with_bucket() do so themselves
+ * when starting from the beginning of the table.) */
+void genc_cht_set_incremental_resize(struct genc_chaining_hash_table* table, size_t buckets_per_op);
+
+/* Returns true if an incremental resize is in progress. */
+genc_bool_t genc_cht_is_resizing(struct genc_chaining_hash_table* table);
+
+/* Finishes any incremental resize in progress immediately. */
+void genc_cht_complete_resize(struct genc_chaining_hash_table* table);
+
 size_t genc_cht_capacity(struct genc_chaining_hash_table* table);
 
+/* Switches the table to the seeded hash function hash_fn (which replaces the
+ * one passed on initialisation) with the given seed, rehashing any items
+ * already in the table. Seeds should be picked randomly if keys may come from
+ * an untrusted source. */
+void genc_cht_set_seeded_hash(struct genc_chaining_hash_table* table, genc_seeded_key_hash_fn hash_fn, uint64_t seed);
+
+/* Rehashes all items with a new seed; requires a seeded hash function. */
+void genc_cht_reseed(struct genc_chaining_hash_table* table, uint64_t seed);
+
+/* Collision guard for tables with a seeded hash function: if an insertion
+ * finds a chain of more than max_length items, the table is transparently
+ * rehashed with a new seed derived from the current one. If the longest chain
+ * is still too long afterwards (e.g. due to genuinely equal keys in a
+ * multimap, or an unsuitable hash function), the limit is doubled so that
+ * rehashing can't happen over and over. 0 (the default) disables the guard.
+ * The number of reseeds so far is available in table->reseed_count. */
+void genc_cht_set_max_chain_length(struct genc_chaining_hash_table* table, size_t max_length);
+
+/* Multimap mode: insertions accept items whose key is already present, and
+ * place them directly before the first item with the same key, so that all
+ * items with equal keys form one contiguous run in the chain (which resizing
+ * and rehashing preserve). Insertion then only scans the chain up to the
+ * first equal item. genc_cht_find() returns the most recently inserted item
+ * for the key; use genc_cht_find_range() to visit all of them. Set on an
+ * empty table. */
+void genc_cht_set_multimap(struct genc_chaining_hash_table* table, genc_bool_t multimap);
+
 /* Drops all items from the table (without deleting them) and deallocates bucket array memory. */
 void genc_cht_destroy(struct genc_chaining_hash_table* table);
 
 /* Inserts the given item into the hash table.
- * Returns false/0 to report failure due to a duplicate, true/1 on success. */
+ * Returns false/0 to report failure due to a duplicate, true/1 on success.
+ * In multimap mode, duplicate keys are allowed and insertion always succeeds
+ * (but the same item must not be inserted twice). */
 genc_bool_t genc_cht_insert_item(struct genc_chaining_hash_table* table, struct slist_head* item);
 
 /* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
 struct slist_head* genc_cht_find(struct genc_chaining_hash_table* table, void* key);
 
+/* Run of items with equal keys in a multimap table: first to last, linked by
+ * their next pointers. Both are NULL if there are no matching items. */
+struct genc_cht_range
+{
+	struct slist_head* first;
+	struct slist_head* last;
+};
+typedef struct genc_cht_range genc_cht_range_t;
+
+/* Looks up all items with the given key in a single chain traversal. */
+genc_cht_range_t genc_cht_find_range(struct genc_chaining_hash_table* table, void* key);
+
+/* Looks up count keys at once, storing the matching item (or NULL) for keys[i]
+ * in out_items[i]. Returns the number of keys found. The keys' buckets and the
+ * first item of each chain are prefetched before any of the keys are resolved,
+ * so the cache misses for different keys overlap. */
+size_t genc_cht_find_batch(
+	struct genc_chaining_hash_table* table, void* const* keys, struct slist_head** out_items, size_t count);
+
 /* Hashes the key and returns the bucket into which the key falls */
 struct slist_head** genc_cht_get_bucket_ref_for_key(struct genc_chaining_hash_table* table, void* key);
 
@@ -140,6 +209,10 @@ void genc_cht_grow_by(struct genc_chaining_hash_table* table, unsigned log2_grow
 /* Walks all the elements in the hash table and checks they're still in the correct bucket. */
 void genc_cht_verify(struct genc_chaining_hash_table* table);
 
+/* Fills in the table's operation counters (see GENC_HASH_TABLE_STATS) and
+ * its current chain length histogram, which takes a pass over all buckets. */
+void genc_cht_stats_snapshot(struct genc_chaining_hash_table* table, genc_hash_table_stats_snapshot_t* out_snapshot);
+
 genc_cht_head_t* genc_cht_next_item(struct genc_chaining_hash_table* table, genc_cht_head_t* after_item);
 genc_cht_head_t* genc_cht_first_item(struct genc_chaining_hash_table* table);
 struct genc_cht_location
@@ -165,6 +238,24 @@ struct genc_chaining_hash_table
 	struct slist_head** buckets;
 	uint8_t load_percent_grow_threshold;
 	uint8_t load_percent_shrink_threshold;
+	/* Incremental resizing state: while old_buckets is non-NULL, old buckets
+	 * from migrate_pos onwards still hold their chains; those before it have
+	 * been moved into buckets. */
+	struct slist_head** old_buckets;
+	size_t old_capacity;
+	size_t migrate_pos;
+	size_t migrate_buckets_per_op;
+	/* Seeded hashing: if seeded_hash_fn is set, it is used with seed instead
+	 * of hash_fn. max_chain_length 0 disables the reseeding guard. */
+	genc_seeded_key_hash_fn seeded_hash_fn;
+	uint64_t seed;
+	size_t max_chain_length;
+	size_t reseed_count;
+	/* Duplicate keys are allowed, see genc_cht_set_multimap() */
+	genc_bool_t multimap;
+#if GENC_HASH_TABLE_STATS
+	genc_hash_table_stats_t stats;
+#endif
 };
 typedef struct genc_chaining_hash_table genc_chaining_hash_table_t;
 
@@ -185,6 +276,11 @@ genc_container_of(genc_cht_find((table), (key)), type, header_name)
 #define genc_cht_remove_obj(table, key, type, header_name) \
 	genc_container_of(genc_cht_remove((table), (key)), type, header_name)
 
+/* Walk through the items in a range returned by genc_cht_find_range().
+ * The current item must not be removed. */
+#define genc_cht_for_each_in_range(RANGE, CUR_HEAD_VAR) \
+for (CUR_HEAD_VAR = (RANGE).first; CUR_HEAD_VAR != NULL; CUR_HEAD_VAR = (CUR_HEAD_VAR == (RANGE).last ? NULL : CUR_HEAD_VAR->next))
+
 #define genc_cht_for_each_ref(TABLE, ENTRY_VAR, CUR_HEAD_PTR_VAR, BUCKET_VAR) \
 for (BUCKET_VAR = 0, CUR_HEAD_PTR_VAR = ((TABLE)->buckets + BUCKET_VAR); \
 	BUCKET_VAR < (TABLE)->capacity; \
@@ -0,0 +1,458 @@
+#include "concurrent_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+/* Stripe locks get a cache line each so that writers on different stripes
+ * don't contend for it */
+#define CCHT_CACHE_LINE_SIZE 64
+/* Old buckets each insertion or removal moves across during a resize, on top
+ * of the one its own key hashes to */
+#define CCHT_MIGRATE_BUCKETS_PER_OP 4
+
+struct genc_ccht_lock
+{
+	/* During a resize: the stripe's next old bucket to move across */
+	size_t migrate_pos;
+	genc_spinlock_t lock;
+	char padding[CCHT_CACHE_LINE_SIZE - sizeof(size_t) - sizeof(genc_spinlock_t)];
+};
+
+static struct genc_ccht_bucket_array* ccht_alloc_array(genc_concurrent_hash_table_t* table, size_t capacity)
+{
+	struct genc_ccht_bucket_array* array;
+	size_t size;
+	if ((SIZE_MAX - sizeof(*array)) / sizeof(struct slist_head*) < capacity)
+		return NULL;
+	size = sizeof(*array) + capacity * sizeof(struct slist_head*);
+	array = GENC_CXX_CAST(struct genc_ccht_bucket_array*, table->realloc_fn(NULL, 0, size, table->opaque));
+	if (!array)
+		return NULL;
+	array->capacity = capacity;
+	/* heads live directly after the header, in the same allocation */
+	array->heads = (struct slist_head**)(void*)(array + 1);
+	memset(array->heads, 0, capacity * sizeof(struct slist_head*));
+	return array;
+}
+
+static GENC_INLINE size_t ccht_array_size(struct genc_ccht_bucket_array* array)
+{
+	return sizeof(*array) + array->capacity * sizeof(struct slist_head*);
+}
+
+static void ccht_free_array(genc_concurrent_hash_table_t* table, struct genc_ccht_bucket_array* array)
+{
+	table->realloc_fn(array, ccht_array_size(array), 0, table->opaque);
+}
+
+/* The stripe locks and migration sequence counters share an allocation */
+static GENC_INLINE size_t ccht_locks_size(size_t lock_count)
+{
+	return lock_count * (sizeof(struct genc_ccht_lock) + sizeof(size_t));
+}
+
+genc_bool_t genc_concurrent_hash_table_init(
+	genc_concurrent_hash_table_t* table,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	genc_ccht_retire_fn retire_fn,
+	void* opaque,
+	size_t initial_capacity_pow2,
+	size_t lock_count_pow2,
+	uint8_t load_percent_grow_threshold)
+{
+	size_t i;
+	if (!genc_is_pow2(initial_capacity_pow2) || !genc_is_pow2(lock_count_pow2))
+		return 0;
+	/* every bucket must map to exactly one stripe */
+	if (lock_count_pow2 > initial_capacity_pow2)
+		return 0;
+	if (load_percent_grow_threshold == 0 || !retire_fn)
+		return 0;
+	if (SIZE_MAX / (sizeof(struct genc_ccht_lock) + sizeof(size_t)) < lock_count_pow2)
+		return 0;
+
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->key_equality_fn = key_equality_fn;
+	table->realloc_fn = realloc_fn;
+	table->retire_fn = retire_fn;
+	table->opaque = opaque;
+	table->old_array = NULL;
+	table->migrating_stripes = 0;
+	table->item_count = 0;
+	table->load_percent_grow_threshold = load_percent_grow_threshold;
+
+	table->locks = GENC_CXX_CAST(struct genc_ccht_lock*, realloc_fn(NULL, 0, ccht_locks_size(lock_count_pow2), opaque));
+	if (!table->locks)
+		return 0;
+	table->migrate_seqs = (size_t*)(void*)(table->locks + lock_count_pow2);
+	for (i = 0; i < lock_count_pow2; ++i)
+	{
+		genc_spinlock_init(&table->locks[i].lock);
+		table->locks[i].migrate_pos = 0;
+		table->migrate_seqs[i] = 0;
+	}
+	table->lock_count = lock_count_pow2;
+
+	table->array = ccht_alloc_array(table, initial_capacity_pow2);
+	if (!table->array)
+	{
+		realloc_fn(table->locks, ccht_locks_size(lock_count_pow2), 0, opaque);
+		table->locks = NULL;
+		return 0;
+	}
+	return 1;
+}
+
+void genc_ccht_destroy(genc_concurrent_hash_table_t* table)
+{
+	if (table->old_array)
+	{
+		ccht_free_array(table, table->old_array);
+		table->old_array = NULL;
+	}
+	if (table->array)
+	{
+		ccht_free_array(table, table->array);
+		table->array = NULL;
+	}
+	if (table->locks)
+	{
+		table->realloc_fn(table->locks, ccht_locks_size(table->lock_count), 0, table->opaque);
+		table->locks = NULL;
+		table->migrate_seqs = NULL;
+		table->lock_count = 0;
+	}
+	table->item_count = 0;
+}
+
+size_t genc_ccht_count(genc_concurrent_hash_table_t* table)
+{
+	return genc_atomic_load_relaxed(&table->item_count);
+}
+
+size_t genc_ccht_capacity(genc_concurrent_hash_table_t* table)
+{
+	return genc_atomic_load_acquire(&table->array)->capacity;
+}
+
+static GENC_INLINE size_t ccht_stripe(genc_concurrent_hash_table_t* table, genc_hash_t hash)
+{
+	return hash & (table->lock_count - 1);
+}
+
+static void ccht_lock_all(genc_concurrent_hash_table_t* table)
+{
+	size_t i;
+	/* Taking all stripe locks in order excludes all writers */
+	for (i = 0; i < table->lock_count; ++i)
+		genc_spinlock_lock(&table->locks[i].lock);
+}
+
+static void ccht_unlock_all(genc_concurrent_hash_table_t* table)
+{
+	size_t i;
+	for (i = table->lock_count; i > 0; --i)
+		genc_spinlock_unlock(&table->locks[i - 1].lock);
+}
+
+/* Moves the items in bucket old_idx of the old array to the current array.
+ * The caller holds the bucket's stripe lock. Old and new buckets map to the
+ * same stripe, as both capacities are multiples of the lock count. */
+static void ccht_migrate_bucket(genc_concurrent_hash_table_t* table, size_t old_idx)
+{
+	struct genc_ccht_bucket_array* old_array = genc_atomic_load_relaxed(&table->old_array);
+	struct genc_ccht_bucket_array* array = genc_atomic_load_relaxed(&table->array);
+	size_t* seq = &table->migrate_seqs[old_idx & (table->lock_count - 1)];
+	const size_t new_mask = array->capacity - 1;
+	void* op = table->opaque;
+	struct slist_head* cur = old_array->heads[old_idx];
+	if (!cur)
+		return;
+
+	/* Lookups on this stripe which miss from here on will retry */
+	genc_atomic_store_relaxed(seq, *seq + 1);
+	genc_atomic_thread_fence_release();
+	while (cur)
+	{
+		struct slist_head* next = cur->next;
+		size_t idx = table->hash_fn(table->get_key_fn(cur, op), op) & new_mask;
+		/* A lookup following cur's link ends up in a new, NULL-terminated
+		 * chain, so it can't loop. */
+		genc_atomic_store_release(&cur->next, array->heads[idx]);
+		genc_atomic_store_release(&array->heads[idx], cur);
+		cur = next;
+	}
+	genc_atomic_store_release(&old_array->heads[old_idx], NULL);
+	genc_atomic_store_release(seq, *seq + 1);
+}
+
+/* Moves up to *budget of the stripe's remaining old buckets across, with the
+ * stripe lock held. Returns true if this completed the last stripe, in which
+ * case the caller must call ccht_finish_resize() after unlocking. */
+static genc_bool_t ccht_migrate_stripe(genc_concurrent_hash_table_t* table, size_t stripe, size_t* budget)
+{
+	struct genc_ccht_bucket_array* old_array = genc_atomic_load_relaxed(&table->old_array);
+	struct genc_ccht_lock* lock = &table->locks[stripe];
+	if (!old_array || lock->migrate_pos >= old_array->capacity)
+		return 0;
+	while (*budget > 0 && lock->migrate_pos < old_array->capacity)
+	{
+		ccht_migrate_bucket(table, lock->migrate_pos);
+		lock->migrate_pos += table->lock_count;
+		--*budget;
+	}
+	return lock->migrate_pos >= old_array->capacity
+		&& genc_atomic_fetch_sub(&table->migrating_stripes, 1) == 1;
+}
+
+/* Detaches and retires the old array once all of it has been migrated */
+static void ccht_finish_resize(genc_concurrent_hash_table_t* table)
+{
+	struct genc_ccht_bucket_array* old_array;
+	ccht_lock_all(table);
+	old_array = genc_atomic_load_relaxed(&table->old_array);
+	genc_atomic_store_release(&table->old_array, NULL);
+	table->retire_fn(old_array, ccht_array_size(old_array), table->opaque);
+	ccht_unlock_all(table);
+}
+
+/* Publishes a new array of new_capacity buckets, unless the capacity is no
+ * longer expected_capacity (someone else beat us to it) or a resize is still
+ * in progress. The items are moved across later, bucket by bucket. */
+static genc_bool_t ccht_start_resize(genc_concurrent_hash_table_t* table, size_t expected_capacity, size_t new_capacity)
+{
+	struct genc_ccht_bucket_array* array;
+	struct genc_ccht_bucket_array* new_array;
+	genc_bool_t started = 0;
+	size_t i;
+
+	/* Cheap unlocked check first so racing writers that lost don't allocate;
+	 * it is repeated under the locks below. */
+	array = genc_atomic_load_acquire(&table->array);
+	if (array->capacity != expected_capacity || new_capacity <= array->capacity
+	    || genc_atomic_load_acquire(&table->old_array))
+		return 0;
+
+	/* allocate outside the locks, it's O(new_capacity) */
+	new_array = ccht_alloc_array(table, new_capacity);
+	if (!new_array)
+		return 0;
+
+	ccht_lock_all(table);
+	array = genc_atomic_load_relaxed(&table->array);
+	if (array->capacity == expected_capacity && new_capacity > array->capacity
+	    && !genc_atomic_load_relaxed(&table->old_array))
+	{
+		for (i = 0; i < table->lock_count; ++i)
+			table->locks[i].migrate_pos = i;
+		genc_atomic_store_relaxed(&table->migrating_stripes, table->lock_count);
+		/* Lookups load the array before the old array, so anyone seeing the new
+		 * array also sees the old one. Nothing moves until the first migration
+		 * step, so lookups still on the old array alone remain correct. */
+		genc_atomic_store_release(&table->old_array, array);
+		genc_atomic_store_release(&table->array, new_array);
+		started = 1;
+	}
+	ccht_unlock_all(table);
+
+	if (!started)
+		ccht_free_array(table, new_array);
+	return started;
+}
+
+genc_bool_t genc_ccht_resize_step(genc_concurrent_hash_table_t* table, size_t max_buckets)
+{
+	size_t i;
+	for (i = 0; i < table->lock_count && max_buckets > 0; ++i)
+	{
+		genc_bool_t finished;
+		if (!genc_atomic_load_acquire(&table->old_array))
+			break;
+		genc_spinlock_lock(&table->locks[i].lock);
+		finished = ccht_migrate_stripe(table, i, &max_buckets);
+		genc_spinlock_unlock(&table->locks[i].lock);
+		if (finished)
+			ccht_finish_resize(table);
+	}
+	return genc_atomic_load_acquire(&table->old_array) != NULL;
+}
+
+genc_bool_t genc_ccht_grow_by(genc_concurrent_hash_table_t* table, unsigned log2_grow_factor)
+{
+	size_t capacity, new_capacity;
+	genc_bool_t started;
+	while (genc_ccht_resize_step(table, SIZE_MAX))
+		genc_cpu_relax(); /* another thread is retiring the old array */
+	if (log2_grow_factor >= sizeof(size_t) * 8)
+		return 0; /* overflow */
+	capacity = genc_ccht_capacity(table);
+	new_capacity = capacity << log2_grow_factor;
+	if ((new_capacity >> log2_grow_factor) != capacity)
+		return 0; /* overflow */
+	started = ccht_start_resize(table, capacity, new_capacity);
+	while (genc_ccht_resize_step(table, SIZE_MAX))
+		genc_cpu_relax();
+	return started;
+}
+
+/* Locks the key's stripe, first moving its old bucket across (so the caller
+ * only needs to look at the current array) plus a few more of the stripe's,
+ * if a resize is in progress. Sets *finish_resize if the caller must call
+ * ccht_finish_resize() after unlocking. */
+static genc_spinlock_t* ccht_lock_for_write(genc_concurrent_hash_table_t* table, genc_hash_t hash, genc_bool_t* finish_resize)
+{
+	size_t stripe = ccht_stripe(table, hash);
+	genc_spinlock_t* lock = &table->locks[stripe].lock;
+	struct genc_ccht_bucket_array* old_array;
+	size_t budget = CCHT_MIGRATE_BUCKETS_PER_OP;
+
+	genc_spinlock_lock(lock);
+	/* resizes start and finish holding our lock too, so this can't change under us */
+	old_array = genc_atomic_load_relaxed(&table->old_array);
+	*finish_resize = 0;
+	if (old_array)
+	{
+		ccht_migrate_bucket(table, hash & (old_array->capacity - 1));
+		*finish_resize = ccht_migrate_stripe(table, stripe, &budget);
+	}
+	return lock;
+}
+
+genc_bool_t genc_ccht_insert_item(genc_concurrent_hash_table_t* table, struct slist_head* item)
+{
+	void* op = table->opaque;
+	void* key;
+	genc_hash_t hash;
+	genc_spinlock_t* lock;
+	struct genc_ccht_bucket_array* array;
+	struct slist_head** bucket;
+	struct slist_head* cur;
+	size_t count, capacity;
+	genc_bool_t finish_resize;
+
+	if (!item)
+		return 0;
+	key = table->get_key_fn(item, op);
+	hash = table->hash_fn(key, op);
+	lock = ccht_lock_for_write(table, hash, &finish_resize);
+
+	array = genc_atomic_load_relaxed(&table->array);
+	bucket = array->heads + (hash & (array->capacity - 1));
+	for (cur = *bucket; cur; cur = cur->next)
+	{
+		if (table->key_equality_fn(table->get_key_fn(cur, op), key, op))
+		{
+			genc_spinlock_unlock(lock);
+			if (finish_resize)
+				ccht_finish_resize(table);
+			return 0;
+		}
+	}
+	/* item becomes visible to readers with the store to the bucket head */
+	genc_atomic_store_relaxed(&item->next, *bucket);
+	genc_atomic_store_release(bucket, item);
+	count = genc_atomic_fetch_add(&table->item_count, 1) + 1;
+	capacity = array->capacity;
+	genc_spinlock_unlock(lock);
+
+	if (finish_resize)
+		ccht_finish_resize(table);
+	if (100ul * count / capacity > table->load_percent_grow_threshold && capacity <= SIZE_MAX / 2)
+	{
+		/* Passing the capacity we saw means racing inserts trigger only one
+		 * grow. If the previous one is still migrating, help it along instead. */
+		if (!ccht_start_resize(table, capacity, capacity * 2))
+			genc_ccht_resize_step(table, CCHT_MIGRATE_BUCKETS_PER_OP);
+	}
+	return 1;
+}
+
+/* Searches one bucket chain without locking */
+static struct slist_head* ccht_find_in_array(
+	genc_concurrent_hash_table_t* table, struct genc_ccht_bucket_array* array, genc_hash_t hash, void* key)
+{
+	void* op = table->opaque;
+	struct slist_head* cur = genc_atomic_load_acquire(&array->heads[hash & (array->capacity - 1)]);
+	while (cur)
+	{
+		if (table->key_equality_fn(table->get_key_fn(cur, op), key, op))
+			return cur;
+		cur = genc_atomic_load_acquire(&cur->next);
+	}
+	return NULL;
+}
+
+struct slist_head* genc_ccht_find(genc_concurrent_hash_table_t* table, void* key)
+{
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	size_t* seq_ptr = &table->migrate_seqs[ccht_stripe(table, hash)];
+
+	while (1)
+	{
+		size_t seq = genc_atomic_load_acquire(seq_ptr);
+		struct genc_ccht_bucket_array* array = genc_atomic_load_acquire(&table->array);
+		struct genc_ccht_bucket_array* old_array = genc_atomic_load_acquire(&table->old_array);
+		struct slist_head* found = ccht_find_in_array(table, array, hash, key);
+		if (found)
+			return found;
+		if (old_array)
+		{
+			found = ccht_find_in_array(table, old_array, hash, key);
+			if (found)
+				return found;
+		}
+
+		/* A miss is only conclusive if no items on this stripe moved meanwhile.
+		 * Otherwise, retry straight away: moving one bucket's items is quick,
+		 * and there's nothing else to wait for. */
+		genc_atomic_thread_fence_acquire();
+		if (!(seq & 1) && genc_atomic_load_relaxed(seq_ptr) == seq)
+			return NULL;
+		genc_cpu_relax();
+	}
+}
+
+/* Unlinks the first item in the key's chain for which the key matches and,
+ * if item is non-NULL, which is item. */
+static struct slist_head* ccht_remove(genc_concurrent_hash_table_t* table, void* key, struct slist_head* item)
+{
+	void* op = table->opaque;
+	genc_hash_t hash = table->hash_fn(key, op);
+	genc_bool_t finish_resize;
+	genc_spinlock_t* lock = ccht_lock_for_write(table, hash, &finish_resize);
+	struct genc_ccht_bucket_array* array;
+	struct slist_head** ref;
+	struct slist_head* cur;
+
+	array = genc_atomic_load_relaxed(&table->array);
+	ref = array->heads + (hash & (array->capacity - 1));
+	for (cur = *ref; cur; ref = &cur->next, cur = *ref)
+	{
+		if ((!item || cur == item) && table->key_equality_fn(table->get_key_fn(cur, op), key, op))
+		{
+			/* cur->next is left intact for any lookups currently on cur */
+			genc_atomic_store_release(ref, cur->next);
+			genc_atomic_fetch_sub(&table->item_count, 1);
+			break;
+		}
+	}
+	genc_spinlock_unlock(lock);
+	if (finish_resize)
+		ccht_finish_resize(table);
+	return cur;
+}
+
+struct slist_head* genc_ccht_remove(genc_concurrent_hash_table_t* table, void* key)
+{
+	return ccht_remove(table, key, NULL);
+}
+
+genc_bool_t genc_ccht_remove_item(genc_concurrent_hash_table_t* table, struct slist_head* item)
+{
+	return ccht_remove(table, table->get_key_fn(item, table->opaque), item) != NULL;
+}
@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * A chaining hash table for read-mostly concurrent use, built on the same
+ * intrusive slist_head chaining as genc_chaining_hash_table.
+ *
+ * Lookups take no locks: they follow bucket and item links using acquire
+ * loads, in the style of RCU. Insertions and removals lock only the stripe
+ * of buckets the key hashes to, so writers on different stripes proceed in
+ * parallel.
+ *
+ * Growing the table is incremental: a new bucket array is published alongside
+ * the old one (briefly locking all stripes, but without touching any items),
+ * and the items are then moved across one old bucket at a time, under that
+ * bucket's stripe lock. Each insertion and removal moves its own key's old
+ * bucket plus a few more of its stripe's; genc_ccht_resize_step() lets
+ * writers drive the rest explicitly. Lookups meanwhile search both arrays. A
+ * lookup which misses while items on its stripe were being moved retries, as
+ * the relinking may have diverted it, but it never waits for more than one
+ * bucket's worth of relinking; lookup hits never retry.
+ *
+ * Memory reclamation follows the RCU model and is the client's responsibility:
+ * - Lookups must happen inside a client-defined read-side critical section
+ *   (RCU read lock, epoch, etc.)
+ * - An item returned by a removal function may still be read by concurrent
+ *   lookups. It must not be freed, reused or reinserted until a grace period
+ *   has elapsed.
+ * - Replaced bucket arrays are handed to the client's retire function, which
+ *   must free them (with the realloc function) only after a grace period.
+ *
+ * The table never shrinks.
+ */
+
+#ifndef GENCCONT_CONCURRENT_HASH_TABLE_H
+#define GENCCONT_CONCURRENT_HASH_TABLE_H
+
+#include "chaining_hash_table.h"
+#include "atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Called with a bucket array which is no longer in use by the table, but may
+ * still be read by lookups. Once they're guaranteed to have finished,
+ * free it via realloc_fn(ptr, size, 0, opaque). */
+typedef void(*genc_ccht_retire_fn)(void* ptr, size_t size, void* opaque);
+
+/* A bucket array and its capacity, published together */
+struct genc_ccht_bucket_array
+{
+	size_t capacity;
+	struct slist_head** heads;
+};
+
+struct genc_ccht_lock;
+
+struct genc_concurrent_hash_table
+{
+	genc_chaining_key_hash_fn hash_fn;
+	genc_chaining_hash_get_item_key_fn get_key_fn;
+	genc_chaining_hash_key_equality_fn key_equality_fn;
+	genc_realloc_fn realloc_fn;
+	genc_ccht_retire_fn retire_fn;
+	void* opaque;
+	/* Current bucket array, only ever accessed atomically */
+	struct genc_ccht_bucket_array* array;
+	/* During a resize, the previous bucket array, whose items are still being
+	 * moved to the current one; NULL otherwise. Only accessed atomically. */
+	struct genc_ccht_bucket_array* old_array;
+	/* Stripe locks; the stripe for a key is hash & (lock_count - 1) */
+	struct genc_ccht_lock* locks;
+	/* Per stripe: incremented before and after items on the stripe are moved to
+	 * the new array, so it's odd while they are */
+	size_t* migrate_seqs;
+	size_t lock_count;
+	/* During a resize, the number of stripes with old buckets left to move */
+	size_t migrating_stripes;
+	size_t item_count;
+	uint8_t load_percent_grow_threshold;
+};
+typedef struct genc_concurrent_hash_table genc_concurrent_hash_table_t;
+
+/* Initialises the table. lock_count_pow2 is the number of stripe locks, and
+ * initial_capacity_pow2 must be at least that large. The table grows (doubling)
+ * at the load factor threshold (percent, 1-255).
+ * Initialisation and destruction must not race with any other operations. */
+genc_bool_t genc_concurrent_hash_table_init(
+	genc_concurrent_hash_table_t* table,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	genc_ccht_retire_fn retire_fn,
+	void* opaque,
+	size_t initial_capacity_pow2,
+	size_t lock_count_pow2,
+	uint8_t load_percent_grow_threshold);
+
+/* Frees the bucket array and locks directly (no retire call). Items are not touched. */
+void genc_ccht_destroy(genc_concurrent_hash_table_t* table);
+
+/* Approximate under concurrent modification */
+size_t genc_ccht_count(genc_concurrent_hash_table_t* table);
+size_t genc_ccht_capacity(genc_concurrent_hash_table_t* table);
+
+/* Inserts the item, unless an item with the same key is present (returns false). */
+genc_bool_t genc_ccht_insert_item(genc_concurrent_hash_table_t* table, struct slist_head* item);
+
+/* Lock-free lookup, must be called within a read-side critical section. */
+struct slist_head* genc_ccht_find(genc_concurrent_hash_table_t* table, void* key);
+
+/* Unlinks and returns the item with the given key, or NULL if none. See above
+ * regarding reuse of the item. */
+struct slist_head* genc_ccht_remove(genc_concurrent_hash_table_t* table, void* key);
+
+/* Unlinks the given item if it is in the table. */
+genc_bool_t genc_ccht_remove_item(genc_concurrent_hash_table_t* table, struct slist_head* item);
+
+/* Moves up to max_buckets old buckets' items across if a resize is in
+ * progress, locking one stripe at a time. Returns true if the resize is still
+ * in progress afterwards. */
+genc_bool_t genc_ccht_resize_step(genc_concurrent_hash_table_t* table, size_t max_buckets);
+
+/* Grows the bucket array by a factor of 1 << log2_grow_factor, and moves all
+ * items across before returning (finishing any resize in progress first).
+ * Writers are only blocked on the stripe currently being moved. */
+genc_bool_t genc_ccht_grow_by(genc_concurrent_hash_table_t* table, unsigned log2_grow_factor);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#define genc_ccht_find_obj(table, key, type, header_name) \
+genc_container_of(genc_ccht_find((table), (key)), type, header_name)
+
+#define genc_ccht_remove_obj(table, key, type, header_name) \
+genc_container_of(genc_ccht_remove((table), (key)), type, header_name)
+
+#endif
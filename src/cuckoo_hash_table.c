@@ -0,0 +1,518 @@
+#include "cuckoo_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+#define CKHT_NO_BUCKET SIZE_MAX
+
+/* Entry in the breadth-first displacement search: an occupied bucket whose
+ * item could move to its alternative group, and the queue index of the bucket
+ * the search came from (whose item would move into this one). */
+struct genc_ckht_bfs_node
+{
+	size_t bucket;
+	size_t parent;
+};
+
+/* Bucket access helpers, dispatching to the client's callbacks or, for
+ * inline-key descriptors, to direct memory comparisons. */
+
+static GENC_INLINE genc_bool_t ckht_inline_keys_equal(const void* key1, const void* key2, size_t key_size)
+{
+	if (key_size == sizeof(uint64_t))
+	{
+		uint64_t k1, k2;
+		memcpy(&k1, key1, sizeof(k1));
+		memcpy(&k2, key2, sizeof(k2));
+		return k1 == k2;
+	}
+	else if (key_size == sizeof(uint32_t))
+	{
+		uint32_t k1, k2;
+		memcpy(&k1, key1, sizeof(k1));
+		memcpy(&k2, key2, sizeof(k2));
+		return k1 == k2;
+	}
+	return 0 == memcmp(key1, key2, key_size);
+}
+
+static GENC_INLINE void* ckht_item_key(genc_cuckoo_hash_table_t* table, void* item)
+{
+	if (table->desc.key_size)
+		return GENC_CXX_CAST(char*, item) + table->desc.key_offset;
+	return table->desc.get_key_fn(item, table->opaque);
+}
+
+static GENC_INLINE genc_bool_t ckht_keys_equal(genc_cuckoo_hash_table_t* table, void* key1, void* key2)
+{
+	if (table->desc.key_size)
+		return ckht_inline_keys_equal(key1, key2, table->desc.key_size);
+	return table->desc.key_equality_fn(key1, key2, table->opaque);
+}
+
+static GENC_INLINE genc_bool_t ckht_item_is_empty(genc_cuckoo_hash_table_t* table, void* item)
+{
+	if (table->desc.key_size)
+		return ckht_inline_keys_equal(
+			GENC_CXX_CAST(char*, item) + table->desc.key_offset, table->desc.empty_key, table->desc.key_size);
+	return table->desc.item_empty_fn(item, table->opaque);
+}
+
+static void ckht_item_clear(genc_cuckoo_hash_table_t* table, void* item)
+{
+	if (table->desc.item_clear_fn)
+	{
+		table->desc.item_clear_fn(item, table->opaque);
+	}
+	else
+	{
+		memset(item, 0, table->desc.bucket_size);
+		memcpy(GENC_CXX_CAST(char*, item) + table->desc.key_offset, table->desc.empty_key, table->desc.key_size);
+	}
+}
+
+static GENC_INLINE char* ckht_bucket_at(genc_cuckoo_hash_table_t* table, size_t idx)
+{
+	return GENC_CXX_CAST(char*, table->buckets) + table->desc.bucket_size * idx;
+}
+
+static GENC_INLINE size_t ckht_bucket_index(genc_cuckoo_hash_table_t* table, void* item)
+{
+	return (size_t)(GENC_CXX_CAST(char*, item) - GENC_CXX_CAST(char*, table->buckets)) / table->desc.bucket_size;
+}
+
+static GENC_INLINE size_t ckht_main_buckets(genc_cuckoo_hash_table_t* table)
+{
+	return table->group_count * GENC_CKHT_WAYS;
+}
+
+static GENC_INLINE genc_hash_t ckht_item_hash(genc_cuckoo_hash_table_t* table, void* item)
+{
+	return table->desc.hash_fn(ckht_item_key(table, item), table->opaque);
+}
+
+/* The first group comes from the hash's low bits, as with the other tables.
+ * The second comes from the top bits of a multiplicative remix, so it is
+ * independent of the first even for weak client hashes. */
+static GENC_INLINE size_t ckht_group1(genc_cuckoo_hash_table_t* table, genc_hash_t hash)
+{
+	return hash & (table->group_count - 1u);
+}
+
+static GENC_INLINE size_t ckht_group2(genc_cuckoo_hash_table_t* table, genc_hash_t hash, size_t group1)
+{
+	int shift = genc_log2_size(table->group_count);
+	size_t group2;
+#if defined(__LP64__) || defined(_WIN64)
+	group2 = (size_t)(((uint64_t)hash * UINT64_C(0x9e3779b97f4a7c15)) >> (64 - shift));
+#else
+	group2 = (size_t)(((uint32_t)hash * UINT32_C(0x9e3779b9)) >> (32 - shift));
+#endif
+	return group2 != group1 ? group2 : group1 ^ 1u;
+}
+
+/* Returns the index of the first empty bucket in the group, or CKHT_NO_BUCKET. */
+static size_t ckht_group_find_empty(genc_cuckoo_hash_table_t* table, size_t group)
+{
+	size_t idx;
+	for (idx = group * GENC_CKHT_WAYS; idx < (group + 1u) * GENC_CKHT_WAYS; ++idx)
+	{
+		if (ckht_item_is_empty(table, ckht_bucket_at(table, idx)))
+			return idx;
+	}
+	return CKHT_NO_BUCKET;
+}
+
+static size_t ckht_group_find_key(genc_cuckoo_hash_table_t* table, size_t group, void* key)
+{
+	size_t idx;
+	for (idx = group * GENC_CKHT_WAYS; idx < (group + 1u) * GENC_CKHT_WAYS; ++idx)
+	{
+		void* item = ckht_bucket_at(table, idx);
+		if (!ckht_item_is_empty(table, item) && ckht_keys_equal(table, key, ckht_item_key(table, item)))
+			return idx;
+	}
+	return CKHT_NO_BUCKET;
+}
+
+/* Returns the bucket index of the item with the given key, or CKHT_NO_BUCKET if not found. */
+static size_t ckht_find_index(genc_cuckoo_hash_table_t* table, void* key, genc_hash_t hash)
+{
+	size_t group1 = ckht_group1(table, hash);
+	size_t group2 = ckht_group2(table, hash, group1);
+	size_t idx;
+	GENC_PREFETCH(ckht_bucket_at(table, group2 * GENC_CKHT_WAYS));
+	idx = ckht_group_find_key(table, group1, key);
+	if (idx != CKHT_NO_BUCKET)
+		return idx;
+	idx = ckht_group_find_key(table, group2, key);
+	if (idx != CKHT_NO_BUCKET || table->stash_count == 0)
+		return idx;
+	for (idx = ckht_main_buckets(table); idx < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++idx)
+	{
+		void* item = ckht_bucket_at(table, idx);
+		if (!ckht_item_is_empty(table, item) && ckht_keys_equal(table, key, ckht_item_key(table, item)))
+			return idx;
+	}
+	return CKHT_NO_BUCKET;
+}
+
+/* Returns whether the search path leading to queue entry node already passes
+ * through the group. Moving items along a path visiting a group twice could
+ * overwrite an item which has already been moved. */
+static genc_bool_t ckht_path_visits_group(genc_cuckoo_hash_table_t* table, size_t node, size_t group)
+{
+	for (; node != CKHT_NO_BUCKET; node = table->bfs_queue[node].parent)
+	{
+		if (table->bfs_queue[node].bucket / GENC_CKHT_WAYS == group)
+			return 1;
+	}
+	return 0;
+}
+
+/* Searches breadth-first for the shortest sequence of displacements which
+ * frees a bucket in one of the (full) groups, and performs it. Returns the
+ * freed bucket's index, or CKHT_NO_BUCKET if the search limit is reached. */
+static size_t ckht_make_room(genc_cuckoo_hash_table_t* table, size_t group1, size_t group2)
+{
+	struct genc_ckht_bfs_node* queue = table->bfs_queue;
+	size_t head = 0, tail = 0;
+	size_t i;
+	for (i = 0; i < GENC_CKHT_WAYS; ++i)
+	{
+		queue[tail].bucket = group1 * GENC_CKHT_WAYS + i;
+		queue[tail++].parent = CKHT_NO_BUCKET;
+		queue[tail].bucket = group2 * GENC_CKHT_WAYS + i;
+		queue[tail++].parent = CKHT_NO_BUCKET;
+	}
+
+	for (; head < tail; ++head)
+	{
+		size_t bucket = queue[head].bucket;
+		genc_hash_t hash = ckht_item_hash(table, ckht_bucket_at(table, bucket));
+		size_t alt = ckht_group1(table, hash);
+		size_t free_idx;
+		if (alt == bucket / GENC_CKHT_WAYS)
+			alt = ckht_group2(table, hash, alt);
+
+		free_idx = ckht_group_find_empty(table, alt);
+		if (free_idx != CKHT_NO_BUCKET)
+		{
+			/* shift the items along the path, starting at the free end */
+			size_t node = head;
+			while (node != CKHT_NO_BUCKET)
+			{
+				memcpy(ckht_bucket_at(table, free_idx), ckht_bucket_at(table, queue[node].bucket), table->desc.bucket_size);
+				free_idx = queue[node].bucket;
+				node = queue[node].parent;
+			}
+			return free_idx;
+		}
+
+		if (tail + GENC_CKHT_WAYS <= GENC_CKHT_BFS_MAX_NODES && !ckht_path_visits_group(table, head, alt))
+		{
+			for (i = 0; i < GENC_CKHT_WAYS; ++i)
+			{
+				queue[tail].bucket = alt * GENC_CKHT_WAYS + i;
+				queue[tail++].parent = head;
+			}
+		}
+	}
+	return CKHT_NO_BUCKET;
+}
+
+/* Places a copy of the (new) item in the table without growing it. Returns
+ * the bucket, or NULL if neither the item's groups nor the stash have room. */
+static void* ckht_place(genc_cuckoo_hash_table_t* table, void* item, genc_hash_t hash)
+{
+	size_t group1 = ckht_group1(table, hash);
+	size_t group2 = ckht_group2(table, hash, group1);
+	size_t idx = ckht_group_find_empty(table, group1);
+	if (idx == CKHT_NO_BUCKET)
+		idx = ckht_group_find_empty(table, group2);
+	if (idx == CKHT_NO_BUCKET)
+		idx = ckht_make_room(table, group1, group2);
+	if (idx == CKHT_NO_BUCKET)
+	{
+		if (table->stash_count == GENC_CKHT_STASH_SIZE)
+			return NULL;
+		for (idx = ckht_main_buckets(table); !ckht_item_is_empty(table, ckht_bucket_at(table, idx)); ++idx)
+			;
+		++table->stash_count;
+	}
+	memcpy(ckht_bucket_at(table, idx), item, table->desc.bucket_size);
+	++table->item_count;
+	return ckht_bucket_at(table, idx);
+}
+
+/* Allocates a bucket array (including the stash) for group_count groups and
+ * clears all buckets. */
+static void* ckht_alloc_buckets(genc_cuckoo_hash_table_t* table, size_t group_count)
+{
+	size_t bucket_count, i;
+	char* buckets;
+	if (group_count > (SIZE_MAX / table->desc.bucket_size - GENC_CKHT_STASH_SIZE) / GENC_CKHT_WAYS)
+		return NULL;
+	bucket_count = group_count * GENC_CKHT_WAYS + GENC_CKHT_STASH_SIZE;
+	buckets = GENC_CXX_CAST(char*, table->desc.realloc_fn(NULL, 0, bucket_count * table->desc.bucket_size, table->opaque));
+	if (!buckets)
+		return NULL;
+	for (i = 0; i < bucket_count; ++i)
+		ckht_item_clear(table, buckets + i * table->desc.bucket_size);
+	return buckets;
+}
+
+static void ckht_free_buckets(genc_cuckoo_hash_table_t* table, void* buckets, size_t group_count)
+{
+	table->desc.realloc_fn(
+		buckets, (group_count * GENC_CKHT_WAYS + GENC_CKHT_STASH_SIZE) * table->desc.bucket_size, 0, table->opaque);
+}
+
+/* Reinserts all items into a new bucket array with the given number of
+ * groups. Leaves the table unchanged on failure. */
+static genc_bool_t ckht_rebuild(genc_cuckoo_hash_table_t* table, size_t new_group_count)
+{
+	genc_cuckoo_hash_table_t new_table = *table;
+	size_t i;
+	new_table.buckets = ckht_alloc_buckets(table, new_group_count);
+	if (!new_table.buckets)
+		return 0;
+	new_table.group_count = new_group_count;
+	new_table.item_count = 0;
+	new_table.stash_count = 0;
+
+	for (i = 0; i < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++i)
+	{
+		void* item = ckht_bucket_at(table, i);
+		if (ckht_item_is_empty(table, item))
+			continue;
+		if (!ckht_place(&new_table, item, ckht_item_hash(table, item)))
+		{
+			ckht_free_buckets(table, new_table.buckets, new_group_count);
+			return 0;
+		}
+	}
+
+	ckht_free_buckets(table, table->buckets, table->group_count);
+	*table = new_table;
+	return 1;
+}
+
+genc_bool_t genc_cuckoo_hash_table_init(
+	genc_cuckoo_hash_table_t* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	size_t initial_capacity_pow2)
+{
+	size_t group_count = 2;
+	if (desc->bucket_size == 0)
+		return 0;
+	/* Cuckoo placement has no use for stored hashes or Robin Hood ordering,
+	 * and the table has no seed, so refuse descriptors relying on them rather
+	 * than silently ignoring them. */
+	if (desc->flags != 0 || desc->seeded_hash_fn || !desc->hash_fn)
+		return 0;
+	while (group_count * GENC_CKHT_WAYS < initial_capacity_pow2)
+	{
+		if (group_count > SIZE_MAX / 2 / GENC_CKHT_WAYS)
+			return 0;
+		group_count *= 2;
+	}
+
+	table->desc = *desc;
+	table->opaque = opaque;
+	table->item_count = 0;
+	table->stash_count = 0;
+	table->bfs_queue = GENC_CXX_CAST(struct genc_ckht_bfs_node*, desc->realloc_fn(
+		NULL, 0, sizeof(struct genc_ckht_bfs_node) * GENC_CKHT_BFS_MAX_NODES, opaque));
+	if (!table->bfs_queue)
+		return 0;
+	table->buckets = ckht_alloc_buckets(table, group_count);
+	if (!table->buckets)
+	{
+		desc->realloc_fn(table->bfs_queue, sizeof(struct genc_ckht_bfs_node) * GENC_CKHT_BFS_MAX_NODES, 0, opaque);
+		table->bfs_queue = NULL;
+		return 0;
+	}
+	table->group_count = group_count;
+	return 1;
+}
+
+size_t genc_ckht_count(genc_cuckoo_hash_table_t* table)
+{
+	return table->item_count;
+}
+
+size_t genc_ckht_capacity(genc_cuckoo_hash_table_t* table)
+{
+	return ckht_main_buckets(table);
+}
+
+void genc_ckht_destroy(genc_cuckoo_hash_table_t* table)
+{
+	if (table->buckets)
+		ckht_free_buckets(table, table->buckets, table->group_count);
+	if (table->bfs_queue)
+		table->desc.realloc_fn(
+			table->bfs_queue, sizeof(struct genc_ckht_bfs_node) * GENC_CKHT_BFS_MAX_NODES, 0, table->opaque);
+	table->buckets = NULL;
+	table->bfs_queue = NULL;
+	table->group_count = 0;
+	table->item_count = 0;
+	table->stash_count = 0;
+}
+
+/* Places the item, growing the table as long as it is at least half full.
+ * Failing to place an item in an emptier table means the hash maps too many
+ * keys to the same groups, which growing won't fix. */
+static void* ckht_insert_new(genc_cuckoo_hash_table_t* table, void* item, genc_hash_t hash)
+{
+	void* bucket;
+	while (!(bucket = ckht_place(table, item, hash)))
+	{
+		if (table->item_count < ckht_main_buckets(table) / 2u || table->group_count > SIZE_MAX / 2u)
+			return NULL;
+		if (!ckht_rebuild(table, table->group_count * 2u))
+			return NULL;
+	}
+	return bucket;
+}
+
+void* genc_ckht_insert_item(genc_cuckoo_hash_table_t* table, void* item)
+{
+	void* key;
+	genc_hash_t hash;
+	if (!item)
+		return NULL;
+	key = ckht_item_key(table, item);
+	hash = table->desc.hash_fn(key, table->opaque);
+	if (ckht_find_index(table, key, hash) != CKHT_NO_BUCKET)
+		return NULL;
+	return ckht_insert_new(table, item, hash);
+}
+
+void* genc_ckht_insert_or_update_item(genc_cuckoo_hash_table_t* table, void* item)
+{
+	void* key;
+	genc_hash_t hash;
+	size_t idx;
+	if (!item)
+		return NULL;
+	key = ckht_item_key(table, item);
+	hash = table->desc.hash_fn(key, table->opaque);
+	idx = ckht_find_index(table, key, hash);
+	if (idx != CKHT_NO_BUCKET)
+	{
+		void* bucket = ckht_bucket_at(table, idx);
+		memcpy(bucket, item, table->desc.bucket_size);
+		return bucket;
+	}
+	return ckht_insert_new(table, item, hash);
+}
+
+void* genc_ckht_find(genc_cuckoo_hash_table_t* table, void* key)
+{
+	genc_hash_t hash = table->desc.hash_fn(key, table->opaque);
+	size_t idx = ckht_find_index(table, key, hash);
+	if (idx == CKHT_NO_BUCKET)
+		return NULL;
+	return ckht_bucket_at(table, idx);
+}
+
+/* Moves stashed items back into the main table where their groups have room,
+ * so lookups can skip the stash again as soon as possible. */
+static void ckht_drain_stash(genc_cuckoo_hash_table_t* table)
+{
+	size_t idx;
+	for (idx = ckht_main_buckets(table); idx < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++idx)
+	{
+		void* item = ckht_bucket_at(table, idx);
+		genc_hash_t hash;
+		size_t group1, free_idx;
+		if (ckht_item_is_empty(table, item))
+			continue;
+		hash = ckht_item_hash(table, item);
+		group1 = ckht_group1(table, hash);
+		free_idx = ckht_group_find_empty(table, group1);
+		if (free_idx == CKHT_NO_BUCKET)
+			free_idx = ckht_group_find_empty(table, ckht_group2(table, hash, group1));
+		if (free_idx == CKHT_NO_BUCKET)
+			continue;
+		memcpy(ckht_bucket_at(table, free_idx), item, table->desc.bucket_size);
+		ckht_item_clear(table, item);
+		--table->stash_count;
+	}
+}
+
+void genc_ckht_remove(genc_cuckoo_hash_table_t* table, void* item)
+{
+	size_t idx = ckht_bucket_index(table, item);
+	ckht_item_clear(table, item);
+	--table->item_count;
+	if (idx >= ckht_main_buckets(table))
+		--table->stash_count;
+	else if (table->stash_count > 0)
+		ckht_drain_stash(table);
+}
+
+genc_bool_t genc_ckht_reserve_space(genc_cuckoo_hash_table_t* table, size_t target_count)
+{
+	size_t group_count = table->group_count;
+	while (group_count * GENC_CKHT_WAYS / 10u * 9u < target_count)
+	{
+		if (group_count > SIZE_MAX / 2 / GENC_CKHT_WAYS)
+			return 0;
+		group_count *= 2;
+	}
+	if (group_count == table->group_count)
+		return 1;
+	return ckht_rebuild(table, group_count);
+}
+
+genc_bool_t genc_ckht_verify(genc_cuckoo_hash_table_t* table)
+{
+	size_t i;
+	size_t items = 0, stashed = 0;
+	for (i = 0; i < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++i)
+	{
+		void* item = ckht_bucket_at(table, i);
+		void* key;
+		genc_hash_t hash;
+		size_t group1;
+		if (ckht_item_is_empty(table, item))
+			continue;
+		++items;
+		key = ckht_item_key(table, item);
+		hash = table->desc.hash_fn(key, table->opaque);
+		group1 = ckht_group1(table, hash);
+		if (i >= ckht_main_buckets(table))
+			++stashed;
+		else if (i / GENC_CKHT_WAYS != group1 && i / GENC_CKHT_WAYS != ckht_group2(table, hash, group1))
+			return 0;
+		if (ckht_find_index(table, key, hash) != i)
+			return 0;
+	}
+	return items == table->item_count && stashed == table->stash_count;
+}
+
+static void* ckht_first_item_from(genc_cuckoo_hash_table_t* table, size_t idx)
+{
+	for (; idx < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++idx)
+	{
+		void* item = ckht_bucket_at(table, idx);
+		if (!ckht_item_is_empty(table, item))
+			return item;
+	}
+	return NULL;
+}
+
+void* genc_ckht_first_item(genc_cuckoo_hash_table_t* table)
+{
+	return ckht_first_item_from(table, 0);
+}
+
+void* genc_ckht_next_item(genc_cuckoo_hash_table_t* table, void* cur_item)
+{
+	return ckht_first_item_from(table, ckht_bucket_index(table, cur_item) + 1u);
+}
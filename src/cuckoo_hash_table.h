@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * A bucketised cuckoo hash table: every key has two candidate groups of
+ * GENC_CKHT_WAYS buckets, and lives in one of them or in a small stash, so a
+ * lookup inspects at most 2 * GENC_CKHT_WAYS + GENC_CKHT_STASH_SIZE buckets,
+ * however full the table or unlucky the keys. This suits latency-critical
+ * lookups better than the linear probing table, whose probe sequences are
+ * unbounded.
+ *
+ * Insertion does the work instead: if both groups are full, a breadth-first
+ * search over the items' alternative groups finds the shortest chain of
+ * displacements ending in a free bucket, and the items along it are shifted
+ * along by one. Only if no such chain of at most GENC_CKHT_BFS_MAX_NODES
+ * buckets exists does the item go into the stash, and only if the stash is
+ * full too does the table grow. Tables therefore typically fill to over 95%
+ * before growing.
+ *
+ * The table uses the linear probing table's descriptor for its client
+ * callbacks and bucket layout (including inline keys), but ignores its load
+ * factor thresholds and incremental resizing. Flags and seeded hashing aren't
+ * supported, and descriptors using them are rejected. As with Robin
+ * Hood tables, insertions may move other items, so pointers to items are only
+ * valid until the next insertion.
+ */
+
+#ifndef GENCCONT_CUCKOO_HASH_TABLE_H
+#define GENCCONT_CUCKOO_HASH_TABLE_H
+
+#include "linear_probing_hash_table.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Buckets per group */
+#define GENC_CKHT_WAYS 4
+/* Buckets in the overflow stash */
+#define GENC_CKHT_STASH_SIZE 4
+/* Limit on the number of buckets visited by an insertion's displacement search */
+#define GENC_CKHT_BFS_MAX_NODES 256
+
+struct genc_ckht_bfs_node;
+
+struct genc_cuckoo_hash_table
+{
+	genc_linear_probing_hash_table_desc_t desc;
+	void* opaque;
+	/* Number of groups of GENC_CKHT_WAYS buckets, a power of 2 (at least 2) */
+	size_t group_count;
+	/* Number of filled buckets, including the stash */
+	size_t item_count;
+	/* Number of filled stash buckets */
+	size_t stash_count;
+	/* group_count * GENC_CKHT_WAYS buckets followed by the stash */
+	void* buckets;
+	/* Queue for the displacement search, allocated along with the table */
+	struct genc_ckht_bfs_node* bfs_queue;
+};
+typedef struct genc_cuckoo_hash_table genc_cuckoo_hash_table_t;
+
+/* Initialises the empty hash table, copying the descriptor. The capacity is
+ * rounded up to a power of 2, and to at least 2 * GENC_CKHT_WAYS. Fails if the
+ * descriptor has no hash_fn, or sets any flags or seeded_hash_fn. */
+genc_bool_t genc_cuckoo_hash_table_init(
+	genc_cuckoo_hash_table_t* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	size_t initial_capacity_pow2);
+
+/* Returns the current number of items in the hash table. */
+size_t genc_ckht_count(genc_cuckoo_hash_table_t* table);
+
+/* Returns the number of buckets allocated, not counting the stash. */
+size_t genc_ckht_capacity(genc_cuckoo_hash_table_t* table);
+
+/* Drops all items from the table and deallocates the bucket memory. */
+void genc_ckht_destroy(genc_cuckoo_hash_table_t* table);
+
+/* Inserts a copy of the given item into the hash table.
+ * Returns NULL to report failure due to a NULL item, a duplicate or growth
+ * failure, pointer to inserted bucket on success. Other items may be moved. */
+void* genc_ckht_insert_item(genc_cuckoo_hash_table_t* table, void* item);
+/* As genc_ckht_insert_item, but overwrites any existing item with the same key. */
+void* genc_ckht_insert_or_update_item(genc_cuckoo_hash_table_t* table, void* item);
+
+/* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
+void* genc_ckht_find(genc_cuckoo_hash_table_t* table, void* key);
+
+/* Removes the item from the hash table. item must point to the location of the
+ * value within the table - i.e. returned by genc_ckht_find or genc_ckht_insert_item */
+void genc_ckht_remove(genc_cuckoo_hash_table_t* table, void* item);
+
+/* Resizes the table, if necessary, so that target_count items fit at a load
+ * factor of at most 90%. */
+genc_bool_t genc_ckht_reserve_space(genc_cuckoo_hash_table_t* table, size_t target_count);
+
+/* Walks all the elements in the hash table and checks they can be found. */
+genc_bool_t genc_ckht_verify(genc_cuckoo_hash_table_t* table);
+
+/* Iterating over all the items in the table (including the stash): */
+
+/* First non-empty bucket. */
+void* genc_ckht_first_item(genc_cuckoo_hash_table_t* table);
+/* Next non-empty bucket */
+void* genc_ckht_next_item(genc_cuckoo_hash_table_t* table, void* cur_item);
+
+#define genc_ckht_first_obj(table, type) \
+GENC_CXX_CAST(type*, genc_ckht_first_item(table))
+
+#define genc_ckht_next_obj(table, cur_obj, type) \
+GENC_CXX_CAST(type*, genc_ckht_next_item(table, GENC_CXX_CAST(type*, cur_obj)))
+
+#define genc_ckht_find_obj(table, key, type) \
+GENC_CXX_CAST(type*, genc_ckht_find(table, key))
+
+#define genc_ckht_insert_obj(table, new_obj, type) \
+GENC_CXX_CAST(type*, genc_ckht_insert_item(table, GENC_CXX_CAST(type*, new_obj)))
+
+#define genc_ckht_for_each_obj(type, obj_var, table) \
+for (type* obj_var = genc_ckht_first_obj(table, type); obj_var != NULL; obj_var = genc_ckht_next_obj(table, obj_var, type))
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
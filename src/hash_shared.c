@@ -22,6 +22,9 @@ freely, subject to the following restrictions:
 */
 
 #include "hash_shared.h"
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
 
 /* integer hashes described in http://www.cris.com/~Ttwang/tech/inthash.htm */
 size_t genc_hash_uint32(uint32_t key)
@@ -93,3 +96,598 @@ size_t genc_hash_combine(size_t seed, size_t hash_value)
 	seed ^= hash_value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 	return seed;
 }
+
+
+/* wyhash by Wang Yi (public domain, https://github.com/wangyi-fudan/wyhash) */
+
+static const uint64_t genc_wyhash_secret[4] =
+{
+	0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+/* 64x64 -> 128 bit multiply, low half to *a, high half to *b */
+static GENC_INLINE void genc_wyhash_mum(uint64_t* a, uint64_t* b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = *a;
+	r *= *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), carry = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static GENC_INLINE uint64_t genc_wyhash_mix(uint64_t a, uint64_t b)
+{
+	genc_wyhash_mum(&a, &b);
+	return a ^ b;
+}
+
+static GENC_INLINE uint64_t genc_wyhash_read8(const uint8_t* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static GENC_INLINE uint64_t genc_wyhash_read4(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static GENC_INLINE uint64_t genc_wyhash_init_seed(uint64_t seed)
+{
+	return seed ^ genc_wyhash_mix(seed ^ genc_wyhash_secret[0], genc_wyhash_secret[1]);
+}
+
+/* Consumes one 48 byte block */
+static GENC_INLINE void genc_wyhash_block(const uint8_t* p, uint64_t* seed, uint64_t* see1, uint64_t* see2)
+{
+	*seed = genc_wyhash_mix(genc_wyhash_read8(p) ^ genc_wyhash_secret[1], genc_wyhash_read8(p + 8) ^ *seed);
+	*see1 = genc_wyhash_mix(genc_wyhash_read8(p + 16) ^ genc_wyhash_secret[2], genc_wyhash_read8(p + 24) ^ *see1);
+	*see2 = genc_wyhash_mix(genc_wyhash_read8(p + 32) ^ genc_wyhash_secret[3], genc_wyhash_read8(p + 40) ^ *see2);
+}
+
+/* Hashes the remaining 0-48 bytes at p. If len > 16, the 16 bytes before p
+ * must be readable (they're the end of the previous block). */
+static uint64_t genc_wyhash_finish(uint64_t seed, const uint8_t* p, size_t remaining, uint64_t len)
+{
+	uint64_t a, b;
+	if (len <= 16)
+	{
+		if (len >= 4)
+		{
+			a = (genc_wyhash_read4(p) << 32) | genc_wyhash_read4(p + ((len >> 3) << 2));
+			b = (genc_wyhash_read4(p + len - 4) << 32) | genc_wyhash_read4(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if (len > 0)
+		{
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else
+	{
+		while (remaining > 16)
+		{
+			seed = genc_wyhash_mix(genc_wyhash_read8(p) ^ genc_wyhash_secret[1], genc_wyhash_read8(p + 8) ^ seed);
+			p += 16;
+			remaining -= 16;
+		}
+		a = genc_wyhash_read8(p + remaining - 16);
+		b = genc_wyhash_read8(p + remaining - 8);
+	}
+	a ^= genc_wyhash_secret[1];
+	b ^= seed;
+	genc_wyhash_mum(&a, &b);
+	return genc_wyhash_mix(a ^ genc_wyhash_secret[0] ^ len, b ^ genc_wyhash_secret[1]);
+}
+
+size_t genc_hash_bytes(const void* data, size_t len, uint64_t seed)
+{
+	const uint8_t* p = GENC_CXX_CAST(const uint8_t*, data);
+	size_t remaining = len;
+	seed = genc_wyhash_init_seed(seed);
+	if (remaining > 48)
+	{
+		uint64_t see1 = seed, see2 = seed;
+		do
+		{
+			genc_wyhash_block(p, &seed, &see1, &see2);
+			p += 48;
+			remaining -= 48;
+		} while (remaining > 48);
+		seed ^= see1 ^ see2;
+	}
+	return (size_t)genc_wyhash_finish(seed, p, remaining, len);
+}
+
+void genc_hash_bytes_init(genc_hash_bytes_state_t* state, uint64_t seed)
+{
+	state->seed = state->see1 = state->see2 = genc_wyhash_init_seed(seed);
+	state->len = 0;
+	state->pending = 0;
+}
+
+void genc_hash_bytes_update(genc_hash_bytes_state_t* state, const void* data, size_t len)
+{
+	const uint8_t* p = GENC_CXX_CAST(const uint8_t*, data);
+	state->len += len;
+	while (len > 0)
+	{
+		size_t n;
+		/* A full block is only consumed once we know more data follows, as the
+		 * last 1-48 bytes are treated differently. */
+		if (state->pending == 48)
+		{
+			genc_wyhash_block(state->buffer + 16, &state->seed, &state->see1, &state->see2);
+			memcpy(state->buffer, state->buffer + 48, 16);
+			state->pending = 0;
+		}
+		n = 48 - state->pending;
+		if (n > len)
+			n = len;
+		memcpy(state->buffer + 16 + state->pending, p, n);
+		state->pending += n;
+		p += n;
+		len -= n;
+	}
+}
+
+size_t genc_hash_bytes_final(const genc_hash_bytes_state_t* state)
+{
+	uint64_t seed = state->seed;
+	/* more than 48 bytes means at least one block was consumed */
+	if (state->len > 48)
+		seed ^= state->see1 ^ state->see2;
+	return (size_t)genc_wyhash_finish(seed, state->buffer + 16, state->pending, state->len);
+}
+
+size_t genc_lstring_key_hash(void* key, void* opaque_unused GENC_UNUSED)
+{
+	const genc_lstring_t* s = GENC_CXX_CAST(const genc_lstring_t*, key);
+	return genc_hash_bytes(s->str, s->length, 0);
+}
+
+genc_bool_t genc_lstring_keys_equal(void* key1, void* key2, void* opaque_unused GENC_UNUSED)
+{
+	const genc_lstring_t* s1 = GENC_CXX_CAST(const genc_lstring_t*, key1);
+	const genc_lstring_t* s2 = GENC_CXX_CAST(const genc_lstring_t*, key2);
+	return s1->length == s2->length && 0 == memcmp(s1->str, s2->str, s1->length);
+}
+
+size_t genc_cstring_key_hash(void* key, void* opaque_unused GENC_UNUSED)
+{
+	const char* s = GENC_CXX_CAST(const char*, key);
+	return genc_hash_bytes(s, strlen(s), 0);
+}
+
+genc_bool_t genc_cstring_keys_equal(void* key1, void* key2, void* opaque_unused GENC_UNUSED)
+{
+	return 0 == strcmp(GENC_CXX_CAST(const char*, key1), GENC_CXX_CAST(const char*, key2));
+}
+
+size_t genc_lstring_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused GENC_UNUSED)
+{
+	const genc_lstring_t* s = GENC_CXX_CAST(const genc_lstring_t*, key);
+	return genc_hash_bytes(s->str, s->length, seed);
+}
+
+size_t genc_cstring_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused GENC_UNUSED)
+{
+	const char* s = GENC_CXX_CAST(const char*, key);
+	return genc_hash_bytes(s, strlen(s), seed);
+}
+
+
+/* Seeded integer hashes: two wyhash multiply-mix rounds, keyed by the seed.
+ * A single round leaves the low bits poorly mixed for some seeds, which shows
+ * up as long chains for runs of consecutive keys. */
+
+size_t genc_hash_uint64_seeded(uint64_t k, uint64_t seed)
+{
+	uint64_t h = genc_wyhash_mix(k ^ genc_wyhash_secret[0], seed ^ genc_wyhash_secret[1]);
+	return (size_t)genc_wyhash_mix(h ^ genc_wyhash_secret[2], k ^ genc_wyhash_secret[3]);
+}
+
+uint64_t genc_hash_next_seed(uint64_t seed)
+{
+	return genc_wyhash_mix(seed ^ genc_wyhash_secret[2], genc_wyhash_secret[3]);
+}
+
+size_t genc_uint32_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused GENC_UNUSED)
+{
+	return genc_hash_uint64_seeded(*(uint32_t*)key, seed);
+}
+
+size_t genc_uint64_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused GENC_UNUSED)
+{
+	return genc_hash_uint64_seeded(*(uint64_t*)key, seed);
+}
+
+size_t genc_pointer_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused GENC_UNUSED)
+{
+	return genc_hash_uint64_seeded((uintptr_t)key, seed);
+}
+
+
+/* Hardware-accelerated fixed width key hashes */
+
+#if !defined(GENC_HASH_NO_HW) && !defined(KERNEL) && !defined(__KERNEL__) && defined(__GNUC__) \
+	&& (defined(__x86_64__) || defined(__i386__))
+#define GENC_HASH_X86_HW 1
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#elif !defined(GENC_HASH_NO_HW) && defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define GENC_HASH_ARM_CRC 1
+#include <arm_acle.h>
+#endif
+
+/* Seeds and round keys; arbitrary odd constants */
+#define GENC_CRC_SEED1 0x9e3779b9u
+#define GENC_CRC_SEED2 0x7f4a7c15u
+static const uint64_t genc_aes_hash_keys[3][2] =
+{
+	{ 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull },
+	{ 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull },
+	{ 0x9e3779b97f4a7c15ull, 0xbf58476d1ce4e5b9ull }
+};
+
+/* CRC32C (Castagnoli, reflected polynomial 0x82f63b78) byte table */
+static const uint32_t genc_crc32c_table[256] =
+{
+	0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c, 0x26a1e7e8, 0xd4ca64eb,
+	0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b, 0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24,
+	0x105ec76f, 0xe235446c, 0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+	0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc, 0xbc267848, 0x4e4dfb4b,
+	0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a, 0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35,
+	0xaa64d611, 0x580f5512, 0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+	0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad, 0x1642ae59, 0xe4292d5a,
+	0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a, 0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595,
+	0x417b1dbc, 0xb3109ebf, 0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+	0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f, 0xed03a29b, 0x1f682198,
+	0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927, 0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38,
+	0xdbfc821c, 0x2997011f, 0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+	0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e, 0x4767748a, 0xb50cf789,
+	0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859, 0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46,
+	0x7198540d, 0x83f3d70e, 0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+	0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de, 0xdde0eb2a, 0x2f8b6829,
+	0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c, 0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93,
+	0x082f63b7, 0xfa44e0b4, 0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+	0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b, 0xb4091bff, 0x466298fc,
+	0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c, 0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033,
+	0xa24bb5a6, 0x502036a5, 0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+	0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975, 0x0e330a81, 0xfc588982,
+	0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d, 0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622,
+	0x38cc2a06, 0xcaa7a905, 0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+	0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8, 0xe52cc12c, 0x1747422f,
+	0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff, 0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0,
+	0xd3d3e1ab, 0x21b862a8, 0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+	0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78, 0x7fab5e8c, 0x8dc0dd8f,
+	0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee, 0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1,
+	0x69e9f0d5, 0x9b8273d6, 0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+	0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69, 0xd5cf889d, 0x27a40b9e,
+	0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e, 0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+
+static const uint8_t genc_aes_sbox[256] =
+{
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+/* Software CRC32C step without pre/post inversion, matching the crc32
+ * instruction; bytes are consumed least significant first. */
+static uint32_t genc_crc32c_u32_sw(uint32_t crc, uint32_t v)
+{
+	int i;
+	for (i = 0; i < 4; ++i, v >>= 8)
+		crc = genc_crc32c_table[(crc ^ v) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+static uint32_t genc_crc32c_u64_sw(uint32_t crc, uint64_t v)
+{
+	crc = genc_crc32c_u32_sw(crc, (uint32_t)v);
+	return genc_crc32c_u32_sw(crc, (uint32_t)(v >> 32));
+}
+
+static GENC_INLINE uint8_t genc_aes_xtime(uint8_t b)
+{
+	return (uint8_t)((b << 1) ^ ((b & 0x80) ? 0x1b : 0));
+}
+
+/* One AES encryption round (SubBytes, ShiftRows, MixColumns, AddRoundKey) on
+ * the column-major state, same as the aesenc instruction. */
+static void genc_aes_round_sw(uint8_t s[16], const uint8_t key[16])
+{
+	uint8_t t[16];
+	int r, c;
+	for (c = 0; c < 4; ++c)
+		for (r = 0; r < 4; ++r)
+			t[r + 4 * c] = genc_aes_sbox[s[r + 4 * ((c + r) & 3)]];
+	for (c = 0; c < 4; ++c)
+	{
+		uint8_t a0 = t[4 * c], a1 = t[4 * c + 1], a2 = t[4 * c + 2], a3 = t[4 * c + 3];
+		uint8_t x0 = genc_aes_xtime(a0), x1 = genc_aes_xtime(a1), x2 = genc_aes_xtime(a2), x3 = genc_aes_xtime(a3);
+		s[4 * c]     = x0 ^ x1 ^ a1 ^ a2 ^ a3 ^ key[4 * c];
+		s[4 * c + 1] = a0 ^ x1 ^ x2 ^ a2 ^ a3 ^ key[4 * c + 1];
+		s[4 * c + 2] = a0 ^ a1 ^ x2 ^ x3 ^ a3 ^ key[4 * c + 2];
+		s[4 * c + 3] = x0 ^ a0 ^ a1 ^ a2 ^ x3 ^ key[4 * c + 3];
+	}
+}
+
+static GENC_INLINE void genc_aes_store_le(uint8_t out[16], uint64_t lo, uint64_t hi)
+{
+	int i;
+	for (i = 0; i < 8; ++i)
+	{
+		out[i] = (uint8_t)(lo >> (8 * i));
+		out[8 + i] = (uint8_t)(hi >> (8 * i));
+	}
+}
+
+static uint64_t genc_hash_uint128_sw(uint64_t lo, uint64_t hi)
+{
+	uint8_t s[16], key[16];
+	uint64_t out_lo = 0, out_hi = 0;
+	int i;
+	genc_aes_store_le(s, lo ^ genc_aes_hash_keys[0][0], hi ^ genc_aes_hash_keys[0][1]);
+	for (i = 1; i < 3; ++i)
+	{
+		genc_aes_store_le(key, genc_aes_hash_keys[i][0], genc_aes_hash_keys[i][1]);
+		genc_aes_round_sw(s, key);
+	}
+	for (i = 7; i >= 0; --i)
+	{
+		out_lo = (out_lo << 8) | s[i];
+		out_hi = (out_hi << 8) | s[8 + i];
+	}
+	return out_lo ^ out_hi;
+}
+
+genc_bool_t genc_hash_hw_crc32c_available(void)
+{
+#if defined(GENC_HASH_X86_HW)
+	return __builtin_cpu_supports("sse4.2") != 0;
+#elif defined(GENC_HASH_ARM_CRC)
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+genc_bool_t genc_hash_hw_aes_available(void)
+{
+#if defined(GENC_HASH_X86_HW)
+	return __builtin_cpu_supports("aes") != 0;
+#else
+	return 0;
+#endif
+}
+
+/* The hashes in terms of the software CRC32C and AES round. */
+static GENC_INLINE size_t genc_hash_uint32_crc_sw(uint32_t k)
+{
+	/* a bijection on 32 bit values */
+	return genc_crc32c_u32_sw(GENC_CRC_SEED1, k);
+}
+
+static GENC_INLINE size_t genc_hash_uint64_crc_sw(uint64_t k)
+{
+	size_t h = genc_crc32c_u64_sw(GENC_CRC_SEED1, k);
+#if defined(__LP64__) || defined(_WIN64)
+	/* CRC is linear, so the same key under a different seed would only
+	 * differ by a constant; the rotated key gives independent upper bits */
+	h |= (size_t)genc_crc32c_u64_sw(GENC_CRC_SEED2, (k << 32) | (k >> 32)) << 32;
+#endif
+	return h;
+}
+
+/* The same using the instructions. On x86, these are compiled for the
+ * instruction set extension even if the rest of the file isn't; unless the
+ * whole build targets it, they're only called once the CPU is known to
+ * support it. */
+#if defined(GENC_HASH_X86_HW)
+#if !defined(__SSE4_2__)
+__attribute__((target("sse4.2")))
+#endif
+static GENC_INLINE size_t genc_hash_uint32_crc_hw(uint32_t k)
+{
+	return _mm_crc32_u32(GENC_CRC_SEED1, k);
+}
+
+#if !defined(__SSE4_2__)
+__attribute__((target("sse4.2")))
+#endif
+static GENC_INLINE size_t genc_hash_uint64_crc_hw(uint64_t k)
+{
+#ifdef __x86_64__
+	size_t h = (uint32_t)_mm_crc32_u64(GENC_CRC_SEED1, k);
+	h |= (size_t)(uint32_t)_mm_crc32_u64(GENC_CRC_SEED2, (k << 32) | (k >> 32)) << 32;
+	return h;
+#else
+	return _mm_crc32_u32(_mm_crc32_u32(GENC_CRC_SEED1, (uint32_t)k), (uint32_t)(k >> 32));
+#endif
+}
+
+#if !defined(__AES__)
+__attribute__((target("sse2,aes")))
+#endif
+static GENC_INLINE size_t genc_hash_uint128_hw(uint64_t lo, uint64_t hi)
+{
+	uint64_t out[2];
+	__m128i x = _mm_set_epi64x((long long)hi, (long long)lo);
+	x = _mm_xor_si128(x, _mm_set_epi64x((long long)genc_aes_hash_keys[0][1], (long long)genc_aes_hash_keys[0][0]));
+	x = _mm_aesenc_si128(x, _mm_set_epi64x((long long)genc_aes_hash_keys[1][1], (long long)genc_aes_hash_keys[1][0]));
+	x = _mm_aesenc_si128(x, _mm_set_epi64x((long long)genc_aes_hash_keys[2][1], (long long)genc_aes_hash_keys[2][0]));
+	_mm_storeu_si128((__m128i*)out, x);
+	return (size_t)(out[0] ^ out[1]);
+}
+#elif defined(GENC_HASH_ARM_CRC)
+static GENC_INLINE size_t genc_hash_uint32_crc_hw(uint32_t k)
+{
+	return __crc32cw(GENC_CRC_SEED1, k);
+}
+
+static GENC_INLINE size_t genc_hash_uint64_crc_hw(uint64_t k)
+{
+	size_t h = __crc32cd(GENC_CRC_SEED1, k);
+	h |= (size_t)__crc32cd(GENC_CRC_SEED2, (k << 32) | (k >> 32)) << 32;
+	return h;
+}
+#endif
+
+/* Picks the implementation. Where the build doesn't already guarantee the
+ * instructions, the CPU is checked once, on first use, and each hash then
+ * costs one indirect call. (Racing first calls store the same pointer.) */
+#if defined(GENC_HASH_X86_HW) && !defined(__SSE4_2__)
+static size_t genc_hash_uint32_crc_resolve(uint32_t k);
+static size_t genc_hash_uint64_crc_resolve(uint64_t k);
+static size_t(*genc_hash_uint32_crc_impl)(uint32_t k) = genc_hash_uint32_crc_resolve;
+static size_t(*genc_hash_uint64_crc_impl)(uint64_t k) = genc_hash_uint64_crc_resolve;
+
+__attribute__((target("sse4.2")))
+static size_t genc_hash_uint32_crc_hw_call(uint32_t k)
+{
+	return genc_hash_uint32_crc_hw(k);
+}
+
+__attribute__((target("sse4.2")))
+static size_t genc_hash_uint64_crc_hw_call(uint64_t k)
+{
+	return genc_hash_uint64_crc_hw(k);
+}
+
+static size_t genc_hash_uint32_crc_resolve(uint32_t k)
+{
+	size_t(*impl)(uint32_t k) = genc_hash_hw_crc32c_available() ? genc_hash_uint32_crc_hw_call : genc_hash_uint32_crc_sw;
+	__atomic_store_n(&genc_hash_uint32_crc_impl, impl, __ATOMIC_RELAXED);
+	return impl(k);
+}
+
+static size_t genc_hash_uint64_crc_resolve(uint64_t k)
+{
+	size_t(*impl)(uint64_t k) = genc_hash_hw_crc32c_available() ? genc_hash_uint64_crc_hw_call : genc_hash_uint64_crc_sw;
+	__atomic_store_n(&genc_hash_uint64_crc_impl, impl, __ATOMIC_RELAXED);
+	return impl(k);
+}
+
+size_t genc_hash_uint32_crc(uint32_t k)
+{
+	return __atomic_load_n(&genc_hash_uint32_crc_impl, __ATOMIC_RELAXED)(k);
+}
+
+size_t genc_hash_uint64_crc(uint64_t k)
+{
+	return __atomic_load_n(&genc_hash_uint64_crc_impl, __ATOMIC_RELAXED)(k);
+}
+#elif defined(GENC_HASH_X86_HW) || defined(GENC_HASH_ARM_CRC)
+size_t genc_hash_uint32_crc(uint32_t k)
+{
+	return genc_hash_uint32_crc_hw(k);
+}
+
+size_t genc_hash_uint64_crc(uint64_t k)
+{
+	return genc_hash_uint64_crc_hw(k);
+}
+#else
+size_t genc_hash_uint32_crc(uint32_t k)
+{
+	return genc_hash_uint32_crc_sw(k);
+}
+
+size_t genc_hash_uint64_crc(uint64_t k)
+{
+	return genc_hash_uint64_crc_sw(k);
+}
+#endif
+
+static GENC_INLINE size_t genc_hash_uint128_sw_call(uint64_t lo, uint64_t hi)
+{
+	return (size_t)genc_hash_uint128_sw(lo, hi);
+}
+
+#if defined(GENC_HASH_X86_HW) && !defined(__AES__)
+static size_t genc_hash_uint128_resolve(uint64_t lo, uint64_t hi);
+static size_t(*genc_hash_uint128_impl)(uint64_t lo, uint64_t hi) = genc_hash_uint128_resolve;
+
+__attribute__((target("sse2,aes")))
+static size_t genc_hash_uint128_hw_call(uint64_t lo, uint64_t hi)
+{
+	return genc_hash_uint128_hw(lo, hi);
+}
+
+static size_t genc_hash_uint128_resolve(uint64_t lo, uint64_t hi)
+{
+	size_t(*impl)(uint64_t lo, uint64_t hi) = genc_hash_hw_aes_available() ? genc_hash_uint128_hw_call : genc_hash_uint128_sw_call;
+	__atomic_store_n(&genc_hash_uint128_impl, impl, __ATOMIC_RELAXED);
+	return impl(lo, hi);
+}
+
+size_t genc_hash_uint128(uint64_t lo, uint64_t hi)
+{
+	return __atomic_load_n(&genc_hash_uint128_impl, __ATOMIC_RELAXED)(lo, hi);
+}
+#elif defined(GENC_HASH_X86_HW)
+size_t genc_hash_uint128(uint64_t lo, uint64_t hi)
+{
+	return genc_hash_uint128_hw(lo, hi);
+}
+#else
+size_t genc_hash_uint128(uint64_t lo, uint64_t hi)
+{
+	return genc_hash_uint128_sw_call(lo, hi);
+}
+#endif
+
+size_t genc_uint32_key_hash_crc(void* key, void* opaque_unused GENC_UNUSED)
+{
+	return genc_hash_uint32_crc(*(uint32_t*)key);
+}
+
+size_t genc_uint64_key_hash_crc(void* key, void* opaque_unused GENC_UNUSED)
+{
+	return genc_hash_uint64_crc(*(uint64_t*)key);
+}
+
+size_t genc_uint128_key_hash(void* key, void* opaque_unused GENC_UNUSED)
+{
+	const genc_uint128_t* k = GENC_CXX_CAST(const genc_uint128_t*, key);
+	return genc_hash_uint128(k->lo, k->hi);
+}
+
+genc_bool_t genc_uint128_keys_equal(void* key1, void* key2, void* opaque_unused GENC_UNUSED)
+{
+	const genc_uint128_t* k1 = GENC_CXX_CAST(const genc_uint128_t*, key1);
+	const genc_uint128_t* k2 = GENC_CXX_CAST(const genc_uint128_t*, key2);
+	return k1->lo == k2->lo && k1->hi == k2->hi;
+}
@@ -55,6 +55,12 @@ typedef size_t genc_hash_t;
  * to the key extracted from an item or passed to the library directly */
 typedef genc_hash_t(*genc_key_hash_fn)(void* key, void* opaque);
 
+/* Seeded variant of genc_key_hash_fn: hash tables supporting seeds pass their
+ * current seed, and may switch to a new one (rehashing all items) if they detect
+ * excessive collisions, which makes it hard for untrusted keys to degrade the
+ * table. Different seeds must yield unrelated hash values. */
+typedef genc_hash_t(*genc_seeded_key_hash_fn)(void* key, uint64_t seed, void* opaque);
+
 /* key accessor function - extracts pointer to the key from the item whose
  * chaining head is passed in. Chaining table uses a different one. */
 typedef void*(*genc_hash_get_item_key_fn)(void* item, void* opaque);
@@ -110,6 +116,86 @@ genc_bool_t genc_pointer_keys_equal(void* key1, void* key2, void* opaque_unused)
 
 size_t genc_hash_combine(size_t seed, size_t hash_value);
 
+/* Hash function for arbitrary byte sequences (wyhash), much faster than
+ * combining per-byte or per-word integer hashes. Results depend on byte order,
+ * so don't persist them across big and little endian machines. */
+size_t genc_hash_bytes(const void* data, size_t len, uint64_t seed);
+
+/* Incremental version of genc_hash_bytes for keys which aren't contiguous in
+ * memory: any sequence of updates produces the same hash as genc_hash_bytes
+ * over the concatenated data. */
+struct genc_hash_bytes_state
+{
+	uint64_t seed;
+	uint64_t see1;
+	uint64_t see2;
+	uint64_t len;
+	/* The last 16 bytes of the previous block followed by up to 48 pending
+	 * bytes; the final block may be read back into the previous one. */
+	uint8_t buffer[64];
+	size_t pending;
+};
+typedef struct genc_hash_bytes_state genc_hash_bytes_state_t;
+
+void genc_hash_bytes_init(genc_hash_bytes_state_t* state, uint64_t seed);
+void genc_hash_bytes_update(genc_hash_bytes_state_t* state, const void* data, size_t len);
+/* Returns the hash of all data so far; the state can continue to be updated. */
+size_t genc_hash_bytes_final(const genc_hash_bytes_state_t* state);
+
+/* Alternative fixed width key hashes built on the CRC32C (SSE4.2, ARMv8 CRC)
+ * and AES round (AES-NI) instructions, which take far fewer dependent
+ * instructions than the shift-and-add hashes above. When built with -msse4.2
+ * or -maes the instructions are used directly; otherwise CPU support is
+ * detected on first use on x86. Without it, the same values are computed in
+ * (much slower) software, so results never depend on the machine. Define
+ * GENC_HASH_NO_HW to always use the software versions. */
+size_t genc_hash_uint32_crc(uint32_t k);
+size_t genc_hash_uint64_crc(uint64_t k);
+size_t genc_hash_uint128(uint64_t lo, uint64_t hi);
+genc_bool_t genc_hash_hw_crc32c_available(void);
+genc_bool_t genc_hash_hw_aes_available(void);
+
+struct genc_uint128
+{
+	uint64_t lo;
+	uint64_t hi;
+};
+typedef struct genc_uint128 genc_uint128_t;
+
+size_t genc_uint32_key_hash_crc(void* key, void* opaque_unused);
+size_t genc_uint64_key_hash_crc(void* key, void* opaque_unused);
+/* For keys pointing to a genc_uint128_t */
+size_t genc_uint128_key_hash(void* key, void* opaque_unused);
+genc_bool_t genc_uint128_keys_equal(void* key1, void* key2, void* opaque_unused);
+
+/* Seeded integer hash */
+size_t genc_hash_uint64_seeded(uint64_t k, uint64_t seed);
+/* Derives a new, unpredictable (to anyone not knowing the old one) seed. */
+uint64_t genc_hash_next_seed(uint64_t seed);
+
+/* Seeded versions of the key hash functions above, for genc_seeded_key_hash_fn */
+size_t genc_uint32_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused);
+size_t genc_uint64_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused);
+size_t genc_pointer_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused);
+
+/* Keys which are strings with an explicit length */
+struct genc_lstring
+{
+	const char* str;
+	size_t length;
+};
+typedef struct genc_lstring genc_lstring_t;
+
+/* Hash and equality functions for keys pointing to a genc_lstring_t */
+size_t genc_lstring_key_hash(void* key, void* opaque_unused);
+genc_bool_t genc_lstring_keys_equal(void* key1, void* key2, void* opaque_unused);
+/* Hash and equality functions for keys pointing directly to NUL-terminated strings */
+size_t genc_cstring_key_hash(void* key, void* opaque_unused);
+genc_bool_t genc_cstring_keys_equal(void* key1, void* key2, void* opaque_unused);
+/* Seeded versions of the above, for genc_seeded_key_hash_fn */
+size_t genc_lstring_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused);
+size_t genc_cstring_key_hash_seeded(void* key, uint64_t seed, void* opaque_unused);
+
 /* Helpers for sizing power-of-2-capacity hash tables: */
 
 static GENC_INLINE int genc_is_pow2(size_t val)
@@ -129,6 +215,80 @@ static GENC_INLINE int genc_log2_size_roundup(size_t val)
 	return log2 + 1;
 }
 
+/* Optional statistics: build with GENC_HASH_TABLE_STATS defined to 1 to make
+ * the chaining and linear probing hash tables count their operations. The
+ * counters are part of the table structs, so the library and all code using
+ * the tables must agree on the setting. When it's 0 (the default), no counting
+ * code is compiled in at all, and the tables' stats snapshot functions only
+ * report their current layout. */
+#ifndef GENC_HASH_TABLE_STATS
+#define GENC_HASH_TABLE_STATS 0
+#endif
+
+/* Length histograms have logarithmic bins: bin 0 counts lengths of 0, bin i
+ * lengths from 2^(i-1) to 2^i - 1, and the last bin also everything longer. */
+#define GENC_HASH_STATS_HISTOGRAM_BINS 16
+
+static GENC_INLINE unsigned genc_hash_stats_histogram_bin(size_t length)
+{
+	unsigned bin = (unsigned)(genc_log2_size(length) + 1);
+	return bin < GENC_HASH_STATS_HISTOGRAM_BINS ? bin : GENC_HASH_STATS_HISTOGRAM_BINS - 1;
+}
+
+/* Cumulative operation counts of a table */
+struct genc_hash_table_stats
+{
+	/* lookups of a key (not counting those done by removals), and how many
+	 * of them found it */
+	uint64_t lookups;
+	uint64_t lookup_hits;
+	/* insertion attempts, and how many found the key already present (and
+	 * were rejected, or became updates or multimap insertions) */
+	uint64_t inserts;
+	uint64_t insert_duplicates;
+	uint64_t removes;
+	/* Lookups and insertions by probe length: the number of buckets probed
+	 * beyond the home bucket (LPHT) or of chain items passed over (CHT) */
+	uint64_t probe_lengths[GENC_HASH_STATS_HISTOGRAM_BINS];
+	/* capacity changes, and rehashes with a new seed */
+	uint64_t resizes;
+	uint64_t rehashes;
+	/* Items moved to a different bucket by resizes and rehashes, and the bytes
+	 * copied to do so (always 0 for the CHT, which relinks items in place) */
+	uint64_t items_moved;
+	uint64_t bytes_moved;
+};
+typedef struct genc_hash_table_stats genc_hash_table_stats_t;
+
+struct genc_hash_table_stats_snapshot
+{
+	/* all 0 unless built with GENC_HASH_TABLE_STATS */
+	genc_hash_table_stats_t ops;
+	size_t item_count;
+	size_t capacity;
+	/* Layout: for the CHT, the number of buckets by chain length; for the
+	 * LPHT, the number of items by distance from their home bucket (which is
+	 * the probe length of a lookup for them). */
+	uint64_t chain_lengths[GENC_HASH_STATS_HISTOGRAM_BINS];
+	size_t longest_chain;
+};
+typedef struct genc_hash_table_stats_snapshot genc_hash_table_stats_snapshot_t;
+
+#if GENC_HASH_TABLE_STATS
+/* Relaxed atomic additions keep lookups safe to run concurrently with each
+ * other where the table otherwise allows that. */
+#if defined(__GNUC__)
+#define GENC_HASH_STATS_ADD(STATS, FIELD, N) ((void)__atomic_fetch_add(&(STATS).FIELD, (uint64_t)(N), __ATOMIC_RELAXED))
+#else
+#define GENC_HASH_STATS_ADD(STATS, FIELD, N) ((void)((STATS).FIELD += (uint64_t)(N)))
+#endif
+#define GENC_HASH_STATS_PROBE(STATS, LENGTH) GENC_HASH_STATS_ADD(STATS, probe_lengths[genc_hash_stats_histogram_bin(LENGTH)], 1)
+#else
+#define GENC_HASH_STATS_ADD(STATS, FIELD, N) ((void)0)
+#define GENC_HASH_STATS_PROBE(STATS, LENGTH) ((void)0)
+#endif
+#define GENC_HASH_STATS_INC(STATS, FIELD) GENC_HASH_STATS_ADD(STATS, FIELD, 1)
+
 /// Helper macro for generating key getter functions (genc_hash_get_item_key_fn) for simple structs
 #define GENC_CHT_STRUCT_KEY_GETTER(STRUCTNAME, CHT_HEAD_MEMBER, KEY_MEMBER) \
 static void* STRUCTNAME ## _get_key(struct slist_head* item, void* opaque) \
@@ -0,0 +1,431 @@
+#include "hopscotch_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+#define HSHT_NO_BUCKET SIZE_MAX
+/* How far beyond the home bucket an insertion looks for a free bucket before
+ * giving up and growing the table */
+#define HSHT_MAX_FREE_DISTANCE 1024
+
+/* Occupied buckets' tags are taken from the top bits of a multiplicative
+ * remix, as in the Swiss table, so weak client hashes still spread them. */
+static GENC_INLINE uint8_t hsht_tag(genc_hash_t hash)
+{
+#if defined(__LP64__) || defined(_WIN64)
+	return (uint8_t)(0x80u | (((uint64_t)hash * UINT64_C(0x9e3779b97f4a7c15)) >> 57));
+#else
+	return (uint8_t)(0x80u | (((uint32_t)hash * UINT32_C(0x9e3779b9)) >> 25));
+#endif
+}
+
+/* Start of each group: the neighbourhood bitmaps and tags of its buckets */
+struct hsht_group_head
+{
+	uint32_t hop_info[GENC_HSHT_GROUP_BUCKETS];
+	uint8_t tags[GENC_HSHT_GROUP_BUCKETS];
+};
+/* The group's buckets follow at this offset, which keeps them aligned as far
+ * as the allocation is (up to 16 bytes) */
+#define HSHT_GROUP_HEAD_SIZE ((sizeof(struct hsht_group_head) + 15u) & ~(size_t)15u)
+
+static GENC_INLINE size_t hsht_group_size(size_t bucket_size)
+{
+	return HSHT_GROUP_HEAD_SIZE + bucket_size * GENC_HSHT_GROUP_BUCKETS;
+}
+
+static GENC_INLINE char* hsht_group_at(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	return GENC_CXX_CAST(char*, table->groups) + table->group_size * (idx / GENC_HSHT_GROUP_BUCKETS);
+}
+
+static GENC_INLINE struct hsht_group_head* hsht_head_at(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	void* head = hsht_group_at(table, idx);
+	return GENC_CXX_CAST(struct hsht_group_head*, head);
+}
+
+static GENC_INLINE uint32_t* hsht_hop_at(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	return &hsht_head_at(table, idx)->hop_info[idx % GENC_HSHT_GROUP_BUCKETS];
+}
+
+static GENC_INLINE uint8_t* hsht_tag_at(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	return &hsht_head_at(table, idx)->tags[idx % GENC_HSHT_GROUP_BUCKETS];
+}
+
+static GENC_INLINE char* hsht_bucket_at(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	return hsht_group_at(table, idx) + HSHT_GROUP_HEAD_SIZE + table->bucket_size * (idx % GENC_HSHT_GROUP_BUCKETS);
+}
+
+static GENC_INLINE size_t hsht_bucket_index(genc_hopscotch_hash_table_t* table, void* item)
+{
+	size_t offset = (size_t)(GENC_CXX_CAST(char*, item) - GENC_CXX_CAST(char*, table->groups));
+	size_t group = offset / table->group_size;
+	size_t in_group = offset % table->group_size - HSHT_GROUP_HEAD_SIZE;
+	return group * GENC_HSHT_GROUP_BUCKETS + in_group / table->bucket_size;
+}
+
+static GENC_INLINE genc_hash_t hsht_item_hash(genc_hopscotch_hash_table_t* table, void* item)
+{
+	return table->hash_fn(table->get_key_fn(item, table->opaque), table->opaque);
+}
+
+static GENC_INLINE size_t hsht_max_items(size_t capacity, uint8_t load_percent)
+{
+	return capacity / 100u * load_percent + (capacity % 100u) * load_percent / 100u;
+}
+
+genc_bool_t genc_hopscotch_hash_table_init(
+	genc_hopscotch_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size,
+	size_t initial_capacity_pow2)
+{
+	return genc_hopscotch_hash_table_init_ext(
+		table, hash_fn, get_key_fn, key_equality_fn, realloc_fn,
+		opaque, bucket_size, initial_capacity_pow2, 85);
+}
+
+static void hsht_free_groups(genc_hopscotch_hash_table_t* table, void* groups, size_t capacity)
+{
+	if (groups)
+		table->realloc_fn(groups, capacity / GENC_HSHT_GROUP_BUCKETS * table->group_size, 0, table->opaque);
+}
+
+/* Zeroes the bitmaps and tags of all groups, leaving the buckets alone */
+static void hsht_clear_heads(genc_hopscotch_hash_table_t* table)
+{
+	size_t idx;
+	for (idx = 0; idx < table->capacity; idx += GENC_HSHT_GROUP_BUCKETS)
+		memset(hsht_head_at(table, idx), 0, sizeof(struct hsht_group_head));
+}
+
+/* Allocates the groups for a table of the given capacity, with cleared heads. */
+static void* hsht_alloc_groups(genc_hopscotch_hash_table_t* table, size_t capacity)
+{
+	genc_hopscotch_hash_table_t new_table = *table;
+	if (SIZE_MAX / table->group_size < capacity / GENC_HSHT_GROUP_BUCKETS)
+		return NULL;
+	new_table.groups = table->realloc_fn(NULL, 0, capacity / GENC_HSHT_GROUP_BUCKETS * table->group_size, table->opaque);
+	if (!new_table.groups)
+		return NULL;
+	new_table.capacity = capacity;
+	hsht_clear_heads(&new_table);
+	return new_table.groups;
+}
+
+genc_bool_t genc_hopscotch_hash_table_init_ext(
+	genc_hopscotch_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size,
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold)
+{
+	size_t capacity;
+	if (load_percent_grow_threshold < 1 || load_percent_grow_threshold > 99)
+		return 0;
+	if (bucket_size == 0 || bucket_size > (SIZE_MAX - HSHT_GROUP_HEAD_SIZE) / GENC_HSHT_GROUP_BUCKETS)
+		return 0;
+
+	capacity = GENC_HSHT_NEIGHBOURHOOD;
+	while (capacity < initial_capacity_pow2)
+	{
+		if (capacity > SIZE_MAX / 2)
+			return 0;
+		capacity *= 2;
+	}
+
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->key_equality_fn = key_equality_fn;
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	table->bucket_size = bucket_size;
+	table->group_size = hsht_group_size(bucket_size);
+	table->load_percent_grow_threshold = load_percent_grow_threshold;
+	table->item_count = 0;
+
+	table->groups = hsht_alloc_groups(table, capacity);
+	if (!table->groups)
+		return 0;
+	table->capacity = capacity;
+	return 1;
+}
+
+size_t genc_hsht_count(genc_hopscotch_hash_table_t* table)
+{
+	return table->item_count;
+}
+
+size_t genc_hsht_capacity(genc_hopscotch_hash_table_t* table)
+{
+	return table->capacity;
+}
+
+void genc_hsht_destroy(genc_hopscotch_hash_table_t* table)
+{
+	hsht_free_groups(table, table->groups, table->capacity);
+	table->groups = NULL;
+	table->capacity = 0;
+	table->item_count = 0;
+}
+
+void genc_hsht_clear(genc_hopscotch_hash_table_t* table)
+{
+	hsht_clear_heads(table);
+	table->item_count = 0;
+}
+
+/* Returns the bucket index of the item with the given key, or HSHT_NO_BUCKET if not found. */
+static size_t hsht_find_index(genc_hopscotch_hash_table_t* table, void* key, genc_hash_t hash)
+{
+	const size_t mask = table->capacity - 1u;
+	const size_t home = hash & mask;
+	const uint8_t tag = hsht_tag(hash);
+	uint32_t hop = *hsht_hop_at(table, home);
+	while (hop)
+	{
+		size_t idx = (home + __builtin_ctz(hop)) & mask;
+		if (*hsht_tag_at(table, idx) == tag
+			&& table->key_equality_fn(key, table->get_key_fn(hsht_bucket_at(table, idx), table->opaque), table->opaque))
+			return idx;
+		hop &= hop - 1u;
+	}
+	return HSHT_NO_BUCKET;
+}
+
+/* Moves the free bucket closer to the start of the neighbourhood it is needed
+ * in: finds the earliest item which may move into it without leaving its own
+ * neighbourhood, moves it, and returns the index of the bucket it vacated. */
+static size_t hsht_hop_free_bucket(genc_hopscotch_hash_table_t* table, size_t free_idx)
+{
+	const size_t mask = table->capacity - 1u;
+	unsigned dist;
+	for (dist = GENC_HSHT_NEIGHBOURHOOD - 1u; dist > 0; --dist)
+	{
+		size_t home = (free_idx - dist) & mask;
+		uint32_t* hop = hsht_hop_at(table, home);
+		uint32_t movable = *hop & ((UINT32_C(1) << dist) - 1u);
+		if (movable)
+		{
+			unsigned offset = (unsigned)__builtin_ctz(movable);
+			size_t src_idx = (home + offset) & mask;
+			memcpy(hsht_bucket_at(table, free_idx), hsht_bucket_at(table, src_idx), table->bucket_size);
+			*hsht_tag_at(table, free_idx) = *hsht_tag_at(table, src_idx);
+			*hsht_tag_at(table, src_idx) = 0;
+			*hop = (*hop | (UINT32_C(1) << dist)) & ~(UINT32_C(1) << offset);
+			return src_idx;
+		}
+	}
+	return HSHT_NO_BUCKET;
+}
+
+/* Places a copy of the (new) item without growing the table. Returns the
+ * bucket, or NULL if no free bucket could be brought into its neighbourhood. */
+static void* hsht_place(genc_hopscotch_hash_table_t* table, void* item, genc_hash_t hash)
+{
+	const size_t mask = table->capacity - 1u;
+	const size_t home = hash & mask;
+	const size_t max_dist = table->capacity < HSHT_MAX_FREE_DISTANCE ? table->capacity : HSHT_MAX_FREE_DISTANCE;
+	size_t dist, free_idx;
+	for (dist = 0; dist < max_dist; ++dist)
+	{
+		if (*hsht_tag_at(table, (home + dist) & mask) == 0)
+			break;
+	}
+	if (dist == max_dist)
+		return NULL;
+
+	free_idx = (home + dist) & mask;
+	while (dist >= GENC_HSHT_NEIGHBOURHOOD)
+	{
+		free_idx = hsht_hop_free_bucket(table, free_idx);
+		if (free_idx == HSHT_NO_BUCKET)
+			return NULL;
+		dist = (free_idx - home) & mask;
+	}
+
+	memcpy(hsht_bucket_at(table, free_idx), item, table->bucket_size);
+	*hsht_tag_at(table, free_idx) = hsht_tag(hash);
+	*hsht_hop_at(table, home) |= UINT32_C(1) << dist;
+	++table->item_count;
+	return hsht_bucket_at(table, free_idx);
+}
+
+/* Reinserts all items into freshly allocated arrays of the given capacity.
+ * Leaves the table unchanged on failure. */
+static genc_bool_t hsht_rehash(genc_hopscotch_hash_table_t* table, size_t new_capacity)
+{
+	genc_hopscotch_hash_table_t new_table = *table;
+	size_t i;
+	new_table.groups = hsht_alloc_groups(table, new_capacity);
+	if (!new_table.groups)
+		return 0;
+	new_table.capacity = new_capacity;
+	new_table.item_count = 0;
+
+	for (i = 0; i < table->capacity; ++i)
+	{
+		void* item;
+		if (*hsht_tag_at(table, i) == 0)
+			continue;
+		item = hsht_bucket_at(table, i);
+		if (!hsht_place(&new_table, item, hsht_item_hash(table, item)))
+		{
+			hsht_free_groups(table, new_table.groups, new_capacity);
+			return 0;
+		}
+	}
+
+	hsht_free_groups(table, table->groups, table->capacity);
+	*table = new_table;
+	return 1;
+}
+
+/* Grows the table while the load factor threshold is reached, or the item
+ * can't be placed in a table which is at least half full. Failing to place an
+ * item in an emptier table means the hash maps too many keys to the same
+ * neighbourhood, which growing won't fix. */
+static void* hsht_insert_new(genc_hopscotch_hash_table_t* table, void* item, genc_hash_t hash)
+{
+	void* bucket;
+	if (table->item_count >= hsht_max_items(table->capacity, table->load_percent_grow_threshold))
+	{
+		if (table->capacity > SIZE_MAX / 2 || !hsht_rehash(table, table->capacity * 2u))
+			return NULL;
+	}
+	while (!(bucket = hsht_place(table, item, hash)))
+	{
+		if (table->item_count < table->capacity / 2u || table->capacity > SIZE_MAX / 2)
+			return NULL;
+		if (!hsht_rehash(table, table->capacity * 2u))
+			return NULL;
+	}
+	return bucket;
+}
+
+void* genc_hsht_insert_item(genc_hopscotch_hash_table_t* table, void* item)
+{
+	void* key = table->get_key_fn(item, table->opaque);
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	if (hsht_find_index(table, key, hash) != HSHT_NO_BUCKET)
+		return NULL;
+	return hsht_insert_new(table, item, hash);
+}
+
+void* genc_hsht_insert_or_update_item(genc_hopscotch_hash_table_t* table, void* item)
+{
+	void* key = table->get_key_fn(item, table->opaque);
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	size_t idx = hsht_find_index(table, key, hash);
+	if (idx != HSHT_NO_BUCKET)
+	{
+		void* bucket = hsht_bucket_at(table, idx);
+		memcpy(bucket, item, table->bucket_size);
+		return bucket;
+	}
+	return hsht_insert_new(table, item, hash);
+}
+
+void* genc_hsht_find(genc_hopscotch_hash_table_t* table, void* key)
+{
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	size_t idx = hsht_find_index(table, key, hash);
+	if (idx == HSHT_NO_BUCKET)
+		return NULL;
+	return hsht_bucket_at(table, idx);
+}
+
+void genc_hsht_remove(genc_hopscotch_hash_table_t* table, void* item)
+{
+	const size_t mask = table->capacity - 1u;
+	size_t idx = hsht_bucket_index(table, item);
+	size_t home = hsht_item_hash(table, item) & mask;
+	*hsht_hop_at(table, home) &= ~(UINT32_C(1) << ((idx - home) & mask));
+	*hsht_tag_at(table, idx) = 0;
+	--table->item_count;
+}
+
+genc_bool_t genc_hsht_reserve_space(genc_hopscotch_hash_table_t* table, size_t target_count)
+{
+	size_t capacity = table->capacity;
+	while (hsht_max_items(capacity, table->load_percent_grow_threshold) <= target_count)
+	{
+		if (capacity > SIZE_MAX / 2)
+			return 0;
+		capacity *= 2;
+	}
+	if (capacity == table->capacity)
+		return 1;
+	return hsht_rehash(table, capacity);
+}
+
+genc_bool_t genc_hsht_verify(genc_hopscotch_hash_table_t* table)
+{
+	const size_t mask = table->capacity - 1u;
+	size_t i;
+	size_t items = 0, hop_bits = 0;
+	for (i = 0; i < table->capacity; ++i)
+	{
+		uint32_t hop = *hsht_hop_at(table, i);
+		for (; hop; hop &= hop - 1u)
+		{
+			if (*hsht_tag_at(table, (i + __builtin_ctz(hop)) & mask) == 0)
+				return 0;
+			++hop_bits;
+		}
+	}
+	for (i = 0; i < table->capacity; ++i)
+	{
+		void* item;
+		void* key;
+		genc_hash_t hash;
+		size_t dist;
+		if (*hsht_tag_at(table, i) == 0)
+			continue;
+		++items;
+		item = hsht_bucket_at(table, i);
+		key = table->get_key_fn(item, table->opaque);
+		hash = table->hash_fn(key, table->opaque);
+		dist = (i - hash) & mask;
+		if (*hsht_tag_at(table, i) != hsht_tag(hash) || dist >= GENC_HSHT_NEIGHBOURHOOD)
+			return 0;
+		if (!(*hsht_hop_at(table, hash & mask) & (UINT32_C(1) << dist)))
+			return 0;
+		if (hsht_find_index(table, key, hash) != i)
+			return 0;
+	}
+	return items == table->item_count && hop_bits == table->item_count;
+}
+
+static void* hsht_first_item_from(genc_hopscotch_hash_table_t* table, size_t idx)
+{
+	for (; idx < table->capacity; ++idx)
+	{
+		if (*hsht_tag_at(table, idx) != 0)
+			return hsht_bucket_at(table, idx);
+	}
+	return NULL;
+}
+
+void* genc_hsht_first_item(genc_hopscotch_hash_table_t* table)
+{
+	return hsht_first_item_from(table, 0);
+}
+
+void* genc_hsht_next_item(genc_hopscotch_hash_table_t* table, void* cur_item)
+{
+	return hsht_first_item_from(table, hsht_bucket_index(table, cur_item) + 1u);
+}
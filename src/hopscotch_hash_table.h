@@ -0,0 +1,190 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * An open addressing hash table using hopscotch hashing: every item is kept
+ * within GENC_HSHT_NEIGHBOURHOOD buckets of its home bucket (the one its hash
+ * maps to), and each home bucket has a bitmap of which buckets in its
+ * neighbourhood hold its items. A lookup therefore tests at most that many
+ * buckets, only those whose bit is set, and never walks clusters belonging to
+ * other home buckets, so lookups don't degrade with load factor the way linear
+ * probing does.
+ *
+ * When the nearest free bucket is beyond the neighbourhood, items between it
+ * and the home bucket are moved into it (while staying within their own
+ * neighbourhoods), "hopping" the free bucket closer; if that's impossible,
+ * the table grows. As a consequence, insertions may move other items, so
+ * pointers to items are only valid until the next insertion.
+ *
+ * Buckets are client-defined and memcpy-able as in the linear probing table,
+ * but occupancy is tracked by the table alongside a 7-bit hash tag per bucket
+ * (which avoids most key comparisons), so there are no empty/clear callbacks.
+ *
+ * Bitmaps, tags and buckets share one allocation, in groups of
+ * GENC_HSHT_GROUP_BUCKETS buckets each preceded by their bitmaps and tags.
+ * A lookup, which reads its home bucket's bitmap, then the tags and buckets
+ * just after it, thus mostly stays within one or two adjacent cache lines
+ * rather than touching three separate arrays.
+ */
+
+#ifndef GENCCONT_HOPSCOTCH_HASH_TABLE_H
+#define GENCCONT_HOPSCOTCH_HASH_TABLE_H
+
+#include "hash_shared.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of buckets (starting at the home bucket) an item may be placed in,
+ * the width of the neighbourhood bitmaps */
+#define GENC_HSHT_NEIGHBOURHOOD 32
+/* Buckets per group of the interleaved layout */
+#define GENC_HSHT_GROUP_BUCKETS 8
+
+struct genc_hopscotch_hash_table
+{
+	genc_key_hash_fn hash_fn;
+	genc_hash_get_item_key_fn get_key_fn;
+	genc_hash_key_equality_fn key_equality_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+	size_t bucket_size; /* bytes per item */
+	/* Total number of buckets, a power of 2 and at least GENC_HSHT_NEIGHBOURHOOD */
+	size_t capacity;
+	/* Number of filled buckets */
+	size_t item_count;
+	/* capacity / GENC_HSHT_GROUP_BUCKETS groups, each consisting of:
+	 * - per home bucket: bit i is set if bucket (home + i) % capacity holds one
+	 *   of its items
+	 * - per bucket: 0 if empty, otherwise 7 bits of the item's hash with the
+	 *   top bit set
+	 * - padding to a multiple of 16 bytes, then the buckets themselves */
+	void* groups;
+	/* Bytes per group */
+	size_t group_size;
+	uint8_t load_percent_grow_threshold;
+};
+typedef struct genc_hopscotch_hash_table genc_hopscotch_hash_table_t;
+
+/* Initialises the empty hash table with the given function implementations and capacity.
+ * The default load factor threshold for growing (85%) is used. Capacity is
+ * rounded up to a power of 2 of at least GENC_HSHT_NEIGHBOURHOOD. */
+genc_bool_t genc_hopscotch_hash_table_init(
+	genc_hopscotch_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn /* Make sure this fulfils the buckets' alignment requirements (up to 16 bytes)! */,
+	void* opaque,
+	size_t bucket_size, /* bytes per item */
+	size_t initial_capacity_pow2);
+
+/* Initialises the hash table with a non-default growth threshold (1-99). The
+ * table also grows early if an insertion can't find a bucket close enough to
+ * the item's home bucket. */
+genc_bool_t genc_hopscotch_hash_table_init_ext(
+	genc_hopscotch_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size, /* bytes per item */
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold);
+
+/* Returns the current number of items in the hash table. */
+size_t genc_hsht_count(genc_hopscotch_hash_table_t* table);
+
+/* Returns the number of buckets allocated. */
+size_t genc_hsht_capacity(genc_hopscotch_hash_table_t* table);
+
+/* Drops all items from the table and deallocates the table's arrays. */
+void genc_hsht_destroy(genc_hopscotch_hash_table_t* table);
+
+/* Drops all items from the table but does not resize or deallocate it. */
+void genc_hsht_clear(genc_hopscotch_hash_table_t* table);
+
+/* Inserts a copy of the given item into the hash table.
+ * Returns NULL to report failure due to a duplicate or growth failure, pointer
+ * to inserted bucket on success. Other items may be moved. */
+void* genc_hsht_insert_item(genc_hopscotch_hash_table_t* table, void* item);
+/* As genc_hsht_insert_item, but overwrites any existing item with the same key. */
+void* genc_hsht_insert_or_update_item(genc_hopscotch_hash_table_t* table, void* item);
+
+/* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
+void* genc_hsht_find(genc_hopscotch_hash_table_t* table, void* key);
+
+/* Removes the item from the hash table. item must point to the location of the
+ * value within the table - i.e. returned by genc_hsht_find or genc_hsht_insert_item */
+void genc_hsht_remove(genc_hopscotch_hash_table_t* table, void* item);
+
+/* Resizes the table, if necessary, so that it will not need resizing to hold
+ * target_count items (unless the hash function clusters them badly). */
+genc_bool_t genc_hsht_reserve_space(genc_hopscotch_hash_table_t* table, size_t target_count);
+
+/* Walks all the elements in the hash table and checks they can be found and
+ * that the neighbourhood bitmaps are consistent. */
+genc_bool_t genc_hsht_verify(genc_hopscotch_hash_table_t* table);
+
+/* Iterating over all the items in the table: */
+
+/* First non-empty bucket. */
+void* genc_hsht_first_item(genc_hopscotch_hash_table_t* table);
+/* Next non-empty bucket */
+void* genc_hsht_next_item(genc_hopscotch_hash_table_t* table, void* cur_item);
+
+#define genc_hsht_first_obj(table, type) \
+GENC_CXX_CAST(type*, genc_hsht_first_item(table))
+
+#define genc_hsht_next_obj(table, cur_obj, type) \
+GENC_CXX_CAST(type*, genc_hsht_next_item(table, GENC_CXX_CAST(type*, cur_obj)))
+
+#define genc_hsht_find_obj(table, key, type) \
+GENC_CXX_CAST(type*, genc_hsht_find(table, key))
+
+#define genc_hsht_insert_obj(table, new_obj, type) \
+GENC_CXX_CAST(type*, genc_hsht_insert_item(table, GENC_CXX_CAST(type*, new_obj)))
+
+#define genc_hsht_for_each_obj(type, obj_var, table) \
+for (type* obj_var = genc_hsht_first_obj(table, type); obj_var != NULL; obj_var = genc_hsht_next_obj(table, obj_var, type))
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ Copyright (c) 2026 genccont contributors
+ 
+ This software is provided 'as-is', without any express or implied
+ warranty. In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented; you must not
+ claim that you wrote the original software. If you use this software
+ in a product, an acknowledgment in the product documentation would be
+ appreciated but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such, and must not be
+ misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source
+ distribution.
+ */
+
+#include "interval_tree.h"
+
+#ifndef KERNEL
+#include <assert.h>
+#endif
+
+static GENC_INLINE genc_interval_tree_item_t* interval_item(genc_bt_node_head_t* head)
+{
+	return genc_container_of(head, genc_interval_tree_item_t, head);
+}
+
+/* Orders by start, then end. Identical ranges are ordered by address, as the
+ * binary tree doesn't permit equal items. */
+static genc_bool_t interval_node_less(genc_bt_node_head_t* a_head, genc_bt_node_head_t* b_head, void* opaque GENC_UNUSED)
+{
+	genc_interval_tree_item_t* a = interval_item(a_head);
+	genc_interval_tree_item_t* b = interval_item(b_head);
+	if (a->range_start != b->range_start)
+		return a->range_start < b->range_start;
+	if (a->range_end != b->range_end)
+		return a->range_end < b->range_end;
+	return (uintptr_t)a < (uintptr_t)b;
+}
+
+static void interval_node_update(genc_bt_node_head_t* head, void* opaque GENC_UNUSED)
+{
+	genc_interval_tree_item_t* item = interval_item(head);
+	uint64_t max_end = item->range_end;
+	if (head->left && interval_item(head->left)->subtree_max_end > max_end)
+		max_end = interval_item(head->left)->subtree_max_end;
+	if (head->right && interval_item(head->right)->subtree_max_end > max_end)
+		max_end = interval_item(head->right)->subtree_max_end;
+	item->subtree_max_end = max_end;
+}
+
+void genc_interval_tree_init(genc_binary_tree_t* tree)
+{
+	genc_binary_tree_init_rb(tree, interval_node_less, NULL);
+	genc_bt_set_update_fn(tree, interval_node_update);
+}
+
+void genc_interval_tree_insert(genc_binary_tree_t* tree, genc_interval_tree_item_t* item)
+{
+	genc_bool_t ok GENC_UNUSED;
+	assert(item->range_start < item->range_end);
+	item->subtree_max_end = item->range_end;
+	ok = genc_bt_insert(tree, &item->head);
+	assert(ok);
+}
+
+void genc_interval_tree_remove(genc_binary_tree_t* tree, genc_interval_tree_item_t* item)
+{
+	genc_bt_remove(tree, &item->head);
+}
+
+void genc_interval_tree_update_end(genc_binary_tree_t* tree, genc_interval_tree_item_t* item)
+{
+	genc_bt_propagate_update(tree, &item->head);
+}
+
+/* Finds the lowest item in the subtree overlapping [start, end). If there is
+ * none, sets *past_end if that's because the subtree contains ranges starting
+ * at or after 'end', which means nothing further right can overlap either. */
+static genc_interval_tree_item_t* first_overlap_in_subtree(
+	genc_bt_node_head_t* node, uint64_t start, uint64_t end, genc_bool_t* past_end)
+{
+	while (node)
+	{
+		genc_interval_tree_item_t* item = interval_item(node);
+		if (item->subtree_max_end <= start)
+			return NULL; /* everything in this subtree ends before the query range */
+		
+		if (node->left && interval_item(node->left)->subtree_max_end > start)
+		{
+			/* Some range in the left subtree ends after our start. If none of those
+			 * overlap, they must all begin at or after our end, and so does
+			 * everything further right. So the answer is in the left subtree or
+			 * nowhere. */
+			node = node->left;
+			continue;
+		}
+		if (item->range_start >= end)
+		{
+			/* this and everything to the right is above the query range */
+			*past_end = true;
+			return NULL;
+		}
+		if (item->range_end > start)
+			return item;
+		node = node->right;
+	}
+	return NULL;
+}
+
+genc_interval_tree_item_t* genc_interval_tree_first_overlap(
+	genc_binary_tree_t* tree, uint64_t start, uint64_t end)
+{
+	genc_bool_t past_end = false;
+	if (start >= end)
+		return NULL;
+	return first_overlap_in_subtree(tree->root, start, end, &past_end);
+}
+
+genc_interval_tree_item_t* genc_interval_tree_next_overlap(
+	genc_binary_tree_t* tree GENC_UNUSED, genc_interval_tree_item_t* item, uint64_t start, uint64_t end)
+{
+	genc_bt_node_head_t* node = &item->head;
+	genc_interval_tree_item_t* found;
+	genc_bool_t past_end = false;
+	
+	/* Resume the in-order walk at 'item' rather than searching from the root:
+	 * successors are in the right subtree, followed by the ancestors of which
+	 * we're in the left subtree, each followed by their right subtrees. Over a
+	 * whole iteration, each edge is thus descended and ascended at most once,
+	 * and subtrees ending before 'start' are skipped without descending. */
+	found = first_overlap_in_subtree(node->right, start, end, &past_end);
+	if (found || past_end)
+		return found;
+	
+	while (node->parent)
+	{
+		genc_bt_node_head_t* parent = node->parent;
+		if (parent->left == node)
+		{
+			genc_interval_tree_item_t* parent_item = interval_item(parent);
+			if (parent_item->range_start >= end)
+				return NULL;
+			if (parent_item->range_end > start)
+				return parent_item;
+			found = first_overlap_in_subtree(parent->right, start, end, &past_end);
+			if (found || past_end)
+				return found;
+		}
+		node = parent;
+	}
+	return NULL;
+}
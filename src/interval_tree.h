@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2026 genccont contributors
+ 
+ This software is provided 'as-is', without any express or implied
+ warranty. In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented; you must not
+ claim that you wrote the original software. If you use this software
+ in a product, an acknowledgment in the product documentation would be
+ appreciated but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such, and must not be
+ misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source
+ distribution.
+ */
+
+/*
+ * Interval tree: a variant of the range binary tree in which ranges may
+ * overlap (or even be identical). Built on a red-black genc_binary_tree
+ * ordered by range start, with each node caching the maximum range end
+ * in its subtree, so that finding all K ranges overlapping a query range
+ * doesn't need to walk past non-overlapping nodes.
+ */
+
+#ifndef GENCCONT_INTERVAL_TREE_H
+#define GENCCONT_INTERVAL_TREE_H
+
+#include "binary_tree.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct genc_interval_tree_item
+{
+	genc_bt_node_head_t head;
+	/*binary tree key*/
+	uint64_t range_start;
+	/*non inclusive*/
+	uint64_t range_end;
+	/* Greatest range_end in the subtree rooted at this item. Maintained by the
+	 * tree, do not modify. */
+	uint64_t subtree_max_end;
+};
+typedef struct genc_interval_tree_item genc_interval_tree_item_t;
+
+/* Initialises an empty interval tree. */
+void genc_interval_tree_init(genc_binary_tree_t* tree);
+
+/* Inserts the range into the tree. Overlap with existing ranges is allowed,
+ * so this can't fail. Ranges must not be empty (range_start < range_end). */
+void genc_interval_tree_insert(genc_binary_tree_t* tree, genc_interval_tree_item_t* item);
+
+/* Removes the range, which must be part of the tree. */
+void genc_interval_tree_remove(genc_binary_tree_t* tree, genc_interval_tree_item_t* item);
+
+/* Must be called after changing an item's range_end in-place. (Changing
+ * range_start requires removal and re-insertion.) */
+void genc_interval_tree_update_end(genc_binary_tree_t* tree, genc_interval_tree_item_t* item);
+
+/* Returns the item with the lowest start which overlaps [start, end), or NULL
+ * if no such item exists. O(log N) */
+genc_interval_tree_item_t* genc_interval_tree_first_overlap(
+	genc_binary_tree_t* tree, uint64_t start, uint64_t end);
+
+/* Returns the next item (in order of range start) after 'item' which overlaps
+ * [start, end), or NULL if there are no more. Continues from 'item' rather
+ * than the root, so iterating over all K overlapping items visits each tree
+ * edge at most twice, rather than costing O(K log N) descents. */
+genc_interval_tree_item_t* genc_interval_tree_next_overlap(
+	genc_binary_tree_t* tree, genc_interval_tree_item_t* item, uint64_t start, uint64_t end);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Loops over all items overlapping [start, end). The loop body must not modify
+ * the tree. */
+#define genc_interval_tree_for_each_overlap(loop_var, tree, start, end) \
+	for (loop_var = genc_interval_tree_first_overlap((tree), (start), (end)); \
+		loop_var; \
+		loop_var = genc_interval_tree_next_overlap((tree), loop_var, (start), (end)))
+
+#define genc_interval_tree_first_item(tree) \
+	genc_bt_first_obj(tree, genc_interval_tree_item_t, head)
+
+#define genc_interval_tree_next_item(tree, item) \
+	genc_bt_next_obj(tree, item, genc_interval_tree_item_t, head)
+
+#endif
@@ -1,6 +1,109 @@
 #include "linear_probing_hash_table.h"
 #include <string.h>
 
+/* In GENC_LPHT_STORE_HASHES mode, the hashes array holds each occupied bucket's
+ * hash with the top bit set, or 0 for empty buckets. The top bit is never
+ * needed for bucket indexing, so this loses no information we care about. */
+#define LPHT_HASH_OCCUPIED (((genc_hash_t)1) << (sizeof(genc_hash_t) * 8 - 1))
+
+/* Bucket access helpers. These dispatch either to the client's callbacks or,
+ * for inline-key descriptors (key_size != 0), to direct memory comparisons. */
+
+static GENC_INLINE genc_bool_t lpht_inline_keys_equal(const void* key1, const void* key2, size_t key_size)
+{
+	/* fixed-size memcpy compiles to a single load on any decent compiler */
+	if (key_size == sizeof(uint64_t))
+	{
+		uint64_t k1, k2;
+		memcpy(&k1, key1, sizeof(k1));
+		memcpy(&k2, key2, sizeof(k2));
+		return k1 == k2;
+	}
+	else if (key_size == sizeof(uint32_t))
+	{
+		uint32_t k1, k2;
+		memcpy(&k1, key1, sizeof(k1));
+		memcpy(&k2, key2, sizeof(k2));
+		return k1 == k2;
+	}
+	return 0 == memcmp(key1, key2, key_size);
+}
+
+static GENC_INLINE void* lpht_item_key(const genc_linear_probing_hash_table_desc_t* desc, void* item, void* opaque)
+{
+	if (desc->key_size)
+		return GENC_CXX_CAST(char*, item) + desc->key_offset;
+	return desc->get_key_fn(item, opaque);
+}
+
+static GENC_INLINE genc_bool_t lpht_keys_equal(const genc_linear_probing_hash_table_desc_t* desc, void* key1, void* key2, void* opaque)
+{
+	if (desc->key_size)
+		return lpht_inline_keys_equal(key1, key2, desc->key_size);
+	return desc->key_equality_fn(key1, key2, opaque);
+}
+
+static GENC_INLINE genc_bool_t lpht_item_is_empty(const genc_linear_probing_hash_table_desc_t* desc, void* item, void* opaque)
+{
+	if (desc->key_size)
+		return lpht_inline_keys_equal(GENC_CXX_CAST(char*, item) + desc->key_offset, desc->empty_key, desc->key_size);
+	return desc->item_empty_fn(item, opaque);
+}
+
+static GENC_INLINE char* lpht_bucket_at(
+	const genc_linear_probing_hash_table_desc_t* desc, void* buckets, size_t idx)
+{
+	return GENC_CXX_CAST(char*, buckets) + desc->bucket_size * idx;
+}
+
+static GENC_INLINE size_t lpht_bucket_index(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* bucket)
+{
+	return (GENC_CXX_CAST(char*, bucket) - GENC_CXX_CAST(char*, table->buckets)) / desc->bucket_size;
+}
+
+static GENC_INLINE genc_hash_t lpht_hash_key(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* key, void* opaque)
+{
+	if (desc->seeded_hash_fn)
+		return desc->seeded_hash_fn(key, table->seed, opaque);
+	return desc->hash_fn(key, opaque);
+}
+
+/* Returns the hash of the item in the (non-empty) bucket at idx, from the hash
+ * array if present. */
+static GENC_INLINE genc_hash_t lpht_bucket_hash(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	size_t idx)
+{
+	if (table->hashes)
+		return table->hashes[idx];
+	return lpht_hash_key(table, desc, lpht_item_key(desc, lpht_bucket_at(desc, table->buckets, idx), opaque), opaque);
+}
+
+static GENC_INLINE genc_bool_t lpht_bucket_is_empty(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	size_t idx)
+{
+	if (table->hashes)
+		return table->hashes[idx] == 0;
+	return lpht_item_is_empty(desc, lpht_bucket_at(desc, table->buckets, idx), opaque);
+}
+
+static GENC_INLINE void lpht_item_clear(const genc_linear_probing_hash_table_desc_t* desc, void* item, void* opaque)
+{
+	if (desc->item_clear_fn)
+	{
+		desc->item_clear_fn(item, opaque);
+	}
+	else
+	{
+		/* inline-key descriptor without clear function */
+		memset(item, 0, desc->bucket_size);
+		memcpy(GENC_CXX_CAST(char*, item) + desc->key_offset, desc->empty_key, desc->key_size);
+	}
+}
+
 /* Initialises the empty hash table with the given function implementations and capacity.
  * Defaults (70, 0) are used for load factor percentage thresholds for growing and shrinking. */
 genc_bool_t genc_linear_probing_hash_table_init(
@@ -21,7 +124,9 @@ genc_bool_t genc_linear_probing_hash_table_init(
 		opaque, bucket_size, initial_capacity_pow2, 70, 0);
 }
 
-static void clear_buckets(void* buckets, const size_t capacity, const size_t bucket_size, genc_item_clear_fn item_clear_fn, void* opaque);
+static void clear_buckets(void* buckets, const size_t capacity, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
+static void lpht_free_old_buckets(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
 
 void genc_lpht_clear(genc_linear_probing_hash_table_t* table)
 {
@@ -29,28 +134,52 @@ void genc_lpht_clear(genc_linear_probing_hash_table_t* table)
 }
 void genc_lphtl_clear(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
 {
-	clear_buckets(table->buckets, table->capacity, desc->bucket_size, desc->item_clear_fn, opaque);
+	// no point migrating items we're about to drop
+	if (table->old_buckets)
+		lpht_free_old_buckets(table, desc, opaque);
+	clear_buckets(table->buckets, table->capacity, desc, opaque);
+	if (table->hashes)
+		memset(table->hashes, 0, table->capacity * sizeof(genc_hash_t));
 	table->item_count = 0;
 }
 
 static void* alloc_empty_buckets(
-	genc_realloc_fn realloc_fn, genc_item_clear_fn item_clear_fn,
-	size_t capacity, size_t bucket_size, void* opaque)
+	const genc_linear_probing_hash_table_desc_t* desc, size_t capacity, void* opaque)
 {
-	void* buckets = realloc_fn(NULL, 0, capacity * bucket_size, opaque);
+	void* buckets = desc->realloc_fn(NULL, 0, capacity * desc->bucket_size, opaque);
 	if (!buckets)
 		return NULL;
 
-	clear_buckets(buckets, capacity, bucket_size, item_clear_fn, opaque);
+	clear_buckets(buckets, capacity, desc, opaque);
 	return buckets;
 }
 
-static void clear_buckets(void* buckets, const size_t capacity, const size_t bucket_size, genc_item_clear_fn item_clear_fn, void* opaque)
+static genc_hash_t* alloc_empty_hashes(
+	const genc_linear_probing_hash_table_desc_t* desc, size_t capacity, void* opaque)
+{
+	genc_hash_t* hashes;
+	if (SIZE_MAX / sizeof(genc_hash_t) < capacity)
+		return NULL;
+	hashes = GENC_CXX_CAST(genc_hash_t*, desc->realloc_fn(NULL, 0, capacity * sizeof(genc_hash_t), opaque));
+	if (hashes)
+		memset(hashes, 0, capacity * sizeof(genc_hash_t));
+	return hashes;
+}
+
+static void free_hashes(
+	const genc_linear_probing_hash_table_desc_t* desc, genc_hash_t* hashes, size_t capacity, void* opaque)
+{
+	if (hashes)
+		desc->realloc_fn(hashes, capacity * sizeof(genc_hash_t), 0, opaque);
+}
+
+static void clear_buckets(void* buckets, const size_t capacity, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
 {	// set all buckets to empty
+	const size_t bucket_size = desc->bucket_size;
 	char* bucket = GENC_CXX_CAST(char*, buckets);
 	for (size_t i = 0; i < capacity; ++i)
 	{
-		item_clear_fn(bucket, opaque);
+		lpht_item_clear(desc, bucket, opaque);
 		bucket += bucket_size;
 	}
 }
@@ -83,6 +212,17 @@ genc_bool_t genc_linear_probing_hash_table_init_ext(
 	return genc_linear_probing_hash_table_light_init(&table->table, &table->desc, opaque, initial_capacity_pow2);
 }
 
+genc_bool_t genc_linear_probing_hash_table_init_with_desc(
+	struct genc_linear_probing_hash_table* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	size_t initial_capacity_pow2)
+{
+	table->desc = *desc;
+	table->opaque = opaque;
+	return genc_linear_probing_hash_table_light_init(&table->table, &table->desc, opaque, initial_capacity_pow2);
+}
+
 genc_bool_t genc_linear_probing_hash_table_light_init(
 	genc_linear_probing_hash_table_light_t* table,
 	const genc_linear_probing_hash_table_desc_t* desc,
@@ -90,19 +230,41 @@ genc_bool_t genc_linear_probing_hash_table_light_init(
 	size_t initial_capacity_pow2)
 {
 	void* buckets;
+	genc_hash_t* hashes = NULL;
 	if (!genc_is_pow2(initial_capacity_pow2))
 		return 0;
 	if (SIZE_MAX / desc->bucket_size < initial_capacity_pow2)
 		return 0; // overflow
 	
-	buckets = alloc_empty_buckets(
-		desc->realloc_fn, desc->item_clear_fn, initial_capacity_pow2, desc->bucket_size, opaque);
+	/* Robin Hood probing needs residents' hashes, so always keep them */
+	if (desc->flags & (GENC_LPHT_STORE_HASHES | GENC_LPHT_ROBIN_HOOD))
+	{
+		hashes = alloc_empty_hashes(desc, initial_capacity_pow2, opaque);
+		if (!hashes)
+			return false;
+	}
+	buckets = alloc_empty_buckets(desc, initial_capacity_pow2, opaque);
 	if (!buckets)
+	{
+		free_hashes(desc, hashes, initial_capacity_pow2, opaque);
 		return false;
+	}
 	
 	table->capacity = initial_capacity_pow2;
 	table->item_count = 0;
 	table->buckets = buckets;
+	table->hashes = hashes;
+	table->old_buckets = NULL;
+	table->old_hashes = NULL;
+	table->old_capacity = 0;
+	table->migrate_start = 0;
+	table->migrated = 0;
+	table->seed = 0;
+	table->reseed_count = 0;
+	table->probe_length_limit = 0;
+#if GENC_HASH_TABLE_STATS
+	memset(&table->stats, 0, sizeof(table->stats));
+#endif
 	return true;
 }
 
@@ -127,6 +289,32 @@ void genc_linear_probing_hash_table_desc_init(
 	desc->bucket_size = bucket_size;
 	desc->load_percent_grow_threshold = load_percent_grow_threshold;
 	desc->load_percent_shrink_threshold = load_percent_shrink_threshold;
+	desc->key_offset = 0;
+	desc->key_size = 0;
+	desc->empty_key = NULL;
+	desc->flags = 0;
+	desc->migrate_buckets_per_op = 0;
+	desc->seeded_hash_fn = NULL;
+	desc->max_probe_length = 0;
+}
+
+void genc_linear_probing_hash_table_desc_init_inline_key(
+	genc_linear_probing_hash_table_desc_t* desc,
+	genc_key_hash_fn hash_fn,
+	genc_realloc_fn realloc_fn,
+	size_t bucket_size, /* bytes per item */
+	size_t key_offset,
+	size_t key_size,
+	const void* empty_key,
+	uint8_t load_percent_grow_threshold,
+	uint8_t load_percent_shrink_threshold)
+{
+	genc_linear_probing_hash_table_desc_init(
+		desc, hash_fn, NULL, NULL, NULL, NULL, realloc_fn,
+		bucket_size, load_percent_grow_threshold, load_percent_shrink_threshold);
+	desc->key_offset = key_offset;
+	desc->key_size = key_size;
+	desc->empty_key = empty_key;
 }
 
 /* Returns the current number of items in the hash table. */
@@ -156,10 +344,14 @@ void genc_lpht_destroy(struct genc_linear_probing_hash_table* table)
 }
 void genc_lphtl_destroy(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
 {
+	if (table->old_buckets)
+		lpht_free_old_buckets(table, desc, opaque);
 	if (table->buckets)
 	{
 		desc->realloc_fn(table->buckets, table->capacity * desc->bucket_size, 0, opaque);
+		free_hashes(desc, table->hashes, table->capacity, opaque);
 		table->buckets = NULL;
+		table->hashes = NULL;
 		table->capacity = 0;
 		table->item_count = 0;
 	}
@@ -168,16 +360,203 @@ void genc_lphtl_destroy(genc_linear_probing_hash_table_light_t* table, const gen
 void genc_lphtl_zero(genc_linear_probing_hash_table_light_t* table)
 {
 	table->buckets = NULL;
+	table->hashes = NULL;
 	table->capacity = table->item_count = 0;
+	table->old_buckets = NULL;
+	table->old_hashes = NULL;
+	table->old_capacity = table->migrate_start = table->migrated = 0;
+	table->seed = 0;
+	table->reseed_count = table->probe_length_limit = 0;
+#if GENC_HASH_TABLE_STATS
+	memset(&table->stats, 0, sizeof(table->stats));
+#endif
+}
+
+/* Probe loop for inline-key descriptors: no callbacks except for the hash. */
+static void* genc_lphtl_find_or_empty_inline(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	genc_hash_t start_idx, void* key, bool* out_found)
+{
+	const size_t bucket_size = desc->bucket_size;
+	const size_t key_size = desc->key_size;
+	const size_t mask = table->capacity - 1ul;
+	char* const key_base = GENC_CXX_CAST(char*, table->buckets) + desc->key_offset;
+	genc_hash_t idx = start_idx;
+	
+	*out_found = false;
+	if (key_size == sizeof(uint64_t))
+	{
+		/* the common case gets its own loop with everything in registers */
+		uint64_t search_key, empty_key;
+		memcpy(&search_key, key, sizeof(search_key));
+		memcpy(&empty_key, desc->empty_key, sizeof(empty_key));
+		do
+		{
+			uint64_t bucket_key;
+			memcpy(&bucket_key, key_base + bucket_size * idx, sizeof(bucket_key));
+			if (bucket_key == empty_key)
+				return key_base + bucket_size * idx - desc->key_offset;
+			if (bucket_key == search_key)
+			{
+				*out_found = true;
+				return key_base + bucket_size * idx - desc->key_offset;
+			}
+			idx = (idx + 1) & mask;
+		} while (idx != start_idx);
+		return NULL;
+	}
+	
+	do
+	{
+		char* bucket_key = key_base + bucket_size * idx;
+		if (lpht_inline_keys_equal(bucket_key, desc->empty_key, key_size))
+			return bucket_key - desc->key_offset;
+		if (lpht_inline_keys_equal(bucket_key, key, key_size))
+		{
+			*out_found = true;
+			return bucket_key - desc->key_offset;
+		}
+		idx = (idx + 1) & mask;
+	} while (idx != start_idx);
+	return NULL;
+}
+
+/* Probe loop for tables with a hash array: only buckets with matching hashes
+ * are ever touched. */
+static void* genc_lphtl_find_or_empty_hashed(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* key, genc_hash_t hash, bool* out_found)
+{
+	const size_t mask = table->capacity - 1ul;
+	const genc_hash_t* const hashes = table->hashes;
+	const genc_hash_t tagged_hash = hash | LPHT_HASH_OCCUPIED;
+	genc_hash_t start_idx = hash & mask;
+	genc_hash_t idx = start_idx;
+	
+	*out_found = false;
+	do
+	{
+		genc_hash_t bucket_hash = hashes[idx];
+		if (bucket_hash == 0)
+			return lpht_bucket_at(desc, table->buckets, idx);
+		if (bucket_hash == tagged_hash)
+		{
+			char* bucket = lpht_bucket_at(desc, table->buckets, idx);
+			if (lpht_keys_equal(desc, lpht_item_key(desc, bucket, opaque), key, opaque))
+			{
+				*out_found = true;
+				return bucket;
+			}
+		}
+		idx = (idx + 1) & mask;
+	} while (idx != start_idx);
+	return NULL;
+}
+
+/* Distance of bucket idx from the home bucket of the given hash */
+static GENC_INLINE size_t lpht_probe_distance(genc_hash_t hash, genc_hash_t idx, size_t mask)
+{
+	return (idx - hash) & mask;
+}
+
+/* For statistics: number of buckets probed beyond the home bucket to arrive at
+ * bucket (NULL if the probe went all the way round the table) */
+static GENC_INLINE size_t lpht_probe_length(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	void* bucket, genc_hash_t hash)
+{
+	if (!bucket)
+		return table->capacity;
+	return lpht_probe_distance(hash, lpht_bucket_index(table, desc, bucket), table->capacity - 1);
+}
+
+/* For statistics: bytes copied when moving an item to another bucket */
+static GENC_INLINE size_t lpht_item_move_bytes(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc)
+{
+	return desc->bucket_size + (table->hashes ? sizeof(genc_hash_t) : 0);
+}
+
+/* Probe loop for Robin Hood tables. Stops at the matching bucket, or at the
+ * bucket where an item with the key would be inserted: either an empty one,
+ * or the first one whose resident is closer to its home bucket than we are to
+ * ours (in which case the key can't be further along). Robin Hood tables
+ * always store hashes, so residents' hashes are compared before their keys. */
+static void* genc_lphtl_find_or_slot_robin_hood(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* key, genc_hash_t hash, bool* out_found)
+{
+	const size_t mask = table->capacity - 1ul;
+	const genc_hash_t tagged_hash = hash | LPHT_HASH_OCCUPIED;
+	genc_hash_t idx = hash & mask;
+	size_t dist;
+	
+	*out_found = false;
+	for (dist = 0; dist <= mask; ++dist, idx = (idx + 1) & mask)
+	{
+		char* bucket = lpht_bucket_at(desc, table->buckets, idx);
+		genc_hash_t resident_hash;
+		if (lpht_bucket_is_empty(table, desc, opaque, idx))
+			return bucket;
+		resident_hash = lpht_bucket_hash(table, desc, opaque, idx);
+		if (lpht_probe_distance(resident_hash, idx, mask) < dist)
+			return bucket;
+		if (resident_hash == tagged_hash
+			&& lpht_keys_equal(desc, lpht_item_key(desc, bucket, opaque), key, opaque))
+		{
+			*out_found = true;
+			return bucket;
+		}
+	}
+	return NULL;
+}
+
+/* Robin Hood insertion into the bucket at idx: if occupied, shifts the run of
+ * items starting at idx back by one bucket, up to the next empty one. Shifting
+ * the whole run is equivalent to the classic swap-as-you-go displacement, as
+ * each item in the run is at least as far from home as the next one minus 1.
+ * Returns false if the table is full. */
+static bool lpht_robin_hood_make_room(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t idx)
+{
+	const size_t mask = table->capacity - 1ul;
+	genc_hash_t empty_idx;
+	if (lpht_bucket_is_empty(table, desc, opaque, idx))
+		return true;
+	empty_idx = (idx + 1) & mask;
+	while (!lpht_bucket_is_empty(table, desc, opaque, empty_idx))
+	{
+		if (empty_idx == idx)
+			return false;
+		empty_idx = (empty_idx + 1) & mask;
+	}
+	while (empty_idx != idx)
+	{
+		genc_hash_t prev_idx = (empty_idx - 1) & mask;
+		memcpy(lpht_bucket_at(desc, table->buckets, empty_idx), lpht_bucket_at(desc, table->buckets, prev_idx), desc->bucket_size);
+		if (table->hashes)
+			table->hashes[empty_idx] = table->hashes[prev_idx];
+		empty_idx = prev_idx;
+	}
+	return true;
 }
 
 /* locates the bucket which either matches key or which we can insert an item
- * with that key into */
+ * with that key into. In Robin Hood mode, the latter may still be occupied,
+ * see lpht_robin_hood_make_room. */
 static void* genc_lphtl_find_or_empty(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
-	void* key, bool* out_found)
+	void* key, genc_hash_t hash, bool* out_found)
 {
-	genc_hash_t start_idx = genc_lphtl_get_bucket_for_key(table, desc, opaque, key);
+	genc_hash_t start_idx = hash & (table->capacity - 1ul);
+	
+	if (desc->flags & GENC_LPHT_ROBIN_HOOD)
+		return genc_lphtl_find_or_slot_robin_hood(table, desc, opaque, key, hash, out_found);
+	if (table->hashes)
+		return genc_lphtl_find_or_empty_hashed(table, desc, opaque, key, hash, out_found);
+	if (desc->key_size)
+		return genc_lphtl_find_or_empty_inline(table, desc, start_idx, key, out_found);
 	
 	*out_found = false;
 	genc_hash_t idx = start_idx;
@@ -204,34 +583,51 @@ static void* genc_lphtl_find_or_empty(
 	return NULL; // edge case: table is at full capacity and doesn't contain item with key
 }
 
-// pure insertion, without the bookkeeping
-static void* genc_lphtl_insert_item_into_table(
-	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque, void* item)
+// writes the item into the given (empty or matching) bucket, and its hash into the hash array
+static GENC_INLINE void lpht_store_item(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	void* bucket, void* item, genc_hash_t hash)
 {
-	void* item_key = desc->get_key_fn(item, opaque);
+	if (bucket != item)
+		memcpy(bucket, item, desc->bucket_size);
+	if (table->hashes)
+		table->hashes[lpht_bucket_index(table, desc, bucket)] = hash | LPHT_HASH_OCCUPIED;
+}
+
+// pure insertion of an item with known hash, without the bookkeeping
+static void* genc_lphtl_insert_hashed_item_into_table(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque, void* item, genc_hash_t hash)
+{
+	void* item_key = lpht_item_key(desc, item, opaque);
 	bool found = false;
-	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, item_key, &found);
+	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, item_key, hash, &found);
 	
 	if (!bucket || found)
 		return NULL; // table is full, or item exists
+	if ((desc->flags & GENC_LPHT_ROBIN_HOOD)
+		&& !lpht_robin_hood_make_room(table, desc, opaque, lpht_bucket_index(table, desc, bucket)))
+		return NULL;
 	
 	// insert the item
-	memcpy(bucket, item, desc->bucket_size);
+	lpht_store_item(table, desc, bucket, item, hash);
 	return bucket;
 }
 
 // pure insertion/replacement, without the bookkeeping
 static void* genc_lphtl_insert_or_replace_item_in_table(
-	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque, void* item, genc_bool_t* out_replaced_existing)
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque, void* item, genc_hash_t hash, genc_bool_t* out_replaced_existing)
 {
-	void* item_key = desc->get_key_fn(item, opaque);
-	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, item_key, out_replaced_existing);
+	void* item_key = lpht_item_key(desc, item, opaque);
+	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, item_key, hash, out_replaced_existing);
 	
 	if (!bucket)
 		return NULL; // table is full
+	if (!*out_replaced_existing && (desc->flags & GENC_LPHT_ROBIN_HOOD)
+		&& !lpht_robin_hood_make_room(table, desc, opaque, lpht_bucket_index(table, desc, bucket)))
+		return NULL;
 	
 	// insert/replace the item
-	memcpy(bucket, item, desc->bucket_size);
+	lpht_store_item(table, desc, bucket, item, hash);
 	return bucket;
 }
 
@@ -269,6 +665,15 @@ bool genc_lphtl_reserve_space(
 	return true;
 }
 
+static void lpht_migrate_step(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
+static void* lpht_old_find(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* key, genc_hash_t hash);
+static void* lpht_guard_probe_length(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* item, void* bucket, genc_hash_t hash);
+
 void* genc_lphtl_insert_item(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* item)
@@ -276,12 +681,28 @@ void* genc_lphtl_insert_item(
 	if (!item) return NULL;
 	
 	genc_lphtl_reserve_space(table, desc, opaque, table->item_count + 1);
+	lpht_migrate_step(table, desc, opaque);
 	
-	void* inserted = genc_lphtl_insert_item_into_table(table, desc, opaque, item);
+	genc_hash_t hash = lpht_hash_key(table, desc, lpht_item_key(desc, item, opaque), opaque);
+	GENC_HASH_STATS_INC(table->stats, inserts);
+	if (table->old_buckets && lpht_old_find(table, desc, opaque, lpht_item_key(desc, item, opaque), hash))
+	{
+		GENC_HASH_STATS_INC(table->stats, insert_duplicates);
+		return NULL; // exists in the array we're migrating from
+	}
+	void* inserted = genc_lphtl_insert_hashed_item_into_table(table, desc, opaque, item, hash);
 	if (!inserted)
+	{
+		// unless the table is full, the key must have been found
+		if (table->item_count < table->capacity)
+			GENC_HASH_STATS_INC(table->stats, insert_duplicates);
 		return NULL;
+	}
+	GENC_HASH_STATS_PROBE(table->stats, lpht_probe_length(table, desc, inserted, hash));
 	
 	++table->item_count;
+	if (desc->max_probe_length > 0 && desc->seeded_hash_fn)
+		inserted = lpht_guard_probe_length(table, desc, opaque, item, inserted, hash);
 	return inserted;
 }
 
@@ -292,14 +713,35 @@ void* genc_lphtl_insert_or_update_item(
 	if (!item) return NULL;
 	
 	genc_lphtl_reserve_space(table, desc, opaque, table->item_count + 1);
+	lpht_migrate_step(table, desc, opaque);
 	
+	genc_hash_t hash = lpht_hash_key(table, desc, lpht_item_key(desc, item, opaque), opaque);
+	GENC_HASH_STATS_INC(table->stats, inserts);
+	if (table->old_buckets)
+	{
+		void* old_bucket = lpht_old_find(table, desc, opaque, lpht_item_key(desc, item, opaque), hash);
+		if (old_bucket)
+		{
+			GENC_HASH_STATS_INC(table->stats, insert_duplicates);
+			// update in the old array, the hash doesn't change
+			if (old_bucket != item)
+				memcpy(old_bucket, item, desc->bucket_size);
+			return old_bucket;
+		}
+	}
 	bool updated_existing = false;
-	void* inserted = genc_lphtl_insert_or_replace_item_in_table(table, desc, opaque, item, &updated_existing);
+	void* inserted = genc_lphtl_insert_or_replace_item_in_table(table, desc, opaque, item, hash, &updated_existing);
 	if (!inserted)
 		return NULL;
+	GENC_HASH_STATS_PROBE(table->stats, lpht_probe_length(table, desc, inserted, hash));
+	GENC_HASH_STATS_ADD(table->stats, insert_duplicates, updated_existing);
 	
 	if (!updated_existing)
+	{
 		++table->item_count;
+		if (desc->max_probe_length > 0 && desc->seeded_hash_fn)
+			inserted = lpht_guard_probe_length(table, desc, opaque, item, inserted, hash);
+	}
 	return inserted;
 }
 
@@ -364,8 +806,66 @@ void* genc_lphtl_find(
 	void* key)
 {
 	bool found = false;
-	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, key, &found);
-	return found ? bucket : NULL;
+	genc_hash_t hash = lpht_hash_key(table, desc, key, opaque);
+	void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, key, hash, &found);
+	GENC_HASH_STATS_PROBE(table->stats, lpht_probe_length(table, desc, bucket, hash));
+	if (!found)
+		bucket = table->old_buckets ? lpht_old_find(table, desc, opaque, key, hash) : NULL;
+	GENC_HASH_STATS_INC(table->stats, lookups);
+	GENC_HASH_STATS_ADD(table->stats, lookup_hits, bucket != NULL);
+	return bucket;
+}
+
+/* Number of keys hashed and prefetched ahead of resolving them in batch lookups */
+#define LPHT_BATCH_CHUNK 16
+
+size_t genc_lpht_find_batch(
+	struct genc_linear_probing_hash_table* table, void* const* keys, void** out_items, size_t count)
+{
+	return genc_lphtl_find_batch(&table->table, &table->desc, table->opaque, keys, out_items, count);
+}
+size_t genc_lphtl_find_batch(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* const* keys, void** out_items, size_t count)
+{
+	genc_hash_t hashes[LPHT_BATCH_CHUNK];
+	const size_t mask = table->capacity - 1ul;
+	size_t found_count = 0;
+	size_t start, i;
+	
+	for (start = 0; start < count; start += LPHT_BATCH_CHUNK)
+	{
+		size_t chunk = count - start;
+		if (chunk > LPHT_BATCH_CHUNK)
+			chunk = LPHT_BATCH_CHUNK;
+		
+		// hash the whole chunk and request the home buckets
+		for (i = 0; i < chunk; ++i)
+		{
+			genc_hash_t idx;
+			hashes[i] = lpht_hash_key(table, desc, keys[start + i], opaque);
+			idx = hashes[i] & mask;
+			if (table->hashes)
+				GENC_PREFETCH(table->hashes + idx);
+			else
+				GENC_PREFETCH(lpht_bucket_at(desc, table->buckets, idx) + desc->key_offset);
+		}
+		// by now, the first buckets should be arriving in cache
+		for (i = 0; i < chunk; ++i)
+		{
+			bool found = false;
+			void* bucket = genc_lphtl_find_or_empty(table, desc, opaque, keys[start + i], hashes[i], &found);
+			GENC_HASH_STATS_PROBE(table->stats, lpht_probe_length(table, desc, bucket, hashes[i]));
+			if (!found)
+				bucket = table->old_buckets ? lpht_old_find(table, desc, opaque, keys[start + i], hashes[i]) : NULL;
+			out_items[start + i] = bucket;
+			if (bucket)
+				++found_count;
+		}
+	}
+	GENC_HASH_STATS_ADD(table->stats, lookups, count);
+	GENC_HASH_STATS_ADD(table->stats, lookup_hits, found_count);
+	return found_count;
 }
 
 /* Hashes the key and returns the bucket into which the key falls */
@@ -378,7 +878,7 @@ genc_hash_t genc_lphtl_get_bucket_for_key(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* key)
 {
-	genc_hash_t hash = desc->hash_fn(key, opaque);
+	genc_hash_t hash = lpht_hash_key(table, desc, key, opaque);
 	hash &= (table->capacity - 1ul);
 	return hash;
 }
@@ -394,6 +894,193 @@ static GENC_INLINE genc_bool_t idx_between(
 	return idx_delta <= start_delta;
 }
 
+static GENC_INLINE void lpht_clear_bucket(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t idx)
+{
+	lpht_item_clear(desc, lpht_bucket_at(desc, table->buckets, idx), opaque);
+	if (table->hashes)
+		table->hashes[idx] = 0;
+}
+
+/* Moves the item in bucket from_idx to the empty bucket to_idx */
+static GENC_INLINE void lpht_move_bucket(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t to_idx, genc_hash_t from_idx)
+{
+	memcpy(lpht_bucket_at(desc, table->buckets, to_idx), lpht_bucket_at(desc, table->buckets, from_idx), desc->bucket_size);
+	if (table->hashes)
+		table->hashes[to_idx] = table->hashes[from_idx];
+	lpht_clear_bucket(table, desc, opaque, from_idx);
+}
+
+/* Bucket empty_idx has just been vacated. Moves up any displaced items
+ * following it which would otherwise become unreachable. */
+static void lpht_close_gap(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t empty_idx)
+{
+	const size_t mask = table->capacity - 1;
+	genc_hash_t idx = (empty_idx + 1) & mask;
+	/* all consecutive non-empty buckets are reachable, so keep going until we
+	 * find an empty one. */
+	while (!lpht_bucket_is_empty(table, desc, opaque, idx))
+	{
+		/* If current item is not reachable from its true slot, we need to move it
+		 * into the empty one */
+		genc_hash_t key_bucket_idx = lpht_bucket_hash(table, desc, opaque, idx) & mask;
+		if (idx_between(empty_idx, key_bucket_idx, idx, table->capacity))
+		{
+			lpht_move_bucket(table, desc, opaque, empty_idx, idx);
+			empty_idx = idx;
+		}
+		idx = (idx + 1) & mask;
+	}
+}
+
+/* Incremental resizing */
+
+/* Table view of the old bucket array, so the usual helpers can operate on it */
+static GENC_INLINE genc_linear_probing_hash_table_light_t lpht_old_view(genc_linear_probing_hash_table_light_t* table)
+{
+	genc_linear_probing_hash_table_light_t old;
+	genc_lphtl_zero(&old);
+	old.capacity = table->old_capacity;
+	old.buckets = table->old_buckets;
+	old.hashes = table->old_hashes;
+	old.seed = table->seed;
+	return old;
+}
+
+static GENC_INLINE genc_bool_t lpht_is_old_bucket(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* bucket)
+{
+	uintptr_t start = (uintptr_t)table->old_buckets;
+	return table->old_buckets != NULL
+		&& (uintptr_t)bucket >= start && (uintptr_t)bucket < start + table->old_capacity * desc->bucket_size;
+}
+
+/* Looks up the key in the old bucket array. Migration empties buckets in
+ * order, which may have cut off the front of the cluster containing the key.
+ * If the key's home bucket has been migrated, the rest of the cluster
+ * therefore starts at the migration cursor. */
+static void* lpht_old_find(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* key, genc_hash_t hash)
+{
+	genc_linear_probing_hash_table_light_t old = lpht_old_view(table);
+	const size_t mask = old.capacity - 1;
+	const genc_hash_t tagged_hash = hash | LPHT_HASH_OCCUPIED;
+	genc_hash_t idx = hash & mask;
+	size_t probed;
+	
+	if (((idx - table->migrate_start) & mask) < table->migrated)
+		idx = (table->migrate_start + table->migrated) & mask;
+	for (probed = 0; probed < old.capacity; ++probed, idx = (idx + 1) & mask)
+	{
+		char* bucket;
+		if (lpht_bucket_is_empty(&old, desc, opaque, idx))
+			return NULL;
+		if (old.hashes && old.hashes[idx] != tagged_hash)
+			continue;
+		bucket = lpht_bucket_at(desc, old.buckets, idx);
+		if (lpht_keys_equal(desc, lpht_item_key(desc, bucket, opaque), key, opaque))
+			return bucket;
+	}
+	return NULL;
+}
+
+static void lpht_free_old_buckets(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	desc->realloc_fn(table->old_buckets, table->old_capacity * desc->bucket_size, 0, opaque);
+	free_hashes(desc, table->old_hashes, table->old_capacity, opaque);
+	table->old_buckets = NULL;
+	table->old_hashes = NULL;
+	table->old_capacity = 0;
+	table->migrate_start = 0;
+	table->migrated = 0;
+}
+
+/* Moves the items in the next count old buckets into the new array. */
+static void lpht_migrate_buckets(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	size_t count)
+{
+	genc_linear_probing_hash_table_light_t old = lpht_old_view(table);
+	const size_t mask = old.capacity - 1;
+	for (; count > 0 && table->migrated < old.capacity; --count, ++table->migrated)
+	{
+		genc_hash_t idx = (table->migrate_start + table->migrated) & mask;
+		if (lpht_bucket_is_empty(&old, desc, opaque, idx))
+			continue;
+		// the new array was sized to hold all items, so this can't fail
+		genc_lphtl_insert_hashed_item_into_table(
+			table, desc, opaque, lpht_bucket_at(desc, old.buckets, idx), lpht_bucket_hash(&old, desc, opaque, idx));
+		GENC_HASH_STATS_INC(table->stats, items_moved);
+		GENC_HASH_STATS_ADD(table->stats, bytes_moved, lpht_item_move_bytes(table, desc));
+		// deliberately no lpht_close_gap(): the rest of the cluster stays put
+		lpht_clear_bucket(&old, desc, opaque, idx);
+	}
+	if (table->migrated >= old.capacity)
+		lpht_free_old_buckets(table, desc, opaque);
+}
+
+static void lpht_migrate_step(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	if (table->old_buckets)
+		lpht_migrate_buckets(table, desc, opaque, desc->migrate_buckets_per_op ? desc->migrate_buckets_per_op : SIZE_MAX);
+}
+
+genc_bool_t genc_lpht_is_resizing(struct genc_linear_probing_hash_table* table)
+{
+	return genc_lphtl_is_resizing(&table->table);
+}
+genc_bool_t genc_lphtl_is_resizing(genc_linear_probing_hash_table_light_t* table)
+{
+	return table->old_buckets != NULL;
+}
+
+genc_bool_t genc_lpht_resize_step(struct genc_linear_probing_hash_table* table)
+{
+	return genc_lphtl_resize_step(&table->table, &table->desc, table->opaque);
+}
+genc_bool_t genc_lphtl_resize_step(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	lpht_migrate_step(table, desc, opaque);
+	return table->old_buckets != NULL;
+}
+
+void genc_lpht_complete_resize(struct genc_linear_probing_hash_table* table)
+{
+	genc_lphtl_complete_resize(&table->table, &table->desc, table->opaque);
+}
+void genc_lphtl_complete_resize(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	if (table->old_buckets)
+		lpht_migrate_buckets(table, desc, opaque, SIZE_MAX);
+}
+
+/* Robin Hood version of lpht_close_gap: the following items are shifted back
+ * until we reach an empty bucket or one whose item is in its home bucket. */
+static void lpht_close_gap_robin_hood(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t empty_idx)
+{
+	const size_t mask = table->capacity - 1;
+	genc_hash_t idx = (empty_idx + 1) & mask;
+	while (!lpht_bucket_is_empty(table, desc, opaque, idx)
+		&& lpht_probe_distance(lpht_bucket_hash(table, desc, opaque, idx), idx, mask) > 0)
+	{
+		lpht_move_bucket(table, desc, opaque, empty_idx, idx);
+		empty_idx = idx;
+		idx = (idx + 1) & mask;
+	}
+}
+
 /* Removes the item from the hash table.
  * Deallocation, like allocation, is the responsibility of the caller.
  */
@@ -401,117 +1088,281 @@ void genc_lpht_remove(struct genc_linear_probing_hash_table* table, void* item)
 {
 	genc_lphtl_remove(&table->table, &table->desc, table->opaque, item);
 }
+/* Empties bucket idx of the current array, moving up any displaced items
+ * which would now be unreachable. Doesn't touch the item count. */
+static void lpht_remove_at(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_t idx)
+{
+	lpht_clear_bucket(table, desc, opaque, idx);
+	if (desc->flags & GENC_LPHT_ROBIN_HOOD)
+		lpht_close_gap_robin_hood(table, desc, opaque, idx);
+	else
+		lpht_close_gap(table, desc, opaque, idx);
+}
+
+static void lpht_shrink_if_underloaded(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	unsigned new_load = 0;
+	if (table->capacity > 0)
+		new_load = (unsigned)(100ull * (table->item_count) / table->capacity);
+
+	if (new_load > 0 && new_load < desc->load_percent_shrink_threshold)
+	{
+		int factor_log2 = genc_log2_size(desc->load_percent_shrink_threshold / new_load);
+		genc_lphtl_shrink_by(table, desc, opaque, factor_log2);
+	}
+}
+
 void genc_lphtl_remove(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* item)
 {
-	if (item && !desc->item_empty_fn(item, opaque))
+	if (item && !lpht_item_is_empty(desc, item, opaque))
 	{
-		desc->item_clear_fn(item, opaque);
-		--table->item_count;
-		
-		const size_t bucket_size = desc->bucket_size;
-		genc_item_clear_fn item_clear_fn = desc->item_clear_fn;
-		genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
-		const genc_hash_get_item_key_fn get_key_fn = desc->get_key_fn;
-		
-		// need to move up any displaced items which would now be unreachable
-		char* buckets = GENC_CXX_CAST(char*, table->buckets);
-		char* empty_bucket = GENC_CXX_CAST(char*, item);
-		genc_hash_t start_idx = (empty_bucket - buckets) / bucket_size;
-		genc_hash_t empty_idx = start_idx;
-		genc_hash_t idx = (start_idx + 1) & (table->capacity - 1);
-		/* all consecutive non-empty buckets are reachable, so keep going until we
-		 * find an empty one. */
-		char* bucket = buckets + idx * bucket_size;
-		while (!item_empty_fn(bucket, opaque))
+		if (lpht_is_old_bucket(table, desc, item))
 		{
-			/* If current item is not reachable from its true slot, we need to move it
-			 * into the empty one */
-			void* item_key = get_key_fn(bucket, opaque);
-			genc_hash_t key_bucket_idx = genc_lphtl_get_bucket_for_key(table, desc, opaque, item_key);
-			if (idx_between(empty_idx, key_bucket_idx, idx, table->capacity))
-			{
-				memcpy(empty_bucket, bucket, bucket_size);
-				item_clear_fn(bucket, opaque);
-				empty_idx = idx;
-				empty_bucket = bucket;
-			}
-			
-			++idx;
-			idx &= (table->capacity - 1);
-			bucket = buckets + idx * bucket_size;
+			// migrated buckets are empty, so the gap never spans the migration cursor
+			genc_linear_probing_hash_table_light_t old = lpht_old_view(table);
+			genc_hash_t empty_idx = lpht_bucket_index(&old, desc, item);
+			lpht_clear_bucket(&old, desc, opaque, empty_idx);
+			lpht_close_gap(&old, desc, opaque, empty_idx);
 		}
+		else
+		{
+			lpht_remove_at(table, desc, opaque, lpht_bucket_index(table, desc, item));
+		}
+		--table->item_count;
+		GENC_HASH_STATS_INC(table->stats, removes);
+		lpht_migrate_step(table, desc, opaque);
 
 		// shrink if necessary
-		unsigned new_load = 0;
-		if (table->capacity > 0)
-			new_load = (unsigned)(100ull * (table->item_count) / table->capacity);
+		lpht_shrink_if_underloaded(table, desc, opaque);
+	}
+}
 
-		if (new_load > 0 && new_load < desc->load_percent_shrink_threshold)
-		{
-			int factor_log2 = genc_log2_size(desc->load_percent_shrink_threshold / new_load);
-			genc_lphtl_shrink_by(table, desc, opaque, factor_log2);
-		}
+/* Index of the first empty bucket, or the capacity if the table is full */
+static genc_hash_t lpht_find_empty_bucket(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	genc_hash_t idx;
+	for (idx = 0; idx < table->capacity; ++idx)
+	{
+		if (lpht_bucket_is_empty(table, desc, opaque, idx))
+			break;
 	}
+	return idx;
 }
 
-/* Shrink the capacity of the table by a factor of 1 << log2_shrink_factor */
-bool genc_lpht_shrink_by(struct genc_linear_probing_hash_table* table, unsigned log2_shrink_factor)
+size_t genc_lpht_remove_if(struct genc_linear_probing_hash_table* table, genc_lpht_item_pred_fn pred, void* pred_data)
 {
-	return genc_lphtl_shrink_by(&table->table, &table->desc, table->opaque, log2_shrink_factor);
+	return genc_lphtl_remove_if(&table->table, &table->desc, table->opaque, pred, pred_data);
 }
-bool genc_lphtl_shrink_by(
-	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void*const opaque,
-	unsigned log2_shrink_factor)
+
+size_t genc_lphtl_remove_if(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_lpht_item_pred_fn pred, void* pred_data)
 {
-	const size_t old_capacity = table->capacity;
-	// don't shrink it down so far that the contents no longer fits
-	while (table->item_count > (old_capacity >> log2_shrink_factor))
+	size_t removed = 0, mask, swept;
+	genc_hash_t start, idx;
+	genc_bool_t cluster_has_gap = 0;
+	
+	if (table->item_count == 0)
+		return 0;
+	genc_lphtl_complete_resize(table, desc, opaque);
+	mask = table->capacity - 1;
+	
+	/* The sweep starts after an empty bucket, so no cluster straddles it */
+	start = lpht_find_empty_bucket(table, desc, opaque);
+	if (start >= table->capacity)
 	{
-		if (log2_shrink_factor < 1)
-			return false;
-		--log2_shrink_factor;
+		/* Completely full: make a gap by removing the first match the usual way.
+		 * (The sweep will then test the items before it again.) */
+		for (idx = 0; idx < table->capacity; ++idx)
+		{
+			if (pred(lpht_bucket_at(desc, table->buckets, idx), pred_data))
+				break;
+		}
+		if (idx >= table->capacity)
+			return 0;
+		lpht_remove_at(table, desc, opaque, idx);
+		removed = 1;
+		start = lpht_find_empty_bucket(table, desc, opaque);
 	}
 	
-	const size_t bucket_size = desc->bucket_size;
+	for (swept = 1, idx = (start + 1) & mask; swept < table->capacity; ++swept, idx = (idx + 1) & mask)
+	{
+		genc_hash_t target;
+		if (lpht_bucket_is_empty(table, desc, opaque, idx))
+		{
+			cluster_has_gap = 0;
+			continue;
+		}
+		if (pred(lpht_bucket_at(desc, table->buckets, idx), pred_data))
+		{
+			lpht_clear_bucket(table, desc, opaque, idx);
+			cluster_has_gap = 1;
+			++removed;
+			continue;
+		}
+		if (!cluster_has_gap)
+			continue;
+		/* A survivor after a removal in its cluster moves back to the first
+		 * free bucket at or after its home. All buckets from its home up to
+		 * here have been swept already, and will stay occupied once filled,
+		 * so the item stays reachable and (in Robin Hood tables) the items
+		 * remain ordered by home bucket. */
+		target = lpht_bucket_hash(table, desc, opaque, idx) & mask;
+		while (target != idx && !lpht_bucket_is_empty(table, desc, opaque, target))
+			target = (target + 1) & mask;
+		if (target != idx)
+			lpht_move_bucket(table, desc, opaque, target, idx);
+	}
 	
-	// TODO: resize in-place
-	const size_t new_capacity = old_capacity >> log2_shrink_factor;
+	table->item_count -= removed;
+	GENC_HASH_STATS_ADD(table->stats, removes, removed);
+	lpht_shrink_if_underloaded(table, desc, opaque);
+	return removed;
+}
+
+/* Moves all items into newly allocated arrays with the given capacity,
+ * recomputing their hashes if rehash is set (after a change of seed), and
+ * otherwise reusing any stored ones. On failure, the table is left unchanged. */
+static bool lpht_rebuild(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque,
+	size_t new_capacity, genc_bool_t rehash)
+{
+	const size_t old_capacity = table->capacity;
+	const size_t bucket_size = desc->bucket_size;
+	const genc_realloc_fn realloc_fn = desc->realloc_fn;
+	genc_hash_t* new_hashes = NULL;
 	
 	// alloc new bucket array
-	const genc_realloc_fn realloc_fn = desc->realloc_fn;
+	if (table->hashes)
+	{
+		new_hashes = alloc_empty_hashes(desc, new_capacity, opaque);
+		if (!new_hashes)
+			return false;
+	}
 	char* new_buckets = GENC_CXX_CAST(
-		char*, alloc_empty_buckets(realloc_fn, desc->item_clear_fn, new_capacity, bucket_size, opaque));
+		char*, alloc_empty_buckets(desc, new_capacity, opaque));
 	if (!new_buckets)
+	{
+		free_hashes(desc, new_hashes, new_capacity, opaque);
 		return false;
+	}
 	
 	// re-insert items into new buckets
-	char* old_buckets = GENC_CXX_CAST(char*, table->buckets);
+	genc_linear_probing_hash_table_light_t old_table = *table;
 	table->buckets = new_buckets;
+	table->hashes = new_hashes;
 	table->capacity = new_capacity;
 	
-	const genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
-	char* old_bucket = old_buckets;
+	char* old_bucket = GENC_CXX_CAST(char*, old_table.buckets);
 	for (genc_hash_t idx = 0; idx < old_capacity; ++idx, old_bucket += bucket_size)
 	{
-		if (!item_empty_fn(old_bucket, opaque)
-		    && !genc_lphtl_insert_item_into_table(table, desc, opaque, old_bucket))
+		if (!lpht_bucket_is_empty(&old_table, desc, opaque, idx)
+		    && !genc_lphtl_insert_hashed_item_into_table(
+		       table, desc, opaque, old_bucket,
+		       rehash
+		       ? lpht_hash_key(table, desc, lpht_item_key(desc, old_bucket, opaque), opaque)
+		       : lpht_bucket_hash(&old_table, desc, opaque, idx)))
 		{
 			// failed to move item across, give up
-			table->buckets = old_buckets;
-			table->capacity = old_capacity;
+			*table = old_table;
 			realloc_fn(
 				new_buckets, new_capacity * bucket_size, 0, opaque);
+			free_hashes(desc, new_hashes, new_capacity, opaque);
 			return false;
 		}
 	}
 	
 	realloc_fn(
-		old_buckets, old_capacity * bucket_size, 0, opaque);
+		old_table.buckets, old_capacity * bucket_size, 0, opaque);
+	free_hashes(desc, old_table.hashes, old_capacity, opaque);
+	if (rehash)
+		GENC_HASH_STATS_INC(table->stats, rehashes);
+	else
+		GENC_HASH_STATS_INC(table->stats, resizes);
+	GENC_HASH_STATS_ADD(table->stats, items_moved, table->item_count);
+	GENC_HASH_STATS_ADD(table->stats, bytes_moved, table->item_count * lpht_item_move_bytes(table, desc));
 	return true;
 }
 
+/* Switches to a new bucket array of the given capacity, leaving the items
+ * in the old one to be migrated incrementally. */
+static bool lpht_begin_migration(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque,
+	size_t new_capacity)
+{
+	genc_hash_t start_idx;
+	genc_hash_t* new_hashes = NULL;
+	void* new_buckets;
+	
+	/* Migration must begin at an empty bucket, so no cluster straddles the
+	 * starting point. A completely full table has none, so rebuild it. */
+	start_idx = lpht_find_empty_bucket(table, desc, opaque);
+	if (start_idx >= table->capacity)
+		return lpht_rebuild(table, desc, opaque, new_capacity, false);
+	
+	if (table->hashes)
+	{
+		new_hashes = alloc_empty_hashes(desc, new_capacity, opaque);
+		if (!new_hashes)
+			return false;
+	}
+	new_buckets = alloc_empty_buckets(desc, new_capacity, opaque);
+	if (!new_buckets)
+	{
+		free_hashes(desc, new_hashes, new_capacity, opaque);
+		return false;
+	}
+	
+	table->old_buckets = table->buckets;
+	table->old_hashes = table->hashes;
+	table->old_capacity = table->capacity;
+	table->migrate_start = start_idx;
+	table->migrated = 0;
+	table->buckets = new_buckets;
+	table->hashes = new_hashes;
+	table->capacity = new_capacity;
+	GENC_HASH_STATS_INC(table->stats, resizes);
+	return true;
+}
+
+static GENC_INLINE bool lpht_resizes_incrementally(const genc_linear_probing_hash_table_desc_t* desc)
+{
+	return desc->migrate_buckets_per_op > 0 && !(desc->flags & GENC_LPHT_ROBIN_HOOD);
+}
+
+/* Shrink the capacity of the table by a factor of 1 << log2_shrink_factor */
+bool genc_lpht_shrink_by(struct genc_linear_probing_hash_table* table, unsigned log2_shrink_factor)
+{
+	return genc_lphtl_shrink_by(&table->table, &table->desc, table->opaque, log2_shrink_factor);
+}
+bool genc_lphtl_shrink_by(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void*const opaque,
+	unsigned log2_shrink_factor)
+{
+	genc_lphtl_complete_resize(table, desc, opaque);
+	const size_t old_capacity = table->capacity;
+	// don't shrink it down so far that the contents no longer fits
+	while (table->item_count > (old_capacity >> log2_shrink_factor))
+	{
+		if (log2_shrink_factor < 1)
+			return false;
+		--log2_shrink_factor;
+	}
+	
+	if (log2_shrink_factor == 0)
+		return true;
+	if (lpht_resizes_incrementally(desc))
+		return lpht_begin_migration(table, desc, opaque, old_capacity >> log2_shrink_factor);
+	// TODO: resize in-place
+	return lpht_rebuild(table, desc, opaque, old_capacity >> log2_shrink_factor, false);
+}
+
 /* Grow the capacity of the table by a factor of 1 << log2_grow_factor */
 bool genc_lpht_grow_by(
 	struct genc_linear_probing_hash_table* table, unsigned log2_grow_factor)
@@ -528,6 +1379,7 @@ bool genc_lphtl_grow_by(
 	 * If it succeeds, we can vacate its original location. */
 	
 	char* buckets = NULL;
+	genc_lphtl_complete_resize(table, desc, opaque);
 	size_t const old_capacity = table->capacity;
 	size_t new_capacity = table->capacity << log2_grow_factor;
 	while (new_capacity < table->capacity)
@@ -538,39 +1390,65 @@ bool genc_lphtl_grow_by(
 	}
 	if (new_capacity <= old_capacity)
 		return false;
+	
+	/* Re-inserting in place could displace items which haven't been visited
+	 * yet into already-visited buckets, so Robin Hood tables are rebuilt. */
+	if (desc->flags & GENC_LPHT_ROBIN_HOOD)
+		return lpht_rebuild(table, desc, opaque, new_capacity, false);
+	if (lpht_resizes_incrementally(desc))
+		return lpht_begin_migration(table, desc, opaque, new_capacity);
 		
 	const size_t bucket_size = desc->bucket_size;
+	genc_hash_t* new_hashes = NULL;
+	
+	if (table->hashes)
+	{
+		/* hashes go into a fresh array, so we can still back out if the bucket realloc fails */
+		new_hashes = alloc_empty_hashes(desc, new_capacity, opaque);
+		if (!new_hashes)
+			return false;
+	}
 
 	buckets = GENC_CXX_CAST(char*, desc->realloc_fn(
 		table->buckets, old_capacity * bucket_size, new_capacity * bucket_size, opaque));
 	if (!buckets)
+	{
+		free_hashes(desc, new_hashes, new_capacity, opaque);
 		return false;
+	}
 	
 	// zero out the newly added buckets
-	const genc_item_clear_fn item_clear_fn = desc->item_clear_fn;
 	for (genc_hash_t idx = old_capacity; idx < new_capacity; ++idx)
 	{
-		item_clear_fn(buckets + idx * bucket_size, opaque);
+		lpht_item_clear(desc, buckets + idx * bucket_size, opaque);
+	}
+	if (new_hashes)
+	{
+		memcpy(new_hashes, table->hashes, old_capacity * sizeof(genc_hash_t));
+		free_hashes(desc, table->hashes, old_capacity, opaque);
+		table->hashes = new_hashes;
 	}
 	
 	table->buckets = buckets;
 	table->capacity = new_capacity;
-	
-	const genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
+	GENC_HASH_STATS_INC(table->stats, resizes);
 	
 	// this is the fun/crazy part:
 	for (genc_hash_t idx = 0; idx < new_capacity; ++idx)
 	{
 		char* bucket = buckets + idx * bucket_size;
-		if (item_empty_fn(buckets + idx * bucket_size, opaque))
+		if (lpht_bucket_is_empty(table, desc, opaque, idx))
 		{
 			if (idx >= old_capacity)
 				break; // no need to keep looking, as anything past the first empty bucket in the new buckets is already new
 		}
-		else if (genc_lphtl_insert_item_into_table(table, desc, opaque, bucket))
+		else if (genc_lphtl_insert_hashed_item_into_table(
+			table, desc, opaque, bucket, lpht_bucket_hash(table, desc, opaque, idx)))
 		{
 			// item was moved
-			item_clear_fn(bucket, opaque);
+			lpht_clear_bucket(table, desc, opaque, idx);
+			GENC_HASH_STATS_INC(table->stats, items_moved);
+			GENC_HASH_STATS_ADD(table->stats, bytes_moved, lpht_item_move_bytes(table, desc));
 		}
 	}
 	return true;
@@ -588,6 +1466,229 @@ bool genc_lpht_resize(struct genc_linear_probing_hash_table* table, size_t new_c
 		return true; // nothing to do (new capacity = old)
 }
 
+bool genc_lpht_set_seed(struct genc_linear_probing_hash_table* table, uint64_t seed)
+{
+	return genc_lphtl_set_seed(&table->table, &table->desc, table->opaque, seed);
+}
+
+bool genc_lphtl_set_seed(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t seed)
+{
+	uint64_t old_seed = table->seed;
+	if (!desc->seeded_hash_fn)
+		return false;
+	genc_lphtl_complete_resize(table, desc, opaque);
+	table->seed = seed;
+	if (table->capacity > 0 && !lpht_rebuild(table, desc, opaque, table->capacity, true))
+	{
+		table->seed = old_seed;
+		return false;
+	}
+	return true;
+}
+
+static size_t lpht_longest_probe(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	size_t idx, longest = 0;
+	const size_t mask = table->capacity - 1;
+	for (idx = 0; idx < table->capacity; ++idx)
+	{
+		if (!lpht_bucket_is_empty(table, desc, opaque, idx))
+		{
+			size_t dist = lpht_probe_distance(lpht_bucket_hash(table, desc, opaque, idx), idx, mask);
+			if (dist > longest)
+				longest = dist;
+		}
+	}
+	return longest;
+}
+
+static GENC_INLINE size_t lpht_probe_length_limit(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc)
+{
+	return table->probe_length_limit > 0 ? table->probe_length_limit : desc->max_probe_length;
+}
+
+/* Rehashes with a new seed after a probe sequence exceeded the limit, raising
+ * the limit if that didn't help. Returns false if the rehash failed. */
+static bool lpht_guard_reseed(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	size_t limit = lpht_probe_length_limit(table, desc);
+	/* Mixing in the table's address means even a known initial seed won't
+	 * predict the new one. */
+	if (!genc_lphtl_set_seed(table, desc, opaque, genc_hash_next_seed(table->seed ^ (uintptr_t)table)))
+		return false;
+	++table->reseed_count;
+	if (lpht_longest_probe(table, desc, opaque) > limit && limit <= SIZE_MAX / 2)
+		table->probe_length_limit = 2 * limit;
+	return true;
+}
+
+/* Checks the probe distance of a newly inserted item, reseeding the table if
+ * it exceeds the limit. Returns the item's bucket, which moves in that case. */
+static void* lpht_guard_probe_length(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* item, void* bucket, genc_hash_t hash)
+{
+	if (lpht_probe_distance(hash, lpht_bucket_index(table, desc, bucket), table->capacity - 1)
+	    <= lpht_probe_length_limit(table, desc))
+		return bucket;
+	if (!lpht_guard_reseed(table, desc, opaque))
+		return bucket;
+	/* the bucket array was replaced (with no resize in progress), but the
+	 * caller's item is still intact */
+	{
+		bool found = false;
+		void* key = lpht_item_key(desc, item, opaque);
+		bucket = genc_lphtl_find_or_empty(table, desc, opaque, key, lpht_hash_key(table, desc, key, opaque), &found);
+		return found ? bucket : NULL;
+	}
+}
+
+/* Bulk loads partition the input by the top LPHT_BULK_RADIX_BITS bits of the
+ * home bucket index. 1024 partitions keep the span of bucket array written by
+ * each partition within the cache for tables of up to ~10^8 buckets. */
+#define LPHT_BULK_RADIX_BITS 10
+/* How many items ahead bulk loads prefetch the (randomly ordered) input */
+#define LPHT_BULK_PREFETCH_DISTANCE 8
+
+size_t genc_lpht_bulk_load(struct genc_linear_probing_hash_table* table, const void* items, size_t count)
+{
+	return genc_lphtl_bulk_load(&table->table, &table->desc, table->opaque, items, count);
+}
+
+/* Fallback for genc_lphtl_bulk_load() */
+static size_t lpht_insert_each(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	const char* item_bytes, size_t count)
+{
+	size_t inserted = 0, i;
+	for (i = 0; i < count; ++i)
+		if (genc_lphtl_insert_item(table, desc, opaque, (void*)(item_bytes + i * desc->bucket_size)))
+			++inserted;
+	return inserted;
+}
+
+size_t genc_lphtl_bulk_load(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	const void* items, size_t count)
+{
+	const size_t bucket_size = desc->bucket_size;
+	const char* const item_bytes = GENC_CXX_CAST(const char*, items);
+	size_t inserted = 0, scratch_size = 0, partitions, shift, mask, i;
+	int capacity_log2;
+	void* scratch = NULL;
+	genc_hash_t* hashes;
+	size_t* order;
+	size_t* part_start;
+	
+	if (count == 0)
+		return 0;
+	// the partitioned insertion relies on there being room for everything, so
+	// if growing fails, insert individually until the table is full
+	if (!genc_lphtl_reserve_space(table, desc, opaque, table->item_count + count))
+		return lpht_insert_each(table, desc, opaque, item_bytes, count);
+	genc_lphtl_complete_resize(table, desc, opaque);
+	
+	capacity_log2 = genc_log2_size(table->capacity);
+	shift = capacity_log2 > LPHT_BULK_RADIX_BITS ? (size_t)(capacity_log2 - LPHT_BULK_RADIX_BITS) : 0;
+	partitions = table->capacity >> shift;
+	mask = table->capacity - 1;
+	
+	// scratch space: hashes in input order, input indices in partition order, partition offsets
+	if (count <= (SIZE_MAX - (partitions + 1) * sizeof(size_t)) / (sizeof(genc_hash_t) + sizeof(size_t)))
+	{
+		scratch_size = count * (sizeof(genc_hash_t) + sizeof(size_t)) + (partitions + 1) * sizeof(size_t);
+		scratch = desc->realloc_fn(NULL, 0, scratch_size, opaque);
+	}
+	if (!scratch)
+		return lpht_insert_each(table, desc, opaque, item_bytes, count);
+	// (individual insertions count themselves)
+	GENC_HASH_STATS_ADD(table->stats, inserts, count);
+	hashes = GENC_CXX_CAST(genc_hash_t*, scratch);
+	order = (size_t*)(void*)(hashes + count);
+	part_start = order + count;
+	
+	// hash everything and count the items per partition
+	memset(part_start, 0, (partitions + 1) * sizeof(size_t));
+	for (i = 0; i < count; ++i)
+	{
+		void* key = lpht_item_key(desc, (void*)(item_bytes + i * bucket_size), opaque);
+		hashes[i] = lpht_hash_key(table, desc, key, opaque);
+		++part_start[((hashes[i] & mask) >> shift) + 1];
+	}
+	for (i = 1; i <= partitions; ++i)
+		part_start[i] += part_start[i - 1];
+	// stable scatter, so duplicate keys are still resolved in input order
+	for (i = 0; i < count; ++i)
+		order[part_start[(hashes[i] & mask) >> shift]++] = i;
+	
+	// insert partition by partition: the writes sweep through the bucket array
+	for (i = 0; i < count; ++i)
+	{
+		size_t idx = order[i];
+		if (i + LPHT_BULK_PREFETCH_DISTANCE < count)
+			GENC_PREFETCH(item_bytes + order[i + LPHT_BULK_PREFETCH_DISTANCE] * bucket_size);
+		if (genc_lphtl_insert_hashed_item_into_table(
+			table, desc, opaque, (void*)(item_bytes + idx * bucket_size), hashes[idx]))
+			++inserted;
+	}
+	table->item_count += inserted;
+	GENC_HASH_STATS_ADD(table->stats, insert_duplicates, count - inserted);
+	desc->realloc_fn(scratch, scratch_size, 0, opaque);
+	
+	// the per-insertion collision guard is skipped above, so check all at once
+	if (desc->max_probe_length > 0 && desc->seeded_hash_fn
+	    && lpht_longest_probe(table, desc, opaque) > lpht_probe_length_limit(table, desc))
+		lpht_guard_reseed(table, desc, opaque);
+	return inserted;
+}
+
+/* Adds the probe distances of the items in the given (possibly old) array */
+static void lpht_stats_add_items(
+	genc_hash_table_stats_snapshot_t* snapshot,
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque)
+{
+	const size_t mask = table->capacity - 1;
+	size_t idx;
+	for (idx = 0; idx < table->capacity; ++idx)
+	{
+		size_t dist;
+		if (lpht_bucket_is_empty(table, desc, opaque, idx))
+			continue;
+		dist = lpht_probe_distance(lpht_bucket_hash(table, desc, opaque, idx), idx, mask);
+		++snapshot->chain_lengths[genc_hash_stats_histogram_bin(dist)];
+		if (dist > snapshot->longest_chain)
+			snapshot->longest_chain = dist;
+	}
+}
+
+void genc_lpht_stats_snapshot(struct genc_linear_probing_hash_table* table, genc_hash_table_stats_snapshot_t* out_snapshot)
+{
+	genc_lphtl_stats_snapshot(&table->table, &table->desc, table->opaque, out_snapshot);
+}
+
+void genc_lphtl_stats_snapshot(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_table_stats_snapshot_t* out_snapshot)
+{
+	memset(out_snapshot, 0, sizeof(*out_snapshot));
+#if GENC_HASH_TABLE_STATS
+	out_snapshot->ops = table->stats;
+#endif
+	out_snapshot->item_count = table->item_count;
+	out_snapshot->capacity = table->capacity;
+	lpht_stats_add_items(out_snapshot, table, desc, opaque);
+	if (table->old_buckets)
+	{
+		genc_linear_probing_hash_table_light_t old = lpht_old_view(table);
+		lpht_stats_add_items(out_snapshot, &old, desc, opaque);
+	}
+}
+
 static genc_bool_t genc_lphtl_verify(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque);
 /* Walks all the elements in the hash table and checks they're still in the correct bucket. */
@@ -600,18 +1701,49 @@ static genc_bool_t genc_lphtl_verify(
 {
 	const size_t capacity = table->capacity;
 	const size_t bucket_size = desc->bucket_size;
-	const genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
-	const genc_hash_get_item_key_fn get_key_fn = desc->get_key_fn;
 	
 	char* bucket = GENC_CXX_CAST(char*, table->buckets);
 	for (genc_hash_t idx = 0; idx < capacity; ++idx, bucket += bucket_size)
 	{
-		if (!item_empty_fn(bucket, opaque))
+		if (table->hashes && (table->hashes[idx] == 0) != lpht_item_is_empty(desc, bucket, opaque))
+			return false;
+		if (!lpht_item_is_empty(desc, bucket, opaque))
 		{
-			void* key = get_key_fn(bucket, opaque);
+			void* key = lpht_item_key(desc, bucket, opaque);
+			if (table->hashes && table->hashes[idx] != (lpht_hash_key(table, desc, key, opaque) | LPHT_HASH_OCCUPIED))
+				return false;
 			void* found = genc_lphtl_find(table, desc, opaque, key);
 			if (found != bucket)
 				return false;
+			if (desc->flags & GENC_LPHT_ROBIN_HOOD)
+			{
+				/* Each item may be at most one bucket further from home than its predecessor */
+				const size_t mask = capacity - 1;
+				genc_hash_t prev_idx = (idx - 1) & mask;
+				size_t dist = lpht_probe_distance(lpht_bucket_hash(table, desc, opaque, idx), idx, mask);
+				if (dist > 0
+					&& (lpht_bucket_is_empty(table, desc, opaque, prev_idx)
+					    || lpht_probe_distance(lpht_bucket_hash(table, desc, opaque, prev_idx), prev_idx, mask) + 1 < dist))
+					return false;
+			}
+		}
+	}
+	if (table->old_buckets)
+	{
+		// everything still in the old array must be found there
+		genc_linear_probing_hash_table_light_t old = lpht_old_view(table);
+		const size_t old_mask = old.capacity - 1;
+		for (genc_hash_t idx = 0; idx < old.capacity; ++idx)
+		{
+			bucket = lpht_bucket_at(desc, old.buckets, idx);
+			if (lpht_bucket_is_empty(&old, desc, opaque, idx))
+				continue;
+			if (((idx - table->migrate_start) & old_mask) < table->migrated)
+				return false; // should have been migrated
+			if (old.hashes && old.hashes[idx] != (lpht_hash_key(&old, desc, lpht_item_key(desc, bucket, opaque), opaque) | LPHT_HASH_OCCUPIED))
+				return false;
+			if (genc_lphtl_find(table, desc, opaque, lpht_item_key(desc, bucket, opaque)) != bucket)
+				return false;
 		}
 	}
 	return true;
@@ -621,21 +1753,25 @@ void* genc_lpht_first_item(struct genc_linear_probing_hash_table* table)
 {
 	return genc_lphtl_first_item(&table->table, &table->desc, table->opaque);
 }
-void* genc_lphtl_first_item(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque)
+/* First non-empty bucket at or after idx */
+static void* lpht_first_item_from(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque,
+	genc_hash_t idx)
 {
 	const size_t capacity = table->capacity;
-	const size_t bucket_size = desc->bucket_size;
-	const genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
-
-	char* bucket = GENC_CXX_CAST(char*, table->buckets);
-
-	for (genc_hash_t idx = 0; idx < capacity; ++idx, bucket += bucket_size)
+	for (; idx < capacity; ++idx)
 	{
-		if (!item_empty_fn(bucket, opaque))
-			return bucket;
+		if (!lpht_bucket_is_empty(table, desc, opaque, idx))
+			return lpht_bucket_at(desc, table->buckets, idx);
 	}
 	return NULL;
 }
+void* genc_lphtl_first_item(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque)
+{
+	// iteration only covers one bucket array
+	genc_lphtl_complete_resize(table, desc, opaque);
+	return lpht_first_item_from(table, desc, opaque, 0);
+}
 /* Next non-empty bucket */
 void* genc_lpht_next_item(struct genc_linear_probing_hash_table* table, void* cur_item)
 {
@@ -645,21 +1781,6 @@ void* genc_lphtl_next_item(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque,
 	void* cur_item)
 {
-	const size_t capacity = table->capacity;
-	const size_t bucket_size = desc->bucket_size;
-	const genc_item_is_empty_fn item_empty_fn = desc->item_empty_fn;
-
-	char* bucket = GENC_CXX_CAST(char*, cur_item);
-
-	char* end = GENC_CXX_CAST(char*, table->buckets);
-	end += capacity * bucket_size;
-
-	bucket += bucket_size;
-	for (; bucket < end; bucket += bucket_size)
-	{
-		if (!item_empty_fn(bucket, opaque))
-			return bucket;
-	}
-	return NULL;
+	return lpht_first_item_from(table, desc, opaque, lpht_bucket_index(table, desc, cur_item) + 1);
 }
 
@@ -74,6 +74,8 @@ genc_bool_t genc_linear_probing_hash_table_init(
  * Grow threshold should be somewhat more than 2x shrink threshold to avoid
  * oscillation.
  * Capacity is always a power of 2.
+ * To enable optional modes (genc_lpht_flags, e.g. Robin Hood insertion), set up
+ * a descriptor and use genc_linear_probing_hash_table_init_with_desc instead.
  */
 genc_bool_t genc_linear_probing_hash_table_init_ext(
 	struct genc_linear_probing_hash_table* table,
@@ -106,6 +108,17 @@ void* genc_lpht_insert_item(
 void* genc_lpht_insert_or_update_item(
 	struct genc_linear_probing_hash_table* table, void* item);
 
+/* Inserts count items from the array items (desc->bucket_size bytes each),
+ * which for large inputs is several times faster than inserting them one by
+ * one: the table is resized once up front, all items are hashed, and they are
+ * then inserted grouped by home bucket, so writes sweep through the bucket
+ * array instead of missing the cache on every item. Items whose key is already
+ * present (in the table or earlier in the array) are skipped. Returns the
+ * number of items inserted. Needs temporary memory of about 2 words per item;
+ * if that can't be allocated, or the table can't grow to hold all items, falls
+ * back to individual insertions. */
+size_t genc_lpht_bulk_load(struct genc_linear_probing_hash_table* table, const void* items, size_t count);
+
 enum genc_lpht_insertion_test_result_type
 {
 	// inserting a NULL item is a no-op
@@ -135,6 +148,14 @@ genc_lpht_insertion_test_result_t genc_lpht_can_insert_item(
 /* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
 void* genc_lpht_find(struct genc_linear_probing_hash_table* table, void* key);
 
+/* Looks up count keys at once, storing the matching item (or NULL) for keys[i]
+ * in out_items[i]. Returns the number of keys found. Hashing and prefetching
+ * the buckets of several keys before resolving any of them lets their cache
+ * misses overlap, which makes this considerably faster than individual lookups
+ * for large tables. */
+size_t genc_lpht_find_batch(
+	struct genc_linear_probing_hash_table* table, void* const* keys, void** out_items, size_t count);
+
 /* Hashes the key and returns the bucket index into which the key falls */
 genc_hash_t genc_lpht_get_bucket_for_key(
 	struct genc_linear_probing_hash_table* table, void* key);
@@ -146,6 +167,19 @@ genc_hash_t genc_lpht_get_bucket_for_key(
  */
 void genc_lpht_remove(struct genc_linear_probing_hash_table* table, void* item);
 
+/* Predicate on items for genc_lpht_remove_if(), returns true for items to remove */
+typedef genc_bool_t(*genc_lpht_item_pred_fn)(void* item, void* data);
+
+/* Removes all items for which pred returns true, returning how many were
+ * removed. Rather than closing the gap after each removal, this makes a single
+ * pass over the bucket array which moves the remaining items of affected
+ * clusters back towards their home buckets, and the table only shrinks (if
+ * needed) at the end. Completes any incremental resize first.
+ * pred is called once per item (it may release resources held by items it
+ * accepts), except in a table with no empty buckets, where items preceding
+ * the first match are tested twice. It must not modify the table. */
+size_t genc_lpht_remove_if(struct genc_linear_probing_hash_table* table, genc_lpht_item_pred_fn pred, void* pred_data);
+
 /* Shrink the capacity of the table by a factor of 1 << log2_shrink_factor */
 bool genc_lpht_shrink_by(struct genc_linear_probing_hash_table* table, unsigned log2_shrink_factor);
 /* Grow the capacity of the table by a factor of 1 << log2_grow_factor */
@@ -167,6 +201,17 @@ void* genc_lpht_next_item(struct genc_linear_probing_hash_table* table, void* cu
  * free/alloc any memory. */
 void genc_lpht_clear(struct genc_linear_probing_hash_table* table);
 
+/* Incremental resizing, see genc_linear_probing_hash_table_desc.migrate_buckets_per_op */
+genc_bool_t genc_lpht_is_resizing(struct genc_linear_probing_hash_table* table);
+genc_bool_t genc_lpht_resize_step(struct genc_linear_probing_hash_table* table);
+void genc_lpht_complete_resize(struct genc_linear_probing_hash_table* table);
+
+/* Seeded hashing, see genc_lphtl_set_seed() */
+bool genc_lpht_set_seed(struct genc_linear_probing_hash_table* table, uint64_t seed);
+
+/* See genc_lphtl_stats_snapshot() */
+void genc_lpht_stats_snapshot(struct genc_linear_probing_hash_table* table, genc_hash_table_stats_snapshot_t* out_snapshot);
+
 struct genc_linear_probing_hash_table_light
 {
 	/* Total number of buckets */
@@ -174,9 +219,53 @@ struct genc_linear_probing_hash_table_light
 	/* Number of filled buckets */
 	size_t item_count;
 	void* buckets;
+	/* Parallel array of per-bucket hashes, only with GENC_LPHT_STORE_HASHES or GENC_LPHT_ROBIN_HOOD */
+	genc_hash_t* hashes;
+	/* Incremental resize state (see migrate_buckets_per_op in the descriptor).
+	 * While old_buckets is non-NULL, the items in the old_capacity-bucket old
+	 * array are being moved across, in bucket order starting at the (originally
+	 * empty) bucket migrate_start. The first `migrated` buckets have been
+	 * moved and are now empty. */
+	void* old_buckets;
+	genc_hash_t* old_hashes;
+	size_t old_capacity;
+	size_t migrate_start;
+	size_t migrated;
+	/* Seed passed to desc->seeded_hash_fn, see genc_lphtl_set_seed() */
+	uint64_t seed;
+	/* Number of reseeds triggered by desc->max_probe_length so far */
+	size_t reseed_count;
+	/* Probe length limit once reseeding failed to stay below
+	 * desc->max_probe_length; 0 while that still applies. */
+	size_t probe_length_limit;
+#if GENC_HASH_TABLE_STATS
+	genc_hash_table_stats_t stats;
+#endif
 };
 typedef struct genc_linear_probing_hash_table_light genc_linear_probing_hash_table_light_t;
 
+/* Descriptor flags */
+enum genc_lpht_flags
+{
+	/* Keep each bucket's full hash value in a separate array next to the
+	 * buckets. Probing then compares the hashes first and only touches the
+	 * bucket itself (and calls the key equality function) on a hash match, and
+	 * removal and resizing never call the hash function. Costs
+	 * sizeof(genc_hash_t) extra bytes per bucket, so mainly useful for large
+	 * buckets or expensive hash/key comparison functions. */
+	GENC_LPHT_STORE_HASHES = 1u << 0,
+	/* Robin Hood hashing: on insertion, an item displaces any resident which is
+	 * closer to its home bucket than the new item is to its own, and removal
+	 * shifts the following run back by one bucket instead of leaving it in
+	 * place. This keeps probe lengths short and even at high load factors
+	 * (90% is fine), and lookup misses stop as soon as they pass a resident
+	 * closer to home than the searched key would be.
+	 * Probe distances are computed from residents' hashes, so this implies
+	 * GENC_LPHT_STORE_HASHES; otherwise every probed resident would need
+	 * rehashing. Growing always rehashes into a new bucket array. */
+	GENC_LPHT_ROBIN_HOOD = 1u << 1
+};
+
 struct genc_linear_probing_hash_table_desc
 {
 	genc_key_hash_fn hash_fn;
@@ -188,6 +277,40 @@ struct genc_linear_probing_hash_table_desc
 	size_t bucket_size; /* bytes per item */
 	uint8_t load_percent_grow_threshold;
 	uint8_t load_percent_shrink_threshold;
+	/* Inline key mode: if key_size is non-zero, each bucket's key is the
+	 * key_size bytes at key_offset, and a bucket is empty if its key bytes equal
+	 * those pointed to by empty_key. Keys are then compared directly
+	 * (as integers for 4 and 8 byte keys, memcmp otherwise) and get_key_fn,
+	 * key_equality_fn and item_empty_fn are not used. item_clear_fn is optional;
+	 * if NULL, buckets are cleared by zeroing them and writing the empty key.
+	 * The key passed to hash_fn is a pointer to the key bytes. */
+	size_t key_offset;
+	size_t key_size;
+	const void* empty_key;
+	/* Bitwise OR of genc_lpht_flags. Set after genc_linear_probing_hash_table_desc_init*()
+	 * but before initialising any tables with the descriptor. */
+	unsigned flags;
+	/* Incremental resizing: if non-zero, growing or shrinking the table only
+	 * allocates the new bucket array, and the items are moved across
+	 * migrate_buckets_per_op old buckets at a time by each subsequent insertion
+	 * and removal (or genc_lphtl_resize_step()). Lookups check both arrays
+	 * meanwhile, and don't migrate anything themselves, so they remain safe to
+	 * run concurrently with each other.
+	 * Starting to iterate the table (first_item) finishes the resize first,
+	 * clearing the table frees the old array. Robin Hood tables always resize
+	 * in one go.
+	 * 0 (the default) disables incremental resizing. May be changed at any time. */
+	size_t migrate_buckets_per_op;
+	/* Seeded hashing: if set, used with each table's seed instead of hash_fn
+	 * (which the sharded wrapper still uses to pick shards). */
+	genc_seeded_key_hash_fn seeded_hash_fn;
+	/* Collision guard for seeded tables: if an insertion places an item more
+	 * than max_probe_length buckets from its home bucket, the table is
+	 * rehashed with a new seed derived from the current one. Should be well
+	 * above the probe lengths expected at the grow threshold, e.g. 64. If the
+	 * longest probe sequence is still too long afterwards, that table's limit
+	 * is doubled so it can't keep rehashing. 0 (the default) disables it. */
+	size_t max_probe_length;
 };
 typedef struct genc_linear_probing_hash_table_desc genc_linear_probing_hash_table_desc_t;
 
@@ -228,6 +351,27 @@ void genc_linear_probing_hash_table_desc_init(
 	uint8_t load_percent_grow_threshold,
 	uint8_t load_percent_shrink_threshold);
 
+/* Sets up an inline key descriptor, see genc_linear_probing_hash_table_desc.
+ * empty_key must point to key_size bytes which remain valid for the lifetime
+ * of the descriptor. */
+void genc_linear_probing_hash_table_desc_init_inline_key(
+	genc_linear_probing_hash_table_desc_t* desc,
+	genc_key_hash_fn hash_fn,
+	genc_realloc_fn realloc_fn,
+	size_t bucket_size, /* bytes per item */
+	size_t key_offset,
+	size_t key_size,
+	const void* empty_key,
+	uint8_t load_percent_grow_threshold,
+	uint8_t load_percent_shrink_threshold);
+
+/* Initialises the hash table with a copy of the given descriptor. */
+genc_bool_t genc_linear_probing_hash_table_init_with_desc(
+	struct genc_linear_probing_hash_table* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	size_t initial_capacity_pow2);
+
 genc_bool_t genc_linear_probing_hash_table_light_init(
 	genc_linear_probing_hash_table_light_t* table,
 	const genc_linear_probing_hash_table_desc_t* desc,
@@ -258,6 +402,10 @@ void* genc_lphtl_insert_item(
 void* genc_lphtl_insert_or_update_item(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* item);
+/* See genc_lpht_bulk_load() */
+size_t genc_lphtl_bulk_load(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	const void* items, size_t count);
 
 bool genc_lphtl_grow_by(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
@@ -272,17 +420,52 @@ genc_hash_t genc_lphtl_get_bucket_for_key(
 void* genc_lphtl_find(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* key);
+size_t genc_lphtl_find_batch(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	void* const* keys, void** out_items, size_t count);
 genc_lpht_insertion_test_result_t genc_lphtl_can_insert_item(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* item);
 void genc_lphtl_remove(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
 	void* item);
+/* See genc_lpht_remove_if() */
+size_t genc_lphtl_remove_if(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_lpht_item_pred_fn pred, void* pred_data);
 void* genc_lphtl_first_item(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
 void* genc_lphtl_next_item(
 	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* const opaque,
 	void* cur_item);
 
+/* Incremental resizing (see genc_linear_probing_hash_table_desc.migrate_buckets_per_op): */
+/* Returns true if an incremental resize is in progress. */
+genc_bool_t genc_lphtl_is_resizing(genc_linear_probing_hash_table_light_t* table);
+/* Moves up to desc->migrate_buckets_per_op buckets (at least 1) to the new
+ * array, returning true if there are more to go. Allows clients to make
+ * progress on a resize during idle time. */
+genc_bool_t genc_lphtl_resize_step(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
+/* Finishes any incremental resize in progress immediately. */
+void genc_lphtl_complete_resize(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque);
+
+/* Rehashes all items with the given seed for desc->seeded_hash_fn (which must
+ * be set). Seeds should be picked randomly if keys may come from an untrusted
+ * source. Returns false, leaving the table unchanged, if memory for the
+ * rehashed table can't be allocated. */
+bool genc_lphtl_set_seed(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t seed);
+
+/* Fills in the table's operation counters (see GENC_HASH_TABLE_STATS) and the
+ * histogram of its items' distances from their home buckets, which takes a
+ * pass over all buckets. Lookups only count the probes in the current bucket
+ * array, not any old one being migrated from. */
+void genc_lphtl_stats_snapshot(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	genc_hash_table_stats_snapshot_t* out_snapshot);
+
 /** Resizes the table, if necessary, so that it will not need resizing to hold
  * target_count items.
  * So if it currently has count items, where count < target_count, and we make
@@ -0,0 +1,330 @@
+/* mkstemp() and fchmod() are XSI extensions, hidden by strict C modes */
+#if !defined(KERNEL) && !defined(__KERNEL__) && !defined(_XOPEN_SOURCE) && !defined(__APPLE__)
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "linear_probing_hash_table_file.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+#if GENC_LPHT_FILE_POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Seed for the header and data checksums */
+#define LPHT_FILE_CHECKSUM_SEED 0x4c50485446494c45ull
+
+static const unsigned lpht_file_layout_flags = GENC_LPHT_STORE_HASHES | GENC_LPHT_ROBIN_HOOD;
+
+/* The layout flags of tables using desc (Robin Hood tables always store hashes) */
+static unsigned lpht_file_desc_layout_flags(const genc_linear_probing_hash_table_desc_t* desc)
+{
+	unsigned flags = desc->flags & lpht_file_layout_flags;
+	if (flags & GENC_LPHT_ROBIN_HOOD)
+		flags |= GENC_LPHT_STORE_HASHES;
+	return flags;
+}
+
+static GENC_INLINE uint64_t lpht_file_align(uint64_t offset)
+{
+	return (offset + GENC_LPHT_FILE_ALIGNMENT - 1) & ~(uint64_t)(GENC_LPHT_FILE_ALIGNMENT - 1);
+}
+
+static uint64_t lpht_file_header_checksum(const genc_lpht_file_header_t* header)
+{
+	return genc_hash_bytes(header, offsetof(genc_lpht_file_header_t, header_checksum), LPHT_FILE_CHECKSUM_SEED);
+}
+
+/* Checksum of the empty key, 0 for tables without inline keys */
+static uint64_t lpht_file_empty_key_checksum(const genc_linear_probing_hash_table_desc_t* desc)
+{
+	if (desc->key_size == 0)
+		return 0;
+	return genc_hash_bytes(desc->empty_key, desc->key_size, LPHT_FILE_CHECKSUM_SEED);
+}
+
+static uint64_t lpht_file_data_checksum(const void* buckets, size_t buckets_size, const void* hashes, size_t hashes_size)
+{
+	genc_hash_bytes_state_t state;
+	genc_hash_bytes_init(&state, LPHT_FILE_CHECKSUM_SEED);
+	genc_hash_bytes_update(&state, buckets, buckets_size);
+	if (hashes)
+		genc_hash_bytes_update(&state, hashes, hashes_size);
+	return genc_hash_bytes_final(&state);
+}
+
+/* Fills in the header describing the table's image, computing the checksums
+ * over the table's arrays in place. */
+static genc_bool_t lpht_file_make_header(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t hash_id, genc_lpht_file_header_t* header)
+{
+	uint64_t buckets_size, hashes_size;
+	genc_lphtl_complete_resize(table, desc, opaque);
+	if (table->capacity == 0)
+		return 0;
+	buckets_size = (uint64_t)table->capacity * desc->bucket_size;
+	hashes_size = table->hashes ? (uint64_t)table->capacity * sizeof(genc_hash_t) : 0;
+
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, GENC_LPHT_FILE_MAGIC, sizeof(header->magic));
+	header->version = GENC_LPHT_FILE_VERSION;
+	header->byte_order = GENC_LPHT_FILE_BYTE_ORDER;
+	header->hash_size = sizeof(genc_hash_t);
+	header->flags = lpht_file_desc_layout_flags(desc);
+	header->capacity = table->capacity;
+	header->item_count = table->item_count;
+	header->bucket_size = desc->bucket_size;
+	header->key_offset = desc->key_size ? desc->key_offset : 0;
+	header->key_size = desc->key_size;
+	header->empty_key_checksum = lpht_file_empty_key_checksum(desc);
+	header->hash_id = hash_id;
+	header->seed = table->seed;
+	header->buckets_offset = lpht_file_align(sizeof(*header));
+	header->hashes_offset = table->hashes ? lpht_file_align(header->buckets_offset + buckets_size) : 0;
+	header->image_size = (table->hashes ? header->hashes_offset : header->buckets_offset + buckets_size) + hashes_size;
+	header->data_checksum = lpht_file_data_checksum(table->buckets, buckets_size, table->hashes, hashes_size);
+	header->header_checksum = lpht_file_header_checksum(header);
+	return 1;
+}
+
+size_t genc_lphtl_image_size(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc)
+{
+	size_t size = lpht_file_align(sizeof(genc_lpht_file_header_t)) + table->capacity * desc->bucket_size;
+	if (table->hashes)
+		size = lpht_file_align(size) + table->capacity * sizeof(genc_hash_t);
+	return size;
+}
+
+genc_bool_t genc_lphtl_save_to_buffer(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t hash_id, void* buffer, size_t buffer_size)
+{
+	genc_lpht_file_header_t header;
+	char* out = GENC_CXX_CAST(char*, buffer);
+	if (!lpht_file_make_header(table, desc, opaque, hash_id, &header) || buffer_size < header.image_size)
+		return 0;
+	memset(out, 0, (size_t)header.image_size);
+	memcpy(out, &header, sizeof(header));
+	memcpy(out + header.buckets_offset, table->buckets, table->capacity * desc->bucket_size);
+	if (table->hashes)
+		memcpy(out + header.hashes_offset, table->hashes, table->capacity * sizeof(genc_hash_t));
+	return 1;
+}
+
+genc_bool_t genc_lphtl_attach_readonly(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	const void* data, size_t size, uint64_t hash_id, genc_bool_t verify_data)
+{
+	const genc_lpht_file_header_t* header = GENC_CXX_CAST(const genc_lpht_file_header_t*, data);
+	const char* bytes = GENC_CXX_CAST(const char*, data);
+	uint64_t buckets_size, hashes_size;
+
+	if (size < sizeof(*header) || ((uintptr_t)data % GENC_LPHT_FILE_ALIGNMENT) != 0)
+		return 0;
+	if (memcmp(header->magic, GENC_LPHT_FILE_MAGIC, sizeof(header->magic)) != 0
+	    || header->version != GENC_LPHT_FILE_VERSION
+	    || header->byte_order != GENC_LPHT_FILE_BYTE_ORDER
+	    || header->header_checksum != lpht_file_header_checksum(header))
+		return 0;
+
+	// the image must match the caller's table setup
+	if (header->hash_size != sizeof(genc_hash_t)
+	    || header->hash_id != hash_id
+	    || header->bucket_size != desc->bucket_size
+	    || header->key_size != desc->key_size
+	    || header->key_offset != (desc->key_size ? desc->key_offset : 0)
+	    || header->empty_key_checksum != lpht_file_empty_key_checksum(desc)
+	    || header->flags != lpht_file_desc_layout_flags(desc))
+		return 0;
+
+	// sanity check the layout, so a bad header can't make us read out of bounds
+	if (header->capacity == 0 || header->capacity > SIZE_MAX || !genc_is_pow2((size_t)header->capacity)
+	    || header->item_count > header->capacity
+	    || header->capacity > (UINT64_MAX / 2) / (header->bucket_size + sizeof(genc_hash_t))
+	    || header->buckets_offset != lpht_file_align(sizeof(*header)))
+		return 0;
+	// (the capacity limit above means none of the following offsets overflow)
+	buckets_size = header->capacity * header->bucket_size;
+	hashes_size = (header->flags & GENC_LPHT_STORE_HASHES) ? header->capacity * sizeof(genc_hash_t) : 0;
+	if (hashes_size
+	    ? header->hashes_offset != lpht_file_align(header->buckets_offset + buckets_size)
+	    : header->hashes_offset != 0)
+		return 0;
+	if (header->image_size != (hashes_size ? header->hashes_offset : header->buckets_offset + buckets_size) + hashes_size
+	    || header->image_size > size)
+		return 0;
+
+	if (verify_data
+	    && header->data_checksum != lpht_file_data_checksum(
+	       bytes + header->buckets_offset, (size_t)buckets_size,
+	       hashes_size ? bytes + header->hashes_offset : NULL, (size_t)hashes_size))
+		return 0;
+
+	genc_lphtl_zero(table);
+	table->capacity = (size_t)header->capacity;
+	table->item_count = (size_t)header->item_count;
+	table->buckets = (void*)(bytes + header->buckets_offset);
+	table->hashes = hashes_size ? (genc_hash_t*)(void*)(bytes + header->hashes_offset) : NULL;
+	table->seed = header->seed;
+	return 1;
+}
+
+#if GENC_LPHT_FILE_POSIX
+
+static genc_bool_t lpht_file_write_all(int fd, const void* data, size_t size)
+{
+	const char* pos = GENC_CXX_CAST(const char*, data);
+	while (size > 0)
+	{
+		ssize_t written = write(fd, pos, size);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return 0;
+		}
+		pos += written;
+		size -= (size_t)written;
+	}
+	return 1;
+}
+
+/* Writes the image to fd without copying the arrays */
+static genc_bool_t lpht_file_write_image(
+	int fd, genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	const genc_lpht_file_header_t* header)
+{
+	static const char padding[GENC_LPHT_FILE_ALIGNMENT] = { 0 };
+	uint64_t buckets_end = header->buckets_offset + table->capacity * desc->bucket_size;
+	if (!lpht_file_write_all(fd, header, sizeof(*header))
+	    || !lpht_file_write_all(fd, padding, (size_t)(header->buckets_offset - sizeof(*header)))
+	    || !lpht_file_write_all(fd, table->buckets, table->capacity * desc->bucket_size))
+		return 0;
+	if (table->hashes
+	    && (!lpht_file_write_all(fd, padding, (size_t)(header->hashes_offset - buckets_end))
+	        || !lpht_file_write_all(fd, table->hashes, table->capacity * sizeof(genc_hash_t))))
+		return 0;
+	return 1;
+}
+
+/* Flushes the directory containing path, so a rename into it is durable */
+static genc_bool_t lpht_file_sync_dir(const char* path)
+{
+	const char* slash = strrchr(path, '/');
+	char* dir_path;
+	genc_bool_t ok;
+	int fd;
+	if (!slash)
+	{
+		dir_path = NULL;
+		fd = open(".", O_RDONLY);
+	}
+	else
+	{
+		size_t dir_len = (slash == path) ? 1 : (size_t)(slash - path);
+		dir_path = GENC_CXX_CAST(char*, malloc(dir_len + 1));
+		if (!dir_path)
+			return 0;
+		memcpy(dir_path, path, dir_len);
+		dir_path[dir_len] = '\0';
+		fd = open(dir_path, O_RDONLY);
+	}
+	free(dir_path);
+	if (fd < 0)
+		return 0;
+	ok = (fsync(fd) == 0);
+	if (close(fd) != 0)
+		ok = 0;
+	return ok;
+}
+
+genc_bool_t genc_lphtl_save(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t hash_id, const char* path)
+{
+	static const char tmp_suffix[] = ".XXXXXX";
+	genc_lpht_file_header_t header;
+	size_t path_len = strlen(path);
+	char* tmp_path;
+	genc_bool_t ok;
+	int fd;
+
+	if (!lpht_file_make_header(table, desc, opaque, hash_id, &header))
+		return 0;
+
+	/* Write to a fresh temporary file and rename it over the target, so readers
+	 * never see a partial image and concurrent savers don't clobber each other's
+	 * temporary files. The data must reach the disk before the rename does, or
+	 * a crash could leave a renamed but empty file. */
+	tmp_path = GENC_CXX_CAST(char*, malloc(path_len + sizeof(tmp_suffix)));
+	if (!tmp_path)
+		return 0;
+	memcpy(tmp_path, path, path_len);
+	memcpy(tmp_path + path_len, tmp_suffix, sizeof(tmp_suffix));
+	fd = mkstemp(tmp_path);
+	if (fd < 0)
+	{
+		free(tmp_path);
+		return 0;
+	}
+	// mkstemp creates the file private to us, but images are meant to be shared
+	ok = fchmod(fd, 0644) == 0
+		&& lpht_file_write_image(fd, table, desc, &header)
+		&& fsync(fd) == 0;
+	if (close(fd) != 0)
+		ok = 0;
+	if (ok && rename(tmp_path, path) != 0)
+		ok = 0;
+	if (!ok)
+		unlink(tmp_path);
+	free(tmp_path);
+	return ok && lpht_file_sync_dir(path);
+}
+
+genc_bool_t genc_lphtl_map_readonly(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	const char* path, uint64_t hash_id, genc_bool_t verify_data, genc_lpht_mapping_t* out_mapping)
+{
+	struct stat st;
+	void* addr;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX)
+	{
+		close(fd);
+		return 0;
+	}
+	addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return 0;
+	if (!genc_lphtl_attach_readonly(table, desc, addr, (size_t)st.st_size, hash_id, verify_data))
+	{
+		munmap(addr, (size_t)st.st_size);
+		return 0;
+	}
+	out_mapping->addr = addr;
+	out_mapping->length = (size_t)st.st_size;
+	return 1;
+}
+
+void genc_lphtl_unmap(genc_linear_probing_hash_table_light_t* table, genc_lpht_mapping_t* mapping)
+{
+	if (mapping->addr)
+		munmap(mapping->addr, mapping->length);
+	mapping->addr = NULL;
+	mapping->length = 0;
+	genc_lphtl_zero(table);
+}
+
+#endif
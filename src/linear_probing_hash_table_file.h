@@ -0,0 +1,149 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * Persistent image format for linear probing hash tables. A light table is
+ * just a bucket array (plus the optional hash array), so saving one means
+ * writing those arrays behind a header, and loading one means pointing a table
+ * struct at them: a mapped file can be queried immediately, without any
+ * rehashing, and the pages are shared by all processes mapping the same file.
+ *
+ * This only works if the buckets are self-contained, i.e. hold no pointers -
+ * typically inline-key descriptors with plain data values. The hash function
+ * can't be stored either, so the caller identifies it with hash_id when saving,
+ * and must pass the same id (and use the same hash function and descriptor
+ * layout) when loading. The bucket size, inline key layout and layout flags
+ * are recorded in the image and checked on loading. Images are tied to the
+ * byte order and word size of the machine that wrote them.
+ *
+ * Tables attached to an image are read-only: only lookups and iteration are
+ * allowed, and they must not be destroyed, only detached/unmapped.
+ */
+
+#ifndef GENCCONT_LINEAR_PROBING_HASH_TABLE_FILE_H
+#define GENCCONT_LINEAR_PROBING_HASH_TABLE_FILE_H
+
+#include "linear_probing_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__) && (defined(__unix__) || defined(__APPLE__))
+#define GENC_LPHT_FILE_POSIX 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GENC_LPHT_FILE_MAGIC "GENCLPHT"
+#define GENC_LPHT_FILE_VERSION 2
+/* Written in native byte order; reads back differently on a foreign machine */
+#define GENC_LPHT_FILE_BYTE_ORDER 0x01020304u
+/* Bucket and hash arrays start at multiples of this within the image */
+#define GENC_LPHT_FILE_ALIGNMENT 64
+
+struct genc_lpht_file_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	/* sizeof(genc_hash_t) */
+	uint32_t hash_size;
+	/* GENC_LPHT_STORE_HASHES and GENC_LPHT_ROBIN_HOOD, which affect the layout */
+	uint32_t flags;
+	uint64_t capacity;
+	uint64_t item_count;
+	uint64_t bucket_size;
+	/* Inline key layout (all 0 unless desc->key_size is set), so that an image
+	 * isn't misread by a descriptor with the same bucket size but a different
+	 * key position or empty key. */
+	uint64_t key_offset;
+	uint64_t key_size;
+	/* genc_hash_bytes() of the empty key */
+	uint64_t empty_key_checksum;
+	/* Caller-defined identifier of the hash function */
+	uint64_t hash_id;
+	/* Seed for desc->seeded_hash_fn */
+	uint64_t seed;
+	uint64_t buckets_offset;
+	/* 0 unless hashes are stored */
+	uint64_t hashes_offset;
+	uint64_t image_size;
+	/* genc_hash_bytes() of the bucket and hash arrays */
+	uint64_t data_checksum;
+	/* genc_hash_bytes() of the header up to here */
+	uint64_t header_checksum;
+};
+typedef struct genc_lpht_file_header genc_lpht_file_header_t;
+
+/* Returns the size in bytes of the table's image. */
+size_t genc_lphtl_image_size(genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc);
+
+/* Writes the table's image to buffer, which must be at least
+ * genc_lphtl_image_size() bytes. Finishes any incremental resize first.
+ * Returns false if the buffer is too small. */
+genc_bool_t genc_lphtl_save_to_buffer(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t hash_id, void* buffer, size_t buffer_size);
+
+/* Validates the image in data and sets up table to use it in place. data must
+ * be aligned to GENC_LPHT_FILE_ALIGNMENT and outlive the table. The checksum
+ * over the whole table is only checked if verify_data is set; the header is
+ * always checked. Returns false if the image is invalid or doesn't match desc
+ * and hash_id. */
+genc_bool_t genc_lphtl_attach_readonly(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	const void* data, size_t size, uint64_t hash_id, genc_bool_t verify_data);
+
+#if GENC_LPHT_FILE_POSIX
+
+struct genc_lpht_mapping
+{
+	void* addr;
+	size_t length;
+};
+typedef struct genc_lpht_mapping genc_lpht_mapping_t;
+
+/* Writes the table's image to the file at path, replacing it atomically: the
+ * image goes to a uniquely named temporary file in the same directory, which
+ * is flushed to disk and then renamed over path, and the directory is flushed
+ * in turn. On failure, path is left as it was. */
+genc_bool_t genc_lphtl_save(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, void* opaque,
+	uint64_t hash_id, const char* path);
+
+/* Maps the image file at path read-only and attaches table to it, see
+ * genc_lphtl_attach_readonly(). On success, release the mapping with
+ * genc_lphtl_unmap() once the table is no longer used. */
+genc_bool_t genc_lphtl_map_readonly(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc,
+	const char* path, uint64_t hash_id, genc_bool_t verify_data, genc_lpht_mapping_t* out_mapping);
+
+/* Unmaps the image and zeroes the table. */
+void genc_lphtl_unmap(genc_linear_probing_hash_table_light_t* table, genc_lpht_mapping_t* mapping);
+
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
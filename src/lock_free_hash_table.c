@@ -0,0 +1,128 @@
+#include "lock_free_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+genc_bool_t genc_lock_free_hash_table_init(
+	genc_lock_free_hash_table_t* table,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t capacity_pow2)
+{
+	void* buckets;
+	if (!genc_is_pow2(capacity_pow2))
+		return 0;
+	if (SIZE_MAX / sizeof(struct genc_lfht_bucket) < capacity_pow2)
+		return 0;
+	buckets = realloc_fn(NULL, 0, capacity_pow2 * sizeof(struct genc_lfht_bucket), opaque);
+	if (!buckets)
+		return 0;
+	memset(buckets, 0, capacity_pow2 * sizeof(struct genc_lfht_bucket));
+
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	table->buckets = GENC_CXX_CAST(struct genc_lfht_bucket*, buckets);
+	table->capacity = capacity_pow2;
+	table->item_count = 0;
+	table->zero_key_value = NULL;
+	return 1;
+}
+
+void genc_lfht_destroy(genc_lock_free_hash_table_t* table)
+{
+	if (table->buckets)
+		table->realloc_fn(table->buckets, table->capacity * sizeof(struct genc_lfht_bucket), 0, table->opaque);
+	table->buckets = NULL;
+	table->capacity = 0;
+	table->item_count = 0;
+	table->zero_key_value = NULL;
+}
+
+size_t genc_lfht_count(genc_lock_free_hash_table_t* table)
+{
+	return genc_atomic_load_relaxed(&table->item_count);
+}
+
+size_t genc_lfht_capacity(genc_lock_free_hash_table_t* table)
+{
+	return table->capacity;
+}
+
+/* Finds the value slot for key. If the key has no bucket yet and claim is set,
+ * claims the first empty bucket on its probe sequence. Returns NULL if the key
+ * has no bucket (and none could be claimed). */
+static void** lfht_value_slot(genc_lock_free_hash_table_t* table, uint64_t key, genc_bool_t claim)
+{
+	const size_t mask = table->capacity - 1;
+	size_t idx, probes;
+	if (key == 0)
+		return &table->zero_key_value;
+
+	idx = genc_hash_uint64(key) & mask;
+	for (probes = 0; probes < table->capacity; ++probes, idx = (idx + 1) & mask)
+	{
+		struct genc_lfht_bucket* bucket = &table->buckets[idx];
+		uint64_t bucket_key = genc_atomic_load_acquire(&bucket->key);
+		if (bucket_key == 0)
+		{
+			/* Buckets are claimed in probe order and never released, so an
+			 * empty bucket ends the key's probe sequence. */
+			if (!claim)
+				return NULL;
+			/* on failure, bucket_key receives the winner's key */
+			if (genc_atomic_cas(&bucket->key, &bucket_key, key))
+				return &bucket->value;
+		}
+		if (bucket_key == key)
+			return &bucket->value;
+	}
+	return NULL;
+}
+
+genc_bool_t genc_lfht_insert_item(genc_lock_free_hash_table_t* table, uint64_t key, void* value)
+{
+	void** slot;
+	void* expected = NULL;
+	if (!value)
+		return 0;
+	slot = lfht_value_slot(table, key, 1);
+	if (!slot || !genc_atomic_cas(slot, &expected, value))
+		return 0;
+	genc_atomic_fetch_add(&table->item_count, 1);
+	return 1;
+}
+
+void* genc_lfht_insert_or_update_item(genc_lock_free_hash_table_t* table, uint64_t key, void* value)
+{
+	void** slot;
+	void* old_value;
+	if (!value)
+		return NULL;
+	slot = lfht_value_slot(table, key, 1);
+	if (!slot)
+		return NULL;
+	old_value = genc_atomic_exchange(slot, value);
+	if (!old_value)
+		genc_atomic_fetch_add(&table->item_count, 1);
+	return old_value;
+}
+
+void* genc_lfht_find(genc_lock_free_hash_table_t* table, uint64_t key)
+{
+	void** slot = lfht_value_slot(table, key, 0);
+	return slot ? genc_atomic_load_acquire(slot) : NULL;
+}
+
+void* genc_lfht_remove(genc_lock_free_hash_table_t* table, uint64_t key)
+{
+	void** slot = lfht_value_slot(table, key, 0);
+	void* old_value;
+	if (!slot)
+		return NULL;
+	/* The key stays claimed; a NULL value is the tombstone */
+	old_value = genc_atomic_exchange(slot, NULL);
+	if (old_value)
+		genc_atomic_fetch_sub(&table->item_count, 1);
+	return old_value;
+}
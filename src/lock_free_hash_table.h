@@ -0,0 +1,114 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * A lock-free, fixed-capacity linear probing hash table mapping uint64_t keys
+ * to non-NULL pointer values. All operations may be called concurrently from
+ * any number of threads.
+ *
+ * Each bucket holds a key and a value. A key is placed by claiming the first
+ * empty bucket along its probe sequence with a compare-and-swap; once
+ * claimed, a bucket keeps its key for the lifetime of the table. Values are
+ * published and replaced atomically, and removal just swaps the value back to
+ * NULL (a tombstone), leaving the key in place for any later reinsertion.
+ *
+ * Consequently, the table never resizes, and capacity bounds the number of
+ * distinct keys ever inserted, not just the number currently present. Size it
+ * for the full key population up front; insertions fail once no bucket
+ * along the key's probe sequence can be claimed.
+ *
+ * The table only stores pointers; ownership and reclamation of what they point
+ * to (e.g. after a removal while other threads might still be reading the old
+ * value) is the client's responsibility.
+ */
+
+#ifndef GENCCONT_LOCK_FREE_HASH_TABLE_H
+#define GENCCONT_LOCK_FREE_HASH_TABLE_H
+
+#include "hash_shared.h"
+#include "atomics.h"
+
+#if !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct genc_lfht_bucket
+{
+	/* 0 means unclaimed; key 0 itself lives outside the bucket array */
+	uint64_t key;
+	void* value;
+};
+
+struct genc_lock_free_hash_table
+{
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+	struct genc_lfht_bucket* buckets;
+	size_t capacity;
+	/* number of non-NULL values, approximate under concurrent modification */
+	size_t item_count;
+	void* zero_key_value;
+};
+typedef struct genc_lock_free_hash_table genc_lock_free_hash_table_t;
+
+/* Initialises the empty table with the given (fixed) capacity. Initialisation
+ * and destruction must not race with any other operations. */
+genc_bool_t genc_lock_free_hash_table_init(
+	genc_lock_free_hash_table_t* table,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t capacity_pow2);
+
+/* Deallocates the bucket array. Values are not touched. */
+void genc_lfht_destroy(genc_lock_free_hash_table_t* table);
+
+/* Returns the number of keys currently mapped to a value. */
+size_t genc_lfht_count(genc_lock_free_hash_table_t* table);
+
+/* Returns the number of buckets. */
+size_t genc_lfht_capacity(genc_lock_free_hash_table_t* table);
+
+/* Maps key to value unless the key already has a value. Returns false if the
+ * key is present, the value is NULL, or the table is full. */
+genc_bool_t genc_lfht_insert_item(genc_lock_free_hash_table_t* table, uint64_t key, void* value);
+
+/* Maps key to value, returning the value it replaced (NULL if the key was not
+ * present). Also returns NULL if the table is full, in which case
+ * genc_lfht_find can be used to tell the cases apart. */
+void* genc_lfht_insert_or_update_item(genc_lock_free_hash_table_t* table, uint64_t key, void* value);
+
+/* Returns the value mapped to key, or NULL if none. */
+void* genc_lfht_find(genc_lock_free_hash_table_t* table, uint64_t key);
+
+/* Unmaps the key, returning its previous value, or NULL if it had none. */
+void* genc_lfht_remove(genc_lock_free_hash_table_t* table, uint64_t key);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,407 @@
+#include "perfect_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+#define MPH_INITIAL_SEED 0x4d50485f53454544ull
+/* Seed offset for deriving slot hashes independently of bucket hashes */
+#define MPH_SLOT_SEED_OFFSET 0x9e3779b97f4a7c15ull
+#define MPH_MAX_PILOT 0xffffu
+/* Number of seeds to try before concluding the pilot search can't succeed */
+#define MPH_MAX_ATTEMPTS 8
+
+/* As in PTHash, buckets are sized unevenly: 60% of keys go to the first 30% of
+ * buckets. The large buckets are placed early, while most slots are free, and
+ * the many small ones fill the last gaps much faster than equal buckets would. */
+static GENC_INLINE size_t mph_bucket_for_hash(genc_perfect_hash_table_t* table, genc_hash_t hash)
+{
+	size_t mixed = genc_hash_uint64_seeded(hash, table->seed);
+	size_t dense_buckets = table->pilot_count / 10u * 3u;
+	if (dense_buckets == 0 || dense_buckets == table->pilot_count)
+		return mixed % table->pilot_count;
+	if (mixed < SIZE_MAX / 10u * 6u)
+		return mixed % dense_buckets;
+	return dense_buckets + mixed % (table->pilot_count - dense_buckets);
+}
+
+static GENC_INLINE uint64_t mph_slot_hash(genc_perfect_hash_table_t* table, genc_hash_t hash)
+{
+	return genc_hash_uint64_seeded(hash, table->seed + MPH_SLOT_SEED_OFFSET);
+}
+
+static GENC_INLINE uint64_t mph_pilot_hash(genc_perfect_hash_table_t* table, uint16_t pilot)
+{
+	return genc_hash_uint64_seeded(pilot, table->seed);
+}
+
+static GENC_INLINE size_t mph_search_slot(genc_perfect_hash_table_t* table, uint64_t slot_hash, uint64_t pilot_hash)
+{
+	return (size_t)((slot_hash ^ pilot_hash) % table->slot_count);
+}
+
+/* Remap entries are slot numbers below the item count, so 32 bits suffice
+ * unless the table is enormous. */
+static GENC_INLINE genc_bool_t mph_remap_is_wide(genc_perfect_hash_table_t* table)
+{
+#if SIZE_MAX > UINT32_MAX
+	return table->item_count > UINT32_MAX;
+#else
+	(void)table;
+	return 0;
+#endif
+}
+
+static GENC_INLINE size_t mph_remap_entry_size(genc_perfect_hash_table_t* table)
+{
+	return mph_remap_is_wide(table) ? sizeof(size_t) : sizeof(uint32_t);
+}
+
+static GENC_INLINE size_t mph_final_slot(genc_perfect_hash_table_t* table, size_t search_slot)
+{
+	size_t i;
+	if (search_slot < table->item_count)
+		return search_slot;
+	i = search_slot - table->item_count;
+	if (mph_remap_is_wide(table))
+	{
+		const size_t* remap = GENC_CXX_CAST(const size_t*, table->remap);
+		return remap[i];
+	}
+	else
+	{
+		const uint32_t* remap = GENC_CXX_CAST(const uint32_t*, table->remap);
+		return remap[i];
+	}
+}
+
+static GENC_INLINE void mph_set_remap(genc_perfect_hash_table_t* table, size_t search_slot, size_t slot)
+{
+	size_t i = search_slot - table->item_count;
+	if (mph_remap_is_wide(table))
+	{
+		size_t* remap = GENC_CXX_CAST(size_t*, table->remap);
+		remap[i] = slot;
+	}
+	else
+	{
+		uint32_t* remap = GENC_CXX_CAST(uint32_t*, table->remap);
+		remap[i] = (uint32_t)slot;
+	}
+}
+
+static GENC_INLINE char* mph_item_at(genc_perfect_hash_table_t* table, size_t slot)
+{
+	return GENC_CXX_CAST(char*, table->items) + table->bucket_size * slot;
+}
+
+static void* mph_alloc(genc_perfect_hash_table_t* table, size_t count, size_t elem_size)
+{
+	if (count > SIZE_MAX / elem_size)
+		return NULL;
+	return table->realloc_fn(NULL, 0, count * elem_size, table->opaque);
+}
+
+static void mph_free(genc_perfect_hash_table_t* table, void* ptr, size_t count, size_t elem_size)
+{
+	if (ptr)
+		table->realloc_fn(ptr, count * elem_size, 0, table->opaque);
+}
+
+/* Temporary arrays used while building */
+struct mph_build_state
+{
+	/* client hash of each item */
+	genc_hash_t* hashes;
+	/* slot hash of each item, in bucket order */
+	uint64_t* slot_hashes;
+	/* item indices sorted by bucket */
+	size_t* order;
+	/* start of each bucket's items in order; pilot_count + 1 entries */
+	size_t* bucket_start;
+	/* bucket indices, largest bucket first */
+	size_t* bucket_order;
+	/* one bit per search slot */
+	uint64_t* taken;
+	size_t taken_words;
+	/* mph_pilot_hash() of every pilot value for the current seed */
+	uint64_t* pilot_hashes;
+};
+
+static void mph_free_build_state(genc_perfect_hash_table_t* table, struct mph_build_state* state, size_t count)
+{
+	mph_free(table, state->hashes, count, sizeof(genc_hash_t));
+	mph_free(table, state->slot_hashes, count, sizeof(uint64_t));
+	mph_free(table, state->order, count, sizeof(size_t));
+	mph_free(table, state->bucket_start, table->pilot_count + 1u, sizeof(size_t));
+	mph_free(table, state->bucket_order, table->pilot_count, sizeof(size_t));
+	mph_free(table, state->taken, state->taken_words, sizeof(uint64_t));
+	mph_free(table, state->pilot_hashes, MPH_MAX_PILOT + 1u, sizeof(uint64_t));
+}
+
+/* Groups the items by bucket for the current seed, and orders the buckets by
+ * decreasing size: large buckets are the hardest to place, so they go first
+ * while most slots are still free. */
+static genc_bool_t mph_sort_buckets(genc_perfect_hash_table_t* table, struct mph_build_state* state)
+{
+	const size_t pilot_count = table->pilot_count;
+	size_t* size_start;
+	size_t i, b, max_size = 0;
+
+	memset(state->bucket_start, 0, (pilot_count + 1u) * sizeof(size_t));
+	for (i = 0; i < table->item_count; ++i)
+		++state->bucket_start[mph_bucket_for_hash(table, state->hashes[i]) + 1u];
+	for (b = 0; b < pilot_count; ++b)
+	{
+		if (state->bucket_start[b + 1u] > max_size)
+			max_size = state->bucket_start[b + 1u];
+		state->bucket_start[b + 1u] += state->bucket_start[b];
+	}
+	/* bucket_order serves as the insertion cursors for now */
+	memcpy(state->bucket_order, state->bucket_start, pilot_count * sizeof(size_t));
+	for (i = 0; i < table->item_count; ++i)
+		state->order[state->bucket_order[mph_bucket_for_hash(table, state->hashes[i])]++] = i;
+	for (i = 0; i < table->item_count; ++i)
+		state->slot_hashes[i] = mph_slot_hash(table, state->hashes[state->order[i]]);
+
+	/* counting sort by size, indexed by max_size - size for decreasing order */
+	size_start = GENC_CXX_CAST(size_t*, mph_alloc(table, max_size + 2u, sizeof(size_t)));
+	if (!size_start)
+		return 0;
+	memset(size_start, 0, (max_size + 2u) * sizeof(size_t));
+	for (b = 0; b < pilot_count; ++b)
+		++size_start[max_size - (state->bucket_start[b + 1u] - state->bucket_start[b]) + 1u];
+	for (i = 0; i <= max_size; ++i)
+		size_start[i + 1u] += size_start[i];
+	for (b = 0; b < pilot_count; ++b)
+		state->bucket_order[size_start[max_size - (state->bucket_start[b + 1u] - state->bucket_start[b])]++] = b;
+	mph_free(table, size_start, max_size + 2u, sizeof(size_t));
+	return 1;
+}
+
+/* Keys with equal hashes always land in the same bucket and collide for
+ * every pilot and seed, so check for them up front. */
+static genc_bool_t mph_has_duplicate_hashes(genc_perfect_hash_table_t* table, struct mph_build_state* state)
+{
+	size_t b, i, j;
+	for (b = 0; b < table->pilot_count; ++b)
+	{
+		for (i = state->bucket_start[b]; i < state->bucket_start[b + 1u]; ++i)
+		{
+			for (j = i + 1u; j < state->bucket_start[b + 1u]; ++j)
+			{
+				if (state->hashes[state->order[i]] == state->hashes[state->order[j]])
+					return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static GENC_INLINE genc_bool_t mph_is_taken(const uint64_t* taken, size_t slot)
+{
+	return (taken[slot / 64u] >> (slot % 64u)) & 1u;
+}
+
+/* Claims free slots for the items in order[start, end) using the given pilot,
+ * or claims nothing and returns false if any slot is already taken. */
+static genc_bool_t mph_try_pilot(
+	genc_perfect_hash_table_t* table, struct mph_build_state* state, size_t start, size_t end, uint16_t pilot)
+{
+	const uint64_t pilot_hash = state->pilot_hashes[pilot];
+	size_t i, j;
+	for (i = start; i < end; ++i)
+	{
+		size_t slot = mph_search_slot(table, state->slot_hashes[i], pilot_hash);
+		if (mph_is_taken(state->taken, slot))
+		{
+			for (j = start; j < i; ++j)
+			{
+				slot = mph_search_slot(table, state->slot_hashes[j], pilot_hash);
+				state->taken[slot / 64u] &= ~(UINT64_C(1) << (slot % 64u));
+			}
+			return 0;
+		}
+		state->taken[slot / 64u] |= UINT64_C(1) << (slot % 64u);
+	}
+	return 1;
+}
+
+/* Finds a pilot for every bucket, largest bucket first. Fails if some bucket
+ * can't be placed with any 16-bit pilot. */
+static genc_bool_t mph_search_pilots(genc_perfect_hash_table_t* table, struct mph_build_state* state)
+{
+	size_t k;
+	memset(state->taken, 0, state->taken_words * sizeof(uint64_t));
+	for (k = 0; k <= MPH_MAX_PILOT; ++k)
+		state->pilot_hashes[k] = mph_pilot_hash(table, (uint16_t)k);
+	for (k = 0; k < table->pilot_count; ++k)
+	{
+		size_t b = state->bucket_order[k];
+		unsigned pilot = 0;
+		while (!mph_try_pilot(table, state, state->bucket_start[b], state->bucket_start[b + 1u], (uint16_t)pilot))
+		{
+			if (pilot == MPH_MAX_PILOT)
+				return 0;
+			++pilot;
+		}
+		table->pilots[b] = (uint16_t)pilot;
+	}
+	return 1;
+}
+
+/* Points the search slots beyond the item count at the free slots below it. */
+static void mph_fill_remap(genc_perfect_hash_table_t* table, struct mph_build_state* state)
+{
+	size_t slot, free_slot = 0;
+	for (slot = table->item_count; slot < table->slot_count; ++slot)
+	{
+		if (mph_is_taken(state->taken, slot))
+		{
+			while (mph_is_taken(state->taken, free_slot))
+				++free_slot;
+			mph_set_remap(table, slot, free_slot++);
+		}
+		else
+		{
+			/* only reached by keys outside the set, which fail verification */
+			mph_set_remap(table, slot, 0);
+		}
+	}
+}
+
+genc_bool_t genc_perfect_hash_table_build(
+	genc_perfect_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size,
+	const void* items,
+	size_t count)
+{
+	const char* src = GENC_CXX_CAST(const char*, items);
+	struct mph_build_state state;
+	size_t i, b;
+	unsigned attempt;
+	genc_bool_t ok = 0;
+
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->key_equality_fn = key_equality_fn;
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	table->bucket_size = bucket_size;
+	table->item_count = count;
+	table->seed = MPH_INITIAL_SEED;
+	table->pilots = NULL;
+	table->remap = NULL;
+	table->items = NULL;
+	table->pilot_count = 0;
+	table->slot_count = 0;
+	if (bucket_size == 0)
+		return 0;
+	if (count == 0)
+		return 1;
+	if (count > SIZE_MAX / 2u)
+		return 0;
+
+	table->pilot_count = count / GENC_MPH_KEYS_PER_BUCKET + 1u;
+	table->slot_count = count + count / 100u * (100u - GENC_MPH_LOAD_PERCENT) + 1u;
+
+	memset(&state, 0, sizeof(state));
+	state.taken_words = (table->slot_count + 63u) / 64u;
+	state.hashes = GENC_CXX_CAST(genc_hash_t*, mph_alloc(table, count, sizeof(genc_hash_t)));
+	state.slot_hashes = GENC_CXX_CAST(uint64_t*, mph_alloc(table, count, sizeof(uint64_t)));
+	state.order = GENC_CXX_CAST(size_t*, mph_alloc(table, count, sizeof(size_t)));
+	state.bucket_start = GENC_CXX_CAST(size_t*, mph_alloc(table, table->pilot_count + 1u, sizeof(size_t)));
+	state.bucket_order = GENC_CXX_CAST(size_t*, mph_alloc(table, table->pilot_count, sizeof(size_t)));
+	state.taken = GENC_CXX_CAST(uint64_t*, mph_alloc(table, state.taken_words, sizeof(uint64_t)));
+	state.pilot_hashes = GENC_CXX_CAST(uint64_t*, mph_alloc(table, MPH_MAX_PILOT + 1u, sizeof(uint64_t)));
+	table->pilots = GENC_CXX_CAST(uint16_t*, mph_alloc(table, table->pilot_count, sizeof(uint16_t)));
+	table->remap = mph_alloc(table, table->slot_count - count, mph_remap_entry_size(table));
+	table->items = mph_alloc(table, count, bucket_size);
+	if (!state.hashes || !state.slot_hashes || !state.order || !state.bucket_start || !state.bucket_order
+		|| !state.taken || !state.pilot_hashes || !table->pilots || !table->remap || !table->items)
+		goto done;
+
+	for (i = 0; i < count; ++i)
+		state.hashes[i] = hash_fn(get_key_fn((void*)(src + i * bucket_size), opaque), opaque);
+
+	for (attempt = 0; attempt < MPH_MAX_ATTEMPTS; ++attempt)
+	{
+		if (!mph_sort_buckets(table, &state))
+			goto done;
+		if (attempt == 0 && mph_has_duplicate_hashes(table, &state))
+			goto done;
+		if (mph_search_pilots(table, &state))
+			break;
+		table->seed = genc_hash_next_seed(table->seed);
+	}
+	if (attempt == MPH_MAX_ATTEMPTS)
+		goto done;
+
+	mph_fill_remap(table, &state);
+	for (b = 0; b < table->pilot_count; ++b)
+	{
+		for (i = state.bucket_start[b]; i < state.bucket_start[b + 1u]; ++i)
+		{
+			size_t slot = mph_final_slot(table, mph_search_slot(table, state.slot_hashes[i], state.pilot_hashes[table->pilots[b]]));
+			memcpy(mph_item_at(table, slot), src + state.order[i] * bucket_size, bucket_size);
+		}
+	}
+	ok = 1;
+
+done:
+	mph_free_build_state(table, &state, count);
+	if (!ok)
+		genc_mph_destroy(table);
+	return ok;
+}
+
+void genc_mph_destroy(genc_perfect_hash_table_t* table)
+{
+	mph_free(table, table->pilots, table->pilot_count, sizeof(uint16_t));
+	mph_free(table, table->remap, table->slot_count - table->item_count, mph_remap_entry_size(table));
+	mph_free(table, table->items, table->item_count, table->bucket_size);
+	table->pilots = NULL;
+	table->remap = NULL;
+	table->items = NULL;
+	table->item_count = 0;
+	table->pilot_count = 0;
+	table->slot_count = 0;
+}
+
+size_t genc_mph_count(genc_perfect_hash_table_t* table)
+{
+	return table->item_count;
+}
+
+size_t genc_mph_slot(genc_perfect_hash_table_t* table, void* key)
+{
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	uint16_t pilot = table->pilots[mph_bucket_for_hash(table, hash)];
+	return mph_final_slot(table, mph_search_slot(table, mph_slot_hash(table, hash), mph_pilot_hash(table, pilot)));
+}
+
+void* genc_mph_item_at(genc_perfect_hash_table_t* table, size_t slot)
+{
+	return mph_item_at(table, slot);
+}
+
+void* genc_mph_find(genc_perfect_hash_table_t* table, void* key)
+{
+	void* item;
+	if (table->item_count == 0)
+		return NULL;
+	item = mph_item_at(table, genc_mph_slot(table, key));
+	if (!table->key_equality_fn(key, table->get_key_fn(item, table->opaque), table->opaque))
+		return NULL;
+	return item;
+}
+
+size_t genc_mph_index_size(genc_perfect_hash_table_t* table)
+{
+	return table->pilot_count * sizeof(uint16_t) + (table->slot_count - table->item_count) * mph_remap_entry_size(table);
+}
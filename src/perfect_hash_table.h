@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * Static hash table built around a minimal perfect hash function, for key sets
+ * which are built once and then only read. Construction follows PTHash: keys
+ * are split into buckets of about GENC_MPH_KEYS_PER_BUCKET keys, and for each
+ * bucket (largest first) a 16-bit "pilot" value is searched for which sends all
+ * of the bucket's keys to free slots. With slightly more slots than keys (see
+ * GENC_MPH_LOAD_PERCENT), the few keys landing beyond the item count are
+ * remapped into the holes below it, so the n items occupy slots 0 to n - 1 with
+ * no holes.
+ *
+ * A lookup hashes the key, reads one pilot and computes the slot, then checks
+ * that the item there actually has the key (a perfect hash function maps keys
+ * outside the set to arbitrary slots). Besides the items themselves, the table
+ * needs 16 bits per bucket, about 2.7 bits per key, plus 32 bits for each of
+ * the ~1% remapped slots: about 3 bits per key in total.
+ *
+ * The keys' client hashes must be distinct - 64-bit hashes of distinct keys
+ * practically always are. Building fails on duplicate keys or hashes.
+ */
+
+#ifndef GENCCONT_PERFECT_HASH_TABLE_H
+#define GENCCONT_PERFECT_HASH_TABLE_H
+
+#include "hash_shared.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Average number of keys sharing a pilot value */
+#define GENC_MPH_KEYS_PER_BUCKET 6
+/* Keys as a percentage of the slots the pilot search places them in */
+#define GENC_MPH_LOAD_PERCENT 99
+
+struct genc_perfect_hash_table
+{
+	genc_key_hash_fn hash_fn;
+	genc_hash_get_item_key_fn get_key_fn;
+	genc_hash_key_equality_fn key_equality_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+	size_t bucket_size; /* bytes per item */
+	/* Number of items, and of slots in the items array */
+	size_t item_count;
+	/* Number of pilot values */
+	size_t pilot_count;
+	/* Number of slots used during the pilot search, >= item_count */
+	size_t slot_count;
+	/* Seed mixed into the client's hashes; changed if the pilot search fails */
+	uint64_t seed;
+	uint16_t* pilots;
+	/* Final slot for each search slot >= item_count: uint32_t entries, or
+	 * size_t entries if item_count > UINT32_MAX */
+	void* remap;
+	void* items;
+};
+typedef struct genc_perfect_hash_table genc_perfect_hash_table_t;
+
+/* Builds the table from copies of the count items in the items array (each
+ * bucket_size bytes). Returns false on allocation failure, or if two items
+ * have equal keys or key hashes. */
+genc_bool_t genc_perfect_hash_table_build(
+	genc_perfect_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size, /* bytes per item */
+	const void* items,
+	size_t count);
+
+/* Deallocates the table's memory. */
+void genc_mph_destroy(genc_perfect_hash_table_t* table);
+
+/* Returns the number of items in the table. */
+size_t genc_mph_count(genc_perfect_hash_table_t* table);
+
+/* Returns the slot (0 to count - 1) the key maps to. For keys which aren't in
+ * the table, this is an arbitrary slot. Can be used to index arrays of
+ * additional per-key data. The table must not be empty. */
+size_t genc_mph_slot(genc_perfect_hash_table_t* table, void* key);
+
+/* Returns the item in the given slot. */
+void* genc_mph_item_at(genc_perfect_hash_table_t* table, size_t slot);
+
+/* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
+void* genc_mph_find(genc_perfect_hash_table_t* table, void* key);
+
+/* Returns the number of bytes used by the table, excluding the items. */
+size_t genc_mph_index_size(genc_perfect_hash_table_t* table);
+
+#define genc_mph_find_obj(table, key, type) \
+GENC_CXX_CAST(type*, genc_mph_find(table, key))
+
+#define genc_mph_item_at_obj(table, slot, type) \
+GENC_CXX_CAST(type*, genc_mph_item_at(table, slot))
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
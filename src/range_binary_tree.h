@@ -31,6 +31,8 @@
 extern "C" {
 #endif
 
+/* Ranges in a range binary tree never overlap. See interval_tree.h for a
+ * variant which allows overlapping ranges. */
 struct genc_range_binary_tree_item
 {
 	genc_bt_node_head_t head;
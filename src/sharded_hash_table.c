@@ -0,0 +1,257 @@
+#include "sharded_hash_table.h"
+
+#if !defined(KERNEL) && !defined(__KERNEL__)
+#include <string.h>
+#endif
+
+static void* sharded_alloc_shards(genc_realloc_fn realloc_fn, void* opaque, unsigned shard_count_log2, size_t shard_size)
+{
+	size_t count;
+	if (shard_count_log2 >= sizeof(size_t) * 8)
+		return NULL;
+	count = (size_t)1 << shard_count_log2;
+	if (SIZE_MAX / shard_size < count)
+		return NULL;
+	return realloc_fn(NULL, 0, count * shard_size, opaque);
+}
+
+
+genc_bool_t genc_sharded_cht_init(
+	genc_sharded_cht_t* table,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	unsigned shard_count_log2,
+	size_t initial_shard_capacity_pow2,
+	uint8_t load_percent_grow_threshold,
+	uint8_t load_percent_shrink_threshold)
+{
+	size_t i, count;
+	struct genc_sharded_cht_shard* shards = GENC_CXX_CAST(struct genc_sharded_cht_shard*,
+		sharded_alloc_shards(realloc_fn, opaque, shard_count_log2, sizeof(struct genc_sharded_cht_shard)));
+	if (!shards)
+		return 0;
+	count = (size_t)1 << shard_count_log2;
+	for (i = 0; i < count; ++i)
+	{
+		genc_spinlock_init(&shards[i].lock);
+		if (!genc_chaining_hash_table_init_ext(
+			&shards[i].table, hash_fn, get_key_fn, key_equality_fn, realloc_fn, opaque,
+			initial_shard_capacity_pow2, load_percent_grow_threshold, load_percent_shrink_threshold))
+		{
+			while (i > 0)
+				genc_cht_destroy(&shards[--i].table);
+			realloc_fn(shards, count * sizeof(shards[0]), 0, opaque);
+			return 0;
+		}
+	}
+	table->shards = shards;
+	table->shard_count_log2 = shard_count_log2;
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	return 1;
+}
+
+void genc_sharded_cht_destroy(genc_sharded_cht_t* table)
+{
+	size_t i, count = (size_t)1 << table->shard_count_log2;
+	if (!table->shards)
+		return;
+	for (i = 0; i < count; ++i)
+		genc_cht_destroy(&table->shards[i].table);
+	table->realloc_fn(table->shards, count * sizeof(table->shards[0]), 0, table->opaque);
+	table->shards = NULL;
+}
+
+size_t genc_sharded_cht_count(genc_sharded_cht_t* table)
+{
+	size_t i, count = (size_t)1 << table->shard_count_log2, items = 0;
+	for (i = 0; i < count; ++i)
+	{
+		struct genc_sharded_cht_shard* shard = &table->shards[i];
+		genc_spinlock_lock(&shard->lock);
+		items += genc_cht_count(&shard->table);
+		genc_spinlock_unlock(&shard->lock);
+	}
+	return items;
+}
+
+struct genc_sharded_cht_shard* genc_sharded_cht_shard_for_key(genc_sharded_cht_t* table, void* key)
+{
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	return &table->shards[genc_shard_index_for_hash(hash, table->shard_count_log2)];
+}
+
+genc_bool_t genc_sharded_cht_insert_item(genc_sharded_cht_t* table, struct slist_head* item)
+{
+	struct genc_sharded_cht_shard* shard;
+	genc_bool_t inserted;
+	if (!item)
+		return 0;
+	shard = genc_sharded_cht_shard_for_key(table, table->get_key_fn(item, table->opaque));
+	genc_spinlock_lock(&shard->lock);
+	inserted = genc_cht_insert_item(&shard->table, item);
+	genc_spinlock_unlock(&shard->lock);
+	return inserted;
+}
+
+struct slist_head* genc_sharded_cht_find(genc_sharded_cht_t* table, void* key)
+{
+	struct genc_sharded_cht_shard* shard = genc_sharded_cht_shard_for_key(table, key);
+	struct slist_head* found;
+	genc_spinlock_lock(&shard->lock);
+	found = genc_cht_find(&shard->table, key);
+	genc_spinlock_unlock(&shard->lock);
+	return found;
+}
+
+struct slist_head* genc_sharded_cht_remove(genc_sharded_cht_t* table, void* key)
+{
+	struct genc_sharded_cht_shard* shard = genc_sharded_cht_shard_for_key(table, key);
+	struct slist_head* removed;
+	genc_spinlock_lock(&shard->lock);
+	removed = genc_cht_remove(&shard->table, key);
+	genc_spinlock_unlock(&shard->lock);
+	return removed;
+}
+
+genc_bool_t genc_sharded_cht_remove_item(genc_sharded_cht_t* table, struct slist_head* item)
+{
+	struct genc_sharded_cht_shard* shard = genc_sharded_cht_shard_for_key(table, table->get_key_fn(item, table->opaque));
+	genc_bool_t removed;
+	genc_spinlock_lock(&shard->lock);
+	removed = genc_cht_remove_item(&shard->table, item);
+	genc_spinlock_unlock(&shard->lock);
+	return removed;
+}
+
+
+genc_bool_t genc_sharded_lpht_init(
+	genc_sharded_lpht_t* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	unsigned shard_count_log2,
+	size_t initial_shard_capacity_pow2)
+{
+	size_t i, count;
+	struct genc_sharded_lpht_shard* shards = GENC_CXX_CAST(struct genc_sharded_lpht_shard*,
+		sharded_alloc_shards(desc->realloc_fn, opaque, shard_count_log2, sizeof(struct genc_sharded_lpht_shard)));
+	if (!shards)
+		return 0;
+	count = (size_t)1 << shard_count_log2;
+	for (i = 0; i < count; ++i)
+	{
+		genc_spinlock_init(&shards[i].lock);
+		if (!genc_linear_probing_hash_table_light_init(&shards[i].table, desc, opaque, initial_shard_capacity_pow2))
+		{
+			while (i > 0)
+				genc_lphtl_destroy(&shards[--i].table, desc, opaque);
+			desc->realloc_fn(shards, count * sizeof(shards[0]), 0, opaque);
+			return 0;
+		}
+	}
+	table->shards = shards;
+	table->shard_count_log2 = shard_count_log2;
+	table->desc = desc;
+	table->opaque = opaque;
+	return 1;
+}
+
+void genc_sharded_lpht_destroy(genc_sharded_lpht_t* table)
+{
+	size_t i, count = (size_t)1 << table->shard_count_log2;
+	if (!table->shards)
+		return;
+	for (i = 0; i < count; ++i)
+		genc_lphtl_destroy(&table->shards[i].table, table->desc, table->opaque);
+	table->desc->realloc_fn(table->shards, count * sizeof(table->shards[0]), 0, table->opaque);
+	table->shards = NULL;
+}
+
+size_t genc_sharded_lpht_count(genc_sharded_lpht_t* table)
+{
+	size_t i, count = (size_t)1 << table->shard_count_log2, items = 0;
+	for (i = 0; i < count; ++i)
+	{
+		struct genc_sharded_lpht_shard* shard = &table->shards[i];
+		genc_spinlock_lock(&shard->lock);
+		items += genc_lphtl_count(&shard->table);
+		genc_spinlock_unlock(&shard->lock);
+	}
+	return items;
+}
+
+struct genc_sharded_lpht_shard* genc_sharded_lpht_shard_for_key(genc_sharded_lpht_t* table, void* key)
+{
+	genc_hash_t hash = table->desc->hash_fn(key, table->opaque);
+	return &table->shards[genc_shard_index_for_hash(hash, table->shard_count_log2)];
+}
+
+static struct genc_sharded_lpht_shard* sharded_lpht_shard_for_item(genc_sharded_lpht_t* table, void* item)
+{
+	const genc_linear_probing_hash_table_desc_t* desc = table->desc;
+	void* key;
+	if (desc->key_size)
+		key = GENC_CXX_CAST(char*, item) + desc->key_offset;
+	else
+		key = desc->get_key_fn(item, table->opaque);
+	return genc_sharded_lpht_shard_for_key(table, key);
+}
+
+genc_bool_t genc_sharded_lpht_insert_item(genc_sharded_lpht_t* table, void* item)
+{
+	struct genc_sharded_lpht_shard* shard;
+	genc_bool_t inserted;
+	if (!item)
+		return 0;
+	shard = sharded_lpht_shard_for_item(table, item);
+	genc_spinlock_lock(&shard->lock);
+	inserted = NULL != genc_lphtl_insert_item(&shard->table, table->desc, table->opaque, item);
+	genc_spinlock_unlock(&shard->lock);
+	return inserted;
+}
+
+genc_bool_t genc_sharded_lpht_insert_or_update_item(genc_sharded_lpht_t* table, void* item)
+{
+	struct genc_sharded_lpht_shard* shard;
+	genc_bool_t inserted;
+	if (!item)
+		return 0;
+	shard = sharded_lpht_shard_for_item(table, item);
+	genc_spinlock_lock(&shard->lock);
+	inserted = NULL != genc_lphtl_insert_or_update_item(&shard->table, table->desc, table->opaque, item);
+	genc_spinlock_unlock(&shard->lock);
+	return inserted;
+}
+
+genc_bool_t genc_sharded_lpht_find(genc_sharded_lpht_t* table, void* key, void* out_item)
+{
+	struct genc_sharded_lpht_shard* shard = genc_sharded_lpht_shard_for_key(table, key);
+	void* found;
+	genc_spinlock_lock(&shard->lock);
+	found = genc_lphtl_find(&shard->table, table->desc, table->opaque, key);
+	if (found && out_item)
+		memcpy(out_item, found, table->desc->bucket_size);
+	genc_spinlock_unlock(&shard->lock);
+	return found != NULL;
+}
+
+genc_bool_t genc_sharded_lpht_remove(genc_sharded_lpht_t* table, void* key, void* out_item)
+{
+	struct genc_sharded_lpht_shard* shard = genc_sharded_lpht_shard_for_key(table, key);
+	void* found;
+	genc_spinlock_lock(&shard->lock);
+	found = genc_lphtl_find(&shard->table, table->desc, table->opaque, key);
+	if (found)
+	{
+		if (out_item)
+			memcpy(out_item, found, table->desc->bucket_size);
+		genc_lphtl_remove(&shard->table, table->desc, table->opaque, found);
+	}
+	genc_spinlock_unlock(&shard->lock);
+	return found != NULL;
+}
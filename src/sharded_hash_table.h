@@ -0,0 +1,155 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * Thread-safe wrappers which split one logical hash table into 2^k
+ * independent shards, each a genc_chaining_hash_table or
+ * genc_linear_probing_hash_table_light_t with its own spinlock. Every
+ * operation locks only the shard its key maps to, and each shard grows and
+ * shrinks independently, so a resize only blocks the traffic for its shard.
+ *
+ * The shard is selected by the top k bits of the (remixed) key hash, which
+ * are independent of the low bits the shards use to pick buckets.
+ *
+ * For operations spanning several calls, lock the shard returned by
+ * genc_sharded_*_shard_for_key() and operate on its table directly.
+ */
+
+#ifndef GENCCONT_SHARDED_HASH_TABLE_H
+#define GENCCONT_SHARDED_HASH_TABLE_H
+
+#include "chaining_hash_table.h"
+#include "linear_probing_hash_table.h"
+#include "atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns the shard (out of 1 << shard_count_log2) for the given key hash. */
+static GENC_INLINE size_t genc_shard_index_for_hash(genc_hash_t hash, unsigned shard_count_log2)
+{
+	if (shard_count_log2 == 0)
+		return 0;
+	/* remix so weak client hashes still spread across shards */
+	return genc_hash_size(hash) >> (sizeof(size_t) * 8 - shard_count_log2);
+}
+
+
+struct genc_sharded_cht_shard
+{
+	genc_spinlock_t lock;
+	struct genc_chaining_hash_table table;
+};
+
+struct genc_sharded_cht
+{
+	struct genc_sharded_cht_shard* shards;
+	unsigned shard_count_log2;
+	genc_chaining_key_hash_fn hash_fn;
+	genc_chaining_hash_get_item_key_fn get_key_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+};
+typedef struct genc_sharded_cht genc_sharded_cht_t;
+
+/* Initialises 1 << shard_count_log2 empty shards with the given parameters
+ * (see genc_chaining_hash_table_init_ext). Initialisation and destruction must
+ * not race with any other operations. */
+genc_bool_t genc_sharded_cht_init(
+	genc_sharded_cht_t* table,
+	genc_chaining_key_hash_fn hash_fn,
+	genc_chaining_hash_get_item_key_fn get_key_fn,
+	genc_chaining_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	unsigned shard_count_log2,
+	size_t initial_shard_capacity_pow2,
+	uint8_t load_percent_grow_threshold,
+	uint8_t load_percent_shrink_threshold);
+
+/* Destroys all shards. Items are not touched. */
+void genc_sharded_cht_destroy(genc_sharded_cht_t* table);
+
+/* Total number of items; shards are counted one at a time, so the result is
+ * only a snapshot under concurrent modification. */
+size_t genc_sharded_cht_count(genc_sharded_cht_t* table);
+
+struct genc_sharded_cht_shard* genc_sharded_cht_shard_for_key(genc_sharded_cht_t* table, void* key);
+
+/* Like the genc_cht_* equivalents, but thread-safe. Note that a found item may
+ * be removed by another thread as soon as find returns; keeping it alive is up
+ * to the client. */
+genc_bool_t genc_sharded_cht_insert_item(genc_sharded_cht_t* table, struct slist_head* item);
+struct slist_head* genc_sharded_cht_find(genc_sharded_cht_t* table, void* key);
+struct slist_head* genc_sharded_cht_remove(genc_sharded_cht_t* table, void* key);
+genc_bool_t genc_sharded_cht_remove_item(genc_sharded_cht_t* table, struct slist_head* item);
+
+
+struct genc_sharded_lpht_shard
+{
+	genc_spinlock_t lock;
+	genc_linear_probing_hash_table_light_t table;
+};
+
+struct genc_sharded_lpht
+{
+	struct genc_sharded_lpht_shard* shards;
+	unsigned shard_count_log2;
+	const genc_linear_probing_hash_table_desc_t* desc;
+	void* opaque;
+};
+typedef struct genc_sharded_lpht genc_sharded_lpht_t;
+
+/* Initialises 1 << shard_count_log2 empty shards sharing the descriptor, which
+ * must remain valid for the lifetime of the table. */
+genc_bool_t genc_sharded_lpht_init(
+	genc_sharded_lpht_t* table,
+	const genc_linear_probing_hash_table_desc_t* desc,
+	void* opaque,
+	unsigned shard_count_log2,
+	size_t initial_shard_capacity_pow2);
+
+/* Destroys all shards, clearing their items. */
+void genc_sharded_lpht_destroy(genc_sharded_lpht_t* table);
+
+/* Total number of items, see genc_sharded_cht_count */
+size_t genc_sharded_lpht_count(genc_sharded_lpht_t* table);
+
+struct genc_sharded_lpht_shard* genc_sharded_lpht_shard_for_key(genc_sharded_lpht_t* table, void* key);
+
+/* Items live in the shards' bucket arrays, which may move as soon as the shard
+ * lock is dropped, so these copy items in and out (desc->bucket_size bytes)
+ * rather than returning bucket pointers.
+ * Insertion returns false on a duplicate key or growth failure. */
+genc_bool_t genc_sharded_lpht_insert_item(genc_sharded_lpht_t* table, void* item);
+genc_bool_t genc_sharded_lpht_insert_or_update_item(genc_sharded_lpht_t* table, void* item);
+/* Return true if the key was found, copying the item to out_item if non-NULL. */
+genc_bool_t genc_sharded_lpht_find(genc_sharded_lpht_t* table, void* key, void* out_item);
+genc_bool_t genc_sharded_lpht_remove(genc_sharded_lpht_t* table, void* key, void* out_item);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,462 @@
+#include "swiss_hash_table.h"
+#include <string.h>
+
+#if !defined(GENC_SHT_NO_SIMD) && !defined(KERNEL) && !defined(__KERNEL__)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHT_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SHT_USE_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+/* Control byte values. Occupied buckets hold 7 bits of the item's hash, so
+ * the top bit distinguishes occupied from empty/deleted buckets. */
+enum
+{
+	SHT_CTRL_EMPTY = 0x80,
+	SHT_CTRL_DELETED = 0xfe
+};
+
+/* Group match helpers: each returns a bitmask with bit i set if control byte i
+ * of the 16-byte group matches. */
+
+#if SHT_USE_SSE2
+
+static GENC_INLINE uint32_t sht_group_match(const uint8_t* group, uint8_t h2)
+{
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2)));
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty(const uint8_t* group)
+{
+	return sht_group_match(group, SHT_CTRL_EMPTY);
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty_or_deleted(const uint8_t* group)
+{
+	/* both markers have the top bit set, which is exactly what movemask picks out */
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (uint32_t)_mm_movemask_epi8(ctrl);
+}
+
+#elif SHT_USE_NEON
+
+static GENC_INLINE uint32_t sht_neon_bitmask(uint8x16_t cmp)
+{
+	/* NEON has no movemask; weight each lane's bit and sum the halves */
+	static const uint8_t lane_bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t masked = vandq_u8(cmp, vld1q_u8(lane_bits));
+	return (uint32_t)vaddv_u8(vget_low_u8(masked)) | ((uint32_t)vaddv_u8(vget_high_u8(masked)) << 8);
+}
+
+static GENC_INLINE uint32_t sht_group_match(const uint8_t* group, uint8_t h2)
+{
+	return sht_neon_bitmask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(h2)));
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty(const uint8_t* group)
+{
+	return sht_group_match(group, SHT_CTRL_EMPTY);
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty_or_deleted(const uint8_t* group)
+{
+	return sht_neon_bitmask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0)));
+}
+
+#else
+
+static GENC_INLINE uint32_t sht_group_match(const uint8_t* group, uint8_t h2)
+{
+	uint32_t mask = 0;
+	unsigned i;
+	for (i = 0; i < GENC_SHT_GROUP_SIZE; ++i)
+		mask |= (uint32_t)(group[i] == h2) << i;
+	return mask;
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty(const uint8_t* group)
+{
+	return sht_group_match(group, SHT_CTRL_EMPTY);
+}
+
+static GENC_INLINE uint32_t sht_group_match_empty_or_deleted(const uint8_t* group)
+{
+	uint32_t mask = 0;
+	unsigned i;
+	for (i = 0; i < GENC_SHT_GROUP_SIZE; ++i)
+		mask |= (uint32_t)(group[i] >> 7) << i;
+	return mask;
+}
+
+#endif
+
+/* Splits the client's hash into the group index source (h1, low bits, as with
+ * the other tables) and the 7-bit control byte tag (h2). h2 is taken from the
+ * top bits of a multiplicative remix so that weak client hashes (e.g. identity
+ * on small integers) still produce well-spread tags. */
+static GENC_INLINE uint8_t sht_h2(genc_hash_t hash)
+{
+#if defined(__LP64__) || defined(_WIN64)
+	return (uint8_t)(((uint64_t)hash * UINT64_C(0x9e3779b97f4a7c15)) >> 57);
+#else
+	return (uint8_t)(((uint32_t)hash * UINT32_C(0x9e3779b9)) >> 25);
+#endif
+}
+
+static GENC_INLINE char* sht_bucket_at(genc_swiss_hash_table_t* table, size_t idx)
+{
+	return GENC_CXX_CAST(char*, table->buckets) + table->bucket_size * idx;
+}
+
+static GENC_INLINE size_t sht_max_used(size_t capacity, uint8_t load_percent)
+{
+	/* buckets (items + tombstones) which may be in use before we must resize */
+	size_t max_used = capacity / 100u * load_percent + (capacity % 100u) * load_percent / 100u;
+	return max_used < capacity ? max_used : capacity - 1u;
+}
+
+/* Groups are probed quadratically (triangular numbers), which visits every
+ * group exactly once when the group count is a power of 2. */
+static GENC_INLINE size_t sht_next_group(size_t group, size_t probe_step, size_t group_mask)
+{
+	return (group + probe_step) & group_mask;
+}
+
+genc_bool_t genc_swiss_hash_table_init(
+	genc_swiss_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size,
+	size_t initial_capacity_pow2)
+{
+	return genc_swiss_hash_table_init_ext(
+		table, hash_fn, get_key_fn, key_equality_fn, realloc_fn,
+		opaque, bucket_size, initial_capacity_pow2, 87);
+}
+
+static genc_bool_t sht_alloc_arrays(
+	genc_swiss_hash_table_t* table, size_t capacity, uint8_t** out_control, void** out_buckets)
+{
+	uint8_t* control;
+	void* buckets;
+	if (SIZE_MAX / table->bucket_size < capacity)
+		return 0;
+	control = GENC_CXX_CAST(uint8_t*, table->realloc_fn(NULL, 0, capacity, table->opaque));
+	if (!control)
+		return 0;
+	buckets = table->realloc_fn(NULL, 0, capacity * table->bucket_size, table->opaque);
+	if (!buckets)
+	{
+		table->realloc_fn(control, capacity, 0, table->opaque);
+		return 0;
+	}
+	memset(control, SHT_CTRL_EMPTY, capacity);
+	*out_control = control;
+	*out_buckets = buckets;
+	return 1;
+}
+
+genc_bool_t genc_swiss_hash_table_init_ext(
+	genc_swiss_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size,
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold)
+{
+	size_t capacity;
+	if (load_percent_grow_threshold < 1 || load_percent_grow_threshold > 99)
+		return 0;
+	if (bucket_size == 0)
+		return 0;
+
+	capacity = GENC_SHT_GROUP_SIZE;
+	while (capacity < initial_capacity_pow2)
+	{
+		if (capacity > SIZE_MAX / 2)
+			return 0;
+		capacity *= 2;
+	}
+
+	table->hash_fn = hash_fn;
+	table->get_key_fn = get_key_fn;
+	table->key_equality_fn = key_equality_fn;
+	table->realloc_fn = realloc_fn;
+	table->opaque = opaque;
+	table->bucket_size = bucket_size;
+	table->load_percent_grow_threshold = load_percent_grow_threshold;
+	table->item_count = 0;
+	table->deleted_count = 0;
+
+	if (!sht_alloc_arrays(table, capacity, &table->control, &table->buckets))
+		return 0;
+	table->capacity = capacity;
+	return 1;
+}
+
+size_t genc_sht_count(genc_swiss_hash_table_t* table)
+{
+	return table->item_count;
+}
+
+size_t genc_sht_capacity(genc_swiss_hash_table_t* table)
+{
+	return table->capacity;
+}
+
+void genc_sht_destroy(genc_swiss_hash_table_t* table)
+{
+	if (table->control)
+		table->realloc_fn(table->control, table->capacity, 0, table->opaque);
+	if (table->buckets)
+		table->realloc_fn(table->buckets, table->capacity * table->bucket_size, 0, table->opaque);
+	table->control = NULL;
+	table->buckets = NULL;
+	table->capacity = 0;
+	table->item_count = 0;
+	table->deleted_count = 0;
+}
+
+void genc_sht_clear(genc_swiss_hash_table_t* table)
+{
+	memset(table->control, SHT_CTRL_EMPTY, table->capacity);
+	table->item_count = 0;
+	table->deleted_count = 0;
+}
+
+/* Returns the bucket index of the item with the given key, or SIZE_MAX if not found. */
+static size_t sht_find_index(genc_swiss_hash_table_t* table, void* key, genc_hash_t hash)
+{
+	const uint8_t h2 = sht_h2(hash);
+	const size_t group_mask = table->capacity / GENC_SHT_GROUP_SIZE - 1u;
+	size_t group = hash & group_mask;
+	size_t step = 0;
+	while (1)
+	{
+		const uint8_t* ctrl = table->control + group * GENC_SHT_GROUP_SIZE;
+		uint32_t match = sht_group_match(ctrl, h2);
+		while (match)
+		{
+			size_t idx = group * GENC_SHT_GROUP_SIZE + __builtin_ctz(match);
+			void* item = sht_bucket_at(table, idx);
+			if (table->key_equality_fn(key, table->get_key_fn(item, table->opaque), table->opaque))
+				return idx;
+			match &= match - 1u;
+		}
+		/* an empty bucket in this group means the key was never pushed beyond it */
+		if (sht_group_match_empty(ctrl))
+			return SIZE_MAX;
+		++step;
+		if (step > group_mask)
+			return SIZE_MAX; /* visited every group */
+		group = sht_next_group(group, step, group_mask);
+	}
+}
+
+/* Finds the first empty or deleted bucket in the hash's probe sequence. The
+ * table must not be full. */
+static size_t sht_find_insert_index(const uint8_t* control, size_t capacity, genc_hash_t hash)
+{
+	const size_t group_mask = capacity / GENC_SHT_GROUP_SIZE - 1u;
+	size_t group = hash & group_mask;
+	size_t step = 0;
+	while (1)
+	{
+		uint32_t avail = sht_group_match_empty_or_deleted(control + group * GENC_SHT_GROUP_SIZE);
+		if (avail)
+			return group * GENC_SHT_GROUP_SIZE + __builtin_ctz(avail);
+		++step;
+		group = sht_next_group(group, step, group_mask);
+	}
+}
+
+/* Reinserts all items into freshly allocated arrays of the given capacity,
+ * dropping tombstones. */
+static genc_bool_t sht_rehash(genc_swiss_hash_table_t* table, size_t new_capacity)
+{
+	uint8_t* new_control;
+	void* new_buckets;
+	size_t i;
+	if (!sht_alloc_arrays(table, new_capacity, &new_control, &new_buckets))
+		return 0;
+
+	for (i = 0; i < table->capacity; ++i)
+	{
+		void* item;
+		genc_hash_t hash;
+		size_t new_idx;
+		if (table->control[i] & 0x80)
+			continue;
+		item = sht_bucket_at(table, i);
+		hash = table->hash_fn(table->get_key_fn(item, table->opaque), table->opaque);
+		new_idx = sht_find_insert_index(new_control, new_capacity, hash);
+		new_control[new_idx] = table->control[i];
+		memcpy(GENC_CXX_CAST(char*, new_buckets) + new_idx * table->bucket_size, item, table->bucket_size);
+	}
+
+	table->realloc_fn(table->control, table->capacity, 0, table->opaque);
+	table->realloc_fn(table->buckets, table->capacity * table->bucket_size, 0, table->opaque);
+	table->control = new_control;
+	table->buckets = new_buckets;
+	table->capacity = new_capacity;
+	table->deleted_count = 0;
+	return 1;
+}
+
+/* Makes room for one more item, rebuilding or growing the table if needed. */
+static genc_bool_t sht_prepare_insert(genc_swiss_hash_table_t* table)
+{
+	size_t max_used = sht_max_used(table->capacity, table->load_percent_grow_threshold);
+	if (table->item_count + table->deleted_count < max_used)
+		return 1;
+	/* Mostly tombstones: purge them rather than doubling the memory footprint */
+	if (table->deleted_count > table->item_count / 2u
+		&& table->item_count < sht_max_used(table->capacity, table->load_percent_grow_threshold / 2u + 1u))
+		return sht_rehash(table, table->capacity);
+	if (table->capacity > SIZE_MAX / 2)
+		return 0;
+	return sht_rehash(table, table->capacity * 2u);
+}
+
+static void* sht_insert_new(genc_swiss_hash_table_t* table, void* item, genc_hash_t hash)
+{
+	size_t idx;
+	void* bucket;
+	if (!sht_prepare_insert(table))
+		return NULL;
+	idx = sht_find_insert_index(table->control, table->capacity, hash);
+	if (table->control[idx] == SHT_CTRL_DELETED)
+		--table->deleted_count;
+	table->control[idx] = sht_h2(hash);
+	bucket = sht_bucket_at(table, idx);
+	memcpy(bucket, item, table->bucket_size);
+	++table->item_count;
+	return bucket;
+}
+
+void* genc_sht_insert_item(genc_swiss_hash_table_t* table, void* item)
+{
+	void* key = table->get_key_fn(item, table->opaque);
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	if (sht_find_index(table, key, hash) != SIZE_MAX)
+		return NULL;
+	return sht_insert_new(table, item, hash);
+}
+
+void* genc_sht_insert_or_update_item(genc_swiss_hash_table_t* table, void* item)
+{
+	void* key = table->get_key_fn(item, table->opaque);
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	size_t idx = sht_find_index(table, key, hash);
+	if (idx != SIZE_MAX)
+	{
+		void* bucket = sht_bucket_at(table, idx);
+		memcpy(bucket, item, table->bucket_size);
+		return bucket;
+	}
+	return sht_insert_new(table, item, hash);
+}
+
+void* genc_sht_find(genc_swiss_hash_table_t* table, void* key)
+{
+	genc_hash_t hash = table->hash_fn(key, table->opaque);
+	size_t idx = sht_find_index(table, key, hash);
+	if (idx == SIZE_MAX)
+		return NULL;
+	return sht_bucket_at(table, idx);
+}
+
+void genc_sht_remove(genc_swiss_hash_table_t* table, void* item)
+{
+	size_t idx = (size_t)(GENC_CXX_CAST(char*, item) - GENC_CXX_CAST(char*, table->buckets)) / table->bucket_size;
+	const uint8_t* group = table->control + (idx & ~(size_t)(GENC_SHT_GROUP_SIZE - 1u));
+	/* Control bytes only ever go from empty to occupied between rehashes, so if
+	 * the group still has an empty bucket, it has never been full and no probe
+	 * sequence continues past it. The bucket can then simply become empty. */
+	if (sht_group_match_empty(group))
+	{
+		table->control[idx] = SHT_CTRL_EMPTY;
+	}
+	else
+	{
+		table->control[idx] = SHT_CTRL_DELETED;
+		++table->deleted_count;
+	}
+	--table->item_count;
+}
+
+genc_bool_t genc_sht_reserve_space(genc_swiss_hash_table_t* table, size_t target_count)
+{
+	size_t capacity = table->capacity;
+	while (sht_max_used(capacity, table->load_percent_grow_threshold) <= target_count)
+	{
+		if (capacity > SIZE_MAX / 2)
+			return 0;
+		capacity *= 2;
+	}
+	if (capacity == table->capacity)
+		return 1;
+	return sht_rehash(table, capacity);
+}
+
+genc_bool_t genc_sht_verify(genc_swiss_hash_table_t* table)
+{
+	size_t i;
+	size_t items = 0, deleted = 0;
+	for (i = 0; i < table->capacity; ++i)
+	{
+		uint8_t ctrl = table->control[i];
+		void* item;
+		void* key;
+		genc_hash_t hash;
+		if (ctrl == SHT_CTRL_DELETED)
+		{
+			++deleted;
+			continue;
+		}
+		if (ctrl == SHT_CTRL_EMPTY)
+			continue;
+		if (ctrl & 0x80)
+			return 0;
+		++items;
+		item = sht_bucket_at(table, i);
+		key = table->get_key_fn(item, table->opaque);
+		hash = table->hash_fn(key, table->opaque);
+		if (ctrl != sht_h2(hash))
+			return 0;
+		if (sht_find_index(table, key, hash) != i)
+			return 0;
+	}
+	return items == table->item_count && deleted == table->deleted_count;
+}
+
+static void* sht_first_item_from(genc_swiss_hash_table_t* table, size_t idx)
+{
+	for (; idx < table->capacity; ++idx)
+	{
+		if (!(table->control[idx] & 0x80))
+			return sht_bucket_at(table, idx);
+	}
+	return NULL;
+}
+
+void* genc_sht_first_item(genc_swiss_hash_table_t* table)
+{
+	return sht_first_item_from(table, 0);
+}
+
+void* genc_sht_next_item(genc_swiss_hash_table_t* table, void* cur_item)
+{
+	size_t idx = (size_t)(GENC_CXX_CAST(char*, cur_item) - GENC_CXX_CAST(char*, table->buckets)) / table->bucket_size;
+	return sht_first_item_from(table, idx + 1u);
+}
@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/*
+ * An open addressing hash table in the style of Google's "Swiss table":
+ * Alongside the (client-defined, memcpy-able) buckets, a control byte array
+ * holds 7 bits of each occupied bucket's hash, or an empty/deleted marker.
+ * Buckets are probed in groups of 16, testing all 16 control bytes at once
+ * with SSE2 or NEON compares where available, and scalar code otherwise.
+ * Key comparisons only happen on 7-bit hash matches, and an unsuccessful
+ * lookup stops at the first group containing an empty bucket, so lookups
+ * remain fast at high load factors (default maximum: 87%).
+ *
+ * Compared to the linear probing table, there are no empty/clear callbacks,
+ * as emptiness is tracked in the control bytes. Removal leaves tombstones
+ * which are purged on the next resize. The table does not shrink.
+ *
+ * Define GENC_SHT_NO_SIMD to force the scalar implementation. (Kernel builds
+ * always use it.)
+ */
+
+#ifndef GENCCONT_SWISS_HASH_TABLE_H
+#define GENCCONT_SWISS_HASH_TABLE_H
+
+#include "hash_shared.h"
+
+#if defined(KERNEL) && defined(APPLE)
+/* xnu kernel */
+/* xnu for some reason doesn't typedef ptrdiff_t. To avoid stepping on toes,
+ * we'll temporarily re-#define it in case another header typedefs it */
+#define ptrdiff_t __darwin_ptrdiff_t
+#elif !defined(__KERNEL__) && !defined(KERNEL)
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of buckets whose control bytes are tested at once */
+#define GENC_SHT_GROUP_SIZE 16
+
+struct genc_swiss_hash_table
+{
+	genc_key_hash_fn hash_fn;
+	genc_hash_get_item_key_fn get_key_fn;
+	genc_hash_key_equality_fn key_equality_fn;
+	genc_realloc_fn realloc_fn;
+	void* opaque;
+	size_t bucket_size; /* bytes per item */
+	/* Total number of buckets, a power of 2 and multiple of GENC_SHT_GROUP_SIZE */
+	size_t capacity;
+	/* Number of filled buckets */
+	size_t item_count;
+	/* Number of buckets holding tombstones of removed items */
+	size_t deleted_count;
+	/* One control byte per bucket */
+	uint8_t* control;
+	void* buckets;
+	uint8_t load_percent_grow_threshold;
+};
+typedef struct genc_swiss_hash_table genc_swiss_hash_table_t;
+
+/* Initialises the empty hash table with the given function implementations and capacity.
+ * The default load factor threshold for growing (87%) is used. Capacity is
+ * rounded up to GENC_SHT_GROUP_SIZE. */
+genc_bool_t genc_swiss_hash_table_init(
+	genc_swiss_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn /* Make sure this fulfils the buckets' alignment requirements! */,
+	void* opaque,
+	size_t bucket_size, /* bytes per item */
+	size_t initial_capacity_pow2);
+
+/* Initialises the hash table with a non-default growth threshold (1-99). Tombstones
+ * count towards the load factor; if they make up a large part of it, the table
+ * is rebuilt at the same size rather than grown. */
+genc_bool_t genc_swiss_hash_table_init_ext(
+	genc_swiss_hash_table_t* table,
+	genc_key_hash_fn hash_fn,
+	genc_hash_get_item_key_fn get_key_fn,
+	genc_hash_key_equality_fn key_equality_fn,
+	genc_realloc_fn realloc_fn,
+	void* opaque,
+	size_t bucket_size, /* bytes per item */
+	size_t initial_capacity_pow2,
+	uint8_t load_percent_grow_threshold);
+
+/* Returns the current number of items in the hash table. */
+size_t genc_sht_count(genc_swiss_hash_table_t* table);
+
+/* Returns the number of buckets allocated. */
+size_t genc_sht_capacity(genc_swiss_hash_table_t* table);
+
+/* Drops all items from the table and deallocates bucket and control array memory. */
+void genc_sht_destroy(genc_swiss_hash_table_t* table);
+
+/* Drops all items from the table but does not resize or deallocate it. */
+void genc_sht_clear(genc_swiss_hash_table_t* table);
+
+/* Inserts a copy of the given item into the hash table.
+ * Returns NULL to report failure due to a duplicate or growth failure, pointer
+ * to inserted bucket on success. */
+void* genc_sht_insert_item(genc_swiss_hash_table_t* table, void* item);
+/* As genc_sht_insert_item, but overwrites any existing item with the same key. */
+void* genc_sht_insert_or_update_item(genc_swiss_hash_table_t* table, void* item);
+
+/* Looks up the key in the table, returning the matching item if present, or NULL otherwise. */
+void* genc_sht_find(genc_swiss_hash_table_t* table, void* key);
+
+/* Removes the item from the hash table. item must point to the location of the
+ * value within the table - i.e. returned by genc_sht_find or genc_sht_insert_item */
+void genc_sht_remove(genc_swiss_hash_table_t* table, void* item);
+
+/* Resizes the table, if necessary, so that it will not need resizing to hold
+ * target_count items. */
+genc_bool_t genc_sht_reserve_space(genc_swiss_hash_table_t* table, size_t target_count);
+
+/* Walks all the elements in the hash table and checks they can be found. */
+genc_bool_t genc_sht_verify(genc_swiss_hash_table_t* table);
+
+/* Iterating over all the items in the table: */
+
+/* First non-empty bucket. */
+void* genc_sht_first_item(genc_swiss_hash_table_t* table);
+/* Next non-empty bucket */
+void* genc_sht_next_item(genc_swiss_hash_table_t* table, void* cur_item);
+
+#define genc_sht_first_obj(table, type) \
+GENC_CXX_CAST(type*, genc_sht_first_item(table))
+
+#define genc_sht_next_obj(table, cur_obj, type) \
+GENC_CXX_CAST(type*, genc_sht_next_item(table, GENC_CXX_CAST(type*, cur_obj)))
+
+#define genc_sht_find_obj(table, key, type) \
+GENC_CXX_CAST(type*, genc_sht_find(table, key))
+
+#define genc_sht_insert_obj(table, new_obj, type) \
+GENC_CXX_CAST(type*, genc_sht_insert_item(table, GENC_CXX_CAST(type*, new_obj)))
+
+#define genc_sht_for_each_obj(type, obj_var, table) \
+for (type* obj_var = genc_sht_first_obj(table, type); obj_var != NULL; obj_var = genc_sht_next_obj(table, obj_var, type))
+
+#if defined(KERNEL) && defined(APPLE)
+#undef ptrdiff_t
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
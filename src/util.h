@@ -80,6 +80,14 @@ typedef char genc_bool_t;
 #define GENC_UNUSED
 #endif
 
+/* Hint to the CPU that the memory at ADDR will be read soon. Used for
+ * overlapping cache misses in batch operations. */
+#if defined(__GNUC__)
+#define GENC_PREFETCH(ADDR) __builtin_prefetch(ADDR)
+#else
+#define GENC_PREFETCH(ADDR) ((void)(ADDR))
+#endif
+
 
 	
 /** genc_container_of(obj, cont_type, member_name)
@@ -51,6 +51,7 @@ static void check_order_invariant(genc_binary_tree_t* tree, int num_expected, in
 	int i = 0;
 	int prev_key = 0;
 	btt_item_t* cur = genc_bt_first_obj(tree, btt_item_t, bt_head);
+	assert(genc_bt_verify(tree));
 	while (cur)
 	{
 		++i;
@@ -88,10 +89,28 @@ static void check_order_invariant(genc_binary_tree_t* tree, int num_expected, in
 }
 
 
-void test_manual()
+static void init_tree(genc_binary_tree_t* tree, int red_black)
+{
+	if (red_black)
+		genc_binary_tree_init_rb(tree, btt_item_less, &dummy);
+	else
+		genc_binary_tree_init(tree, btt_item_less, &dummy);
+}
+
+static int subtree_depth(genc_bt_node_head_t* node)
+{
+	int left, right;
+	if (!node)
+		return 0;
+	left = subtree_depth(node->left);
+	right = subtree_depth(node->right);
+	return 1 + (left > right ? left : right);
+}
+
+void test_manual(int red_black)
 {
 	genc_binary_tree_t* tree = malloc(sizeof(genc_binary_tree_t));
-	genc_binary_tree_init(tree, btt_item_less, &dummy);
+	init_tree(tree, red_black);
 	
 	assert(genc_bt_first_obj(tree, btt_item_t, bt_head) == NULL);
 	assert(genc_bt_last_obj(tree, btt_item_t, bt_head) == NULL);
@@ -210,7 +229,7 @@ void test_manual()
 }
 
 // do lots of pseudo-random insertions and removals, checking consistency at every step
-void test_random()
+void test_random(int red_black)
 {
 	srand(42);
 	int i, j;
@@ -218,7 +237,7 @@ void test_random()
 	{
 		size_t num_items = 10 + rand() % 1000;
 		genc_binary_tree_t* tree = malloc(sizeof(genc_binary_tree_t));
-		genc_binary_tree_init(tree, btt_item_less, &dummy);
+		init_tree(tree, red_black);
 
 		printf("Testing with %lu items\n", num_items);
 		btt_item_t* items = calloc(sizeof(btt_item_t), num_items);
@@ -288,9 +307,50 @@ void test_random()
 	}
 }
 
+// ascending insertion degenerates an unbalanced tree into a list, red-black trees must stay shallow
+void test_sequential_rb()
+{
+	const int num_items = 100000;
+	int j, depth_limit = 0;
+	genc_binary_tree_t tree;
+	btt_item_t* items = calloc(sizeof(btt_item_t), num_items);
+	genc_binary_tree_init_rb(&tree, btt_item_less, &dummy);
+	
+	for (j = 0; j < num_items; ++j)
+	{
+		items[j].key = j + 1;
+		items[j].data = -items[j].key;
+		int ok = genc_bt_insert(&tree, &items[j].bt_head);
+		assert(ok);
+	}
+	assert(genc_bt_verify(&tree));
+	assert(genc_bt_first_obj(&tree, btt_item_t, bt_head) == items);
+	assert(genc_bt_last_obj(&tree, btt_item_t, bt_head) == items + num_items - 1);
+	
+	/* red-black tree height is bounded by 2 * log2(n + 1) */
+	while ((1 << depth_limit) <= num_items)
+		++depth_limit;
+	assert(subtree_depth(tree.root) <= 2 * depth_limit);
+	
+	/* remove the lower half in ascending order, which also keeps moving min_node */
+	for (j = 0; j < num_items / 2; ++j)
+	{
+		genc_bt_remove(&tree, &items[j].bt_head);
+		assert(genc_bt_first_obj(&tree, btt_item_t, bt_head) == items + j + 1);
+	}
+	assert(genc_bt_verify(&tree));
+	assert(subtree_depth(tree.root) <= 2 * depth_limit);
+	check_order_invariant(&tree, num_items - num_items / 2, 0);
+	
+	free(items);
+}
+
 int main()
 {
-	test_manual();
-	test_random();
+	test_manual(0);
+	test_random(0);
+	test_manual(1);
+	test_random(1);
+	test_sequential_rb();
 	return 0;
 }
@@ -0,0 +1,198 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#include "../../src/bucket_chaining_hash_table.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct bcht_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+static genc_bool_t fail_allocations = 0;
+
+static void* bcht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	if (fail_allocations)
+		return NULL;
+	return realloc(old, new_size);
+}
+
+static void* bcht_test_get_key(void* item, void* opaque)
+{
+	return &((struct bcht_test_item*)item)->key;
+}
+
+/* deliberately weak: only 16 distinct values, so chains overflow */
+static genc_hash_t bcht_test_weak_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)(*(uint64_t*)key % 16);
+}
+
+static void test_random_ops(genc_key_hash_fn hash_fn)
+{
+	enum { KEY_RANGE = 5000 };
+	genc_bucket_chaining_hash_table_t table;
+	struct bcht_test_item* items = calloc(KEY_RANGE, sizeof(items[0]));
+	genc_bool_t* present = calloc(KEY_RANGE, sizeof(present[0]));
+	size_t i, count = 0, iterated;
+	uint64_t key;
+	struct bcht_test_item* item;
+	void* removed;
+	genc_bool_t ok;
+
+	ok = genc_bucket_chaining_hash_table_init(
+		&table, hash_fn, bcht_test_get_key, genc_uint64_keys_equal, bcht_test_realloc, NULL, 4);
+	assert(ok);
+	for (key = 0; key < KEY_RANGE; ++key)
+	{
+		items[key].key = key;
+		items[key].val = key * 7;
+	}
+	srand(1);
+	for (i = 0; i < 40000; ++i)
+	{
+		key = (uint64_t)rand() % KEY_RANGE;
+		switch (rand() % 4)
+		{
+		case 0:
+		case 1:
+			ok = genc_bcht_insert_item(&table, &items[key]);
+			assert(ok == !present[key]);
+			if (!present[key])
+				++count;
+			present[key] = 1;
+			break;
+		case 2:
+			removed = genc_bcht_remove(&table, &key);
+			assert(removed == (present[key] ? &items[key] : NULL));
+			if (present[key])
+				--count;
+			present[key] = 0;
+			break;
+		default:
+			ok = genc_bcht_remove_item(&table, &items[key]);
+			assert(ok == present[key]);
+			if (present[key])
+				--count;
+			present[key] = 0;
+			break;
+		}
+		assert(genc_bcht_count(&table) == count);
+		if (i % 1000 == 0)
+			assert(genc_bcht_verify(&table));
+	}
+	assert(genc_bcht_verify(&table));
+	for (key = 0; key < KEY_RANGE; ++key)
+		assert(genc_bcht_find(&table, &key) == (present[key] ? &items[key] : NULL));
+
+	iterated = 0;
+	for (item = genc_bcht_first_obj(&table, struct bcht_test_item); item;
+	     item = genc_bcht_next_obj(&table, item, struct bcht_test_item))
+	{
+		assert(present[item->key]);
+		assert(item->val == item->key * 7);
+		++iterated;
+	}
+	assert(iterated == count);
+
+	genc_bcht_destroy(&table);
+	free(items);
+	free(present);
+}
+
+static void test_allocation_failure(void)
+{
+	enum { NUM_ITEMS = 1000 };
+	genc_bucket_chaining_hash_table_t table;
+	struct bcht_test_item* items = calloc(NUM_ITEMS, sizeof(items[0]));
+	struct genc_bcht_bucket* bucket;
+	size_t i, b, capacity;
+	uint64_t key;
+	void* removed;
+	genc_bool_t ok;
+
+	ok = genc_bucket_chaining_hash_table_init(
+		&table, bcht_test_weak_hash, bcht_test_get_key, genc_uint64_keys_equal, bcht_test_realloc, NULL, 16);
+	assert(ok);
+	for (i = 0; i < NUM_ITEMS / 2; ++i)
+	{
+		items[i].key = i;
+		ok = genc_bcht_insert_item(&table, &items[i]);
+		assert(ok);
+	}
+	assert(table.overflow_count > 0);
+	/* overflow buckets are cache line aligned like the main array */
+	for (b = 0; b < genc_bcht_capacity(&table); ++b)
+	{
+		for (bucket = &table.buckets[b]; bucket; bucket = bucket->overflow)
+			assert((uintptr_t)bucket % GENC_BCHT_BUCKET_BYTES == 0);
+	}
+
+	/* growing fails, and so does adding overflow buckets, but the table stays intact */
+	capacity = genc_bcht_capacity(&table);
+	fail_allocations = 1;
+	ok = genc_bcht_reserve_space(&table, NUM_ITEMS * 10);
+	assert(!ok);
+	for (; i < NUM_ITEMS; ++i)
+	{
+		items[i].key = i;
+		if (!genc_bcht_insert_item(&table, &items[i]))
+			break;
+	}
+	assert(i < NUM_ITEMS);
+	fail_allocations = 0;
+	assert(genc_bcht_capacity(&table) == capacity);
+	assert(genc_bcht_verify(&table));
+	for (key = 0; key < NUM_ITEMS; ++key)
+		assert(genc_bcht_find(&table, &key) == (key < i ? &items[key] : NULL));
+
+	/* removing everything frees all overflow buckets */
+	for (key = 0; key < i; ++key)
+	{
+		removed = genc_bcht_remove(&table, &key);
+		assert(removed == &items[key]);
+	}
+	assert(table.overflow_count == 0);
+	assert(genc_bcht_verify(&table));
+	genc_bcht_destroy(&table);
+	free(items);
+}
+
+int main(void)
+{
+	test_random_ops(genc_uint64_key_hash);
+	test_random_ops(bcht_test_weak_hash);
+	test_allocation_failure();
+	printf("Bucket chaining hash table tests passed\n");
+	return 0;
+}
@@ -0,0 +1,303 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/cache.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+static void* cache_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	return realloc(old, new_size);
+}
+
+struct test_obj
+{
+	genc_cache_entry_t cache_entry;
+	unsigned key;
+	genc_bool_t evicted;
+};
+typedef struct test_obj test_obj_t;
+
+static genc_hash_t cache_test_hash(void* key, void* opaque)
+{
+	return genc_hash_uint32(*(unsigned*)key);
+}
+
+static void* cache_test_get_key(struct slist_head* hash_head, void* opaque)
+{
+	return &genc_container_of(hash_head, test_obj_t, cache_entry.hash_head)->key;
+}
+
+static genc_bool_t cache_test_keys_equal(void* key1, void* key2, void* opaque)
+{
+	return *(unsigned*)key1 == *(unsigned*)key2;
+}
+
+static void cache_test_evict(genc_cache_entry_t* entry, void* opaque)
+{
+	test_obj_t* obj = genc_cache_entry_obj(entry, test_obj_t, cache_entry);
+	size_t* evict_count = (size_t*)opaque;
+	assert(!obj->evicted);
+	obj->evicted = 1;
+	++*evict_count;
+}
+
+static void cache_test_init(genc_cache_t* cache, genc_cache_policy_t policy, size_t capacity, size_t* evict_count)
+{
+	genc_bool_t ok;
+	*evict_count = 0;
+	ok = genc_cache_init(
+		cache, policy, capacity, 0, cache_test_hash, cache_test_get_key, cache_test_keys_equal,
+		cache_test_evict, cache_test_realloc, evict_count);
+	assert(ok);
+}
+
+static genc_bool_t cache_test_contains(genc_cache_t* cache, unsigned key)
+{
+	return genc_cache_peek(cache, &key) != NULL;
+}
+
+static test_obj_t* cache_test_objs(size_t count)
+{
+	size_t i;
+	test_obj_t* objs = calloc(count, sizeof(objs[0]));
+	for (i = 0; i < count; ++i)
+		objs[i].key = (unsigned)i;
+	return objs;
+}
+
+static void test_lru(void)
+{
+	genc_cache_t cache;
+	size_t evict_count;
+	test_obj_t* objs = cache_test_objs(10);
+	test_obj_t* obj;
+	genc_cache_entry_t* found;
+	genc_bool_t ok;
+	unsigned i, key;
+	
+	cache_test_init(&cache, GENC_CACHE_LRU, 4, &evict_count);
+	for (i = 0; i < 4; ++i)
+	{
+		ok = genc_cache_insert(&cache, &objs[i].cache_entry, 1);
+		assert(ok);
+	}
+	ok = genc_cache_insert(&cache, &objs[2].cache_entry, 1);
+	assert(!ok);
+	assert(evict_count == 0);
+	
+	/* 0 becomes the most recently used, so 1 is evicted next */
+	key = 0;
+	obj = genc_cache_find_obj(&cache, &key, test_obj_t, cache_entry);
+	assert(obj == &objs[0]);
+	ok = genc_cache_insert(&cache, &objs[4].cache_entry, 1);
+	assert(ok);
+	assert(evict_count == 1 && objs[1].evicted);
+	assert(!cache_test_contains(&cache, 1));
+	/* peeking doesn't count as a use */
+	assert(cache_test_contains(&cache, 2));
+	ok = genc_cache_insert(&cache, &objs[5].cache_entry, 1);
+	assert(ok);
+	assert(objs[2].evicted);
+	genc_cache_verify(&cache);
+	
+	/* removal doesn't call the callback */
+	key = 3;
+	found = genc_cache_remove(&cache, &key);
+	assert(found == &objs[3].cache_entry);
+	found = genc_cache_remove(&cache, &key);
+	assert(!found);
+	genc_cache_remove_entry(&cache, &objs[0].cache_entry);
+	assert(!objs[3].evicted && !objs[0].evicted);
+	assert(genc_cache_count(&cache) == 2);
+	genc_cache_verify(&cache);
+	
+	genc_cache_destroy(&cache);
+	assert(objs[4].evicted && objs[5].evicted);
+	assert(evict_count == 4);
+	free(objs);
+}
+
+static void test_clock(void)
+{
+	genc_cache_t cache;
+	size_t evict_count;
+	test_obj_t* objs = cache_test_objs(10);
+	genc_cache_entry_t* found;
+	genc_bool_t ok;
+	unsigned i, key;
+	
+	cache_test_init(&cache, GENC_CACHE_CLOCK, 4, &evict_count);
+	for (i = 0; i < 4; ++i)
+	{
+		ok = genc_cache_insert(&cache, &objs[i].cache_entry, 1);
+		assert(ok);
+	}
+	/* referenced entries get a second chance */
+	key = 0;
+	found = genc_cache_find(&cache, &key);
+	assert(found);
+	key = 2;
+	found = genc_cache_find(&cache, &key);
+	assert(found);
+	ok = genc_cache_insert(&cache, &objs[4].cache_entry, 1);
+	assert(ok);
+	assert(objs[1].evicted && evict_count == 1);
+	ok = genc_cache_insert(&cache, &objs[5].cache_entry, 1);
+	assert(ok);
+	assert(objs[3].evicted && evict_count == 2);
+	/* the second chance has been used up */
+	ok = genc_cache_insert(&cache, &objs[6].cache_entry, 1);
+	assert(ok);
+	assert(objs[0].evicted && evict_count == 3);
+	genc_cache_verify(&cache);
+	genc_cache_destroy(&cache);
+	assert(evict_count == 7);
+	free(objs);
+}
+
+static void test_s3fifo(void)
+{
+	enum { CAPACITY = 100, HOT = 50, SCAN = 1000 };
+	genc_cache_t cache;
+	size_t evict_count;
+	test_obj_t* objs = cache_test_objs(HOT + SCAN);
+	genc_cache_entry_t* found;
+	genc_bool_t ok;
+	unsigned i, key;
+	
+	cache_test_init(&cache, GENC_CACHE_S3FIFO, CAPACITY, &evict_count);
+	/* a hot set that's hit a few times gets promoted to the main queue... */
+	for (i = 0; i < HOT; ++i)
+	{
+		ok = genc_cache_insert(&cache, &objs[i].cache_entry, 1);
+		assert(ok);
+		found = genc_cache_find(&cache, &i);
+		assert(found);
+	}
+	/* ...so a scan of one-hit wonders many times the cache size doesn't flush
+	 * it, even though there are more than CAPACITY - HOT insertions between
+	 * hits (which would defeat LRU) */
+	for (i = HOT; i < HOT + SCAN; ++i)
+	{
+		ok = genc_cache_insert(&cache, &objs[i].cache_entry, 1);
+		assert(ok);
+		if (i % 80 == 0)
+		{
+			for (key = 0; key < HOT; ++key)
+			{
+				found = genc_cache_find(&cache, &key);
+				assert(found);
+			}
+			genc_cache_verify(&cache);
+		}
+	}
+	for (key = 0; key < HOT; ++key)
+		assert(cache_test_contains(&cache, key));
+	assert(genc_cache_count(&cache) == CAPACITY);
+	assert(evict_count == HOT + SCAN - CAPACITY);
+	
+	/* a recently evicted key is remembered by the ghost set and readmitted
+	 * straight into the main queue */
+	key = HOT + SCAN - CAPACITY;
+	assert(objs[key].evicted && !cache_test_contains(&cache, key));
+	objs[key].evicted = 0;
+	ok = genc_cache_insert(&cache, &objs[key].cache_entry, 1);
+	assert(ok);
+	assert(objs[key].cache_entry.queue == GENC_CACHE_QUEUE_MAIN);
+	objs[0].evicted = 0;
+	key = 0;
+	genc_cache_remove(&cache, &key);
+	ok = genc_cache_insert(&cache, &objs[0].cache_entry, 1);
+	assert(ok);
+	assert(objs[0].cache_entry.queue == GENC_CACHE_QUEUE_SMALL);
+	genc_cache_verify(&cache);
+	
+	genc_cache_destroy(&cache);
+	assert(evict_count == HOT + SCAN + 1);
+	free(objs);
+}
+
+static void test_charges(void)
+{
+	genc_cache_policy_t policy;
+	genc_cache_t cache;
+	size_t evict_count;
+	test_obj_t* objs = cache_test_objs(200);
+	genc_cache_entry_t* found;
+	genc_bool_t ok;
+	unsigned i;
+	
+	for (policy = GENC_CACHE_LRU; policy <= GENC_CACHE_S3FIFO; policy = (genc_cache_policy_t)(policy + 1))
+	{
+		for (i = 0; i < 200; ++i)
+			objs[i].evicted = 0;
+		evict_count = 0;
+		ok = genc_cache_init(
+			&cache, policy, 1000, 64, cache_test_hash, cache_test_get_key, cache_test_keys_equal,
+			cache_test_evict, cache_test_realloc, &evict_count);
+		assert(ok);
+		ok = genc_cache_insert(&cache, &objs[0].cache_entry, 1001);
+		assert(!ok);
+		assert(genc_cache_count(&cache) == 0);
+		for (i = 0; i < 200; ++i)
+		{
+			ok = genc_cache_insert(&cache, &objs[i].cache_entry, 10 + i % 90);
+			assert(ok);
+			assert(genc_cache_charge(&cache) <= 1000);
+			if (i % 3 == 0)
+			{
+				found = genc_cache_find(&cache, &i);
+				assert(found);
+			}
+		}
+		genc_cache_verify(&cache);
+		assert(genc_cache_count(&cache) + evict_count == 200);
+		/* one big entry displaces everything */
+		if (!genc_cache_remove(&cache, &objs[0].key))
+			assert(objs[0].evicted);
+		objs[0].evicted = 0;
+		evict_count = 0;
+		ok = genc_cache_insert(&cache, &objs[0].cache_entry, 1000);
+		assert(ok);
+		assert(genc_cache_count(&cache) == 1);
+		genc_cache_verify(&cache);
+		
+		genc_cache_set_capacity(&cache, 500);
+		assert(objs[0].evicted && genc_cache_count(&cache) == 0);
+		assert(genc_cache_capacity(&cache) == 500);
+		genc_cache_destroy(&cache);
+	}
+	free(objs);
+}
+
+int main(void)
+{
+	test_lru();
+	test_clock();
+	test_s3fifo();
+	test_charges();
+	printf("cache tests passed\n");
+	return 0;
+}
@@ -67,6 +67,288 @@ static test_entry_t entry3 = { {NULL}, 3, 300 };
 static test_entry_t entry4 = { {NULL}, 4, 400 };
 static test_entry_t entry5 = { {NULL}, 5, 500 };
 
+/* Grows a table with incremental resizing enabled, checking all items remain
+ * reachable at every stage of migration. */
+static void test_incremental_resize(void)
+{
+	enum { NUM_ENTRIES = 5000 };
+	genc_chaining_hash_table_t table;
+	test_entry_t* entries = calloc(NUM_ENTRIES, sizeof(entries[0]));
+	unsigned i, j, key;
+	genc_bool_t saw_resize = 0;
+	size_t count;
+	genc_cht_head_t* found;
+	int res;
+	
+	genc_chaining_hash_table_init(&table, cht_test_hash, cht_test_get_key, cht_test_keys_equal, cht_test_realloc, NULL, 4);
+	genc_cht_set_incremental_resize(&table, 2);
+	for (i = 0; i < NUM_ENTRIES; ++i)
+	{
+		entries[i].key = i;
+		entries[i].val = i * 10;
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(!res);
+		if (genc_cht_is_resizing(&table))
+			saw_resize = 1;
+		if (i % 97 == 0)
+		{
+			genc_cht_verify(&table);
+			for (j = 0; j <= i; j += 13)
+			{
+				found = genc_cht_find(&table, &j);
+				assert(found == &entries[j].hash_head);
+			}
+		}
+	}
+	assert(saw_resize);
+	
+	/* removal during migration */
+	for (key = 0; key < NUM_ENTRIES; key += 3)
+	{
+		found = genc_cht_remove(&table, &key);
+		assert(found == &entries[key].hash_head);
+	}
+	genc_cht_verify(&table);
+	
+	genc_cht_complete_resize(&table);
+	assert(!genc_cht_is_resizing(&table));
+	genc_cht_verify(&table);
+	count = 0;
+	for (genc_cht_head_t* cur = genc_cht_first_item(&table); cur; cur = genc_cht_next_item(&table, cur))
+	{
+		assert(genc_container_of(cur, test_entry_t, hash_head)->key % 3 != 0);
+		++count;
+	}
+	assert(count == genc_cht_count(&table));
+	assert(count == NUM_ENTRIES - (NUM_ENTRIES + 2) / 3);
+	
+	genc_cht_destroy(&table);
+	free(entries);
+}
+
+/* Seed 0 stands in for a seed known to an attacker: all keys collide */
+static genc_hash_t cht_test_weak_seeded_hash(void* key, uint64_t seed, void* opaque)
+{
+	if (seed == 0)
+		return 0;
+	return genc_uint32_key_hash_seeded(key, seed, opaque);
+}
+
+static genc_hash_t cht_test_constant_seeded_hash(void* key, uint64_t seed, void* opaque)
+{
+	return 42;
+}
+
+static void test_reseeding(void)
+{
+	enum { NUM_ENTRIES = 1000 };
+	genc_chaining_hash_table_t table;
+	test_entry_t* entries = calloc(NUM_ENTRIES, sizeof(entries[0]));
+	genc_hash_table_stats_snapshot_t snap;
+	unsigned i;
+	int res;
+	
+	genc_chaining_hash_table_init(&table, cht_test_hash, cht_test_get_key, cht_test_keys_equal, cht_test_realloc, NULL, 16);
+	for (i = 0; i < 10; ++i)
+	{
+		entries[i].key = i;
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+	}
+	/* switching hash function rehashes existing items */
+	genc_cht_set_seeded_hash(&table, cht_test_weak_seeded_hash, 0);
+	genc_cht_verify(&table);
+	genc_cht_set_max_chain_length(&table, 8);
+	for (; i < NUM_ENTRIES; ++i)
+	{
+		entries[i].key = i;
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(!res);
+	}
+	/* new seeds depend on the table's address, so natural collisions may
+	 * trigger further reseeds; only the chain length bound is deterministic */
+	assert(table.reseed_count >= 1);
+	assert(table.seed != 0);
+	assert(table.max_chain_length >= 8);
+	genc_cht_stats_snapshot(&table, &snap);
+	assert(snap.longest_chain <= table.max_chain_length);
+	genc_cht_verify(&table);
+	for (i = 0; i < NUM_ENTRIES; ++i)
+		assert(genc_cht_find(&table, &i) == &entries[i].hash_head);
+	
+	genc_cht_reseed(&table, 12345);
+	genc_cht_verify(&table);
+	for (i = 0; i < NUM_ENTRIES; ++i)
+		assert(genc_cht_find(&table, &i) == &entries[i].hash_head);
+	genc_cht_destroy(&table);
+	
+	/* reseeding can't help here, so the limit backs off instead */
+	genc_chaining_hash_table_init(&table, cht_test_hash, cht_test_get_key, cht_test_keys_equal, cht_test_realloc, NULL, 16);
+	genc_cht_set_seeded_hash(&table, cht_test_constant_seeded_hash, 0);
+	genc_cht_set_max_chain_length(&table, 4);
+	for (i = 0; i < 100; ++i)
+	{
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+	}
+	assert(table.reseed_count == 5);
+	assert(table.max_chain_length == 128);
+	genc_cht_verify(&table);
+	for (i = 0; i < 100; ++i)
+		assert(genc_cht_find(&table, &i) == &entries[i].hash_head);
+	genc_cht_destroy(&table);
+	free(entries);
+}
+
+/* Counts the items in the key's range, checking they all have the key */
+static size_t cht_test_range_length(genc_chaining_hash_table_t* table, unsigned key)
+{
+	genc_cht_range_t range = genc_cht_find_range(table, &key);
+	genc_slist_head_t* cur;
+	size_t length = 0;
+	assert(!range.first == !range.last);
+	genc_cht_for_each_in_range(range, cur)
+	{
+		assert(genc_container_of(cur, test_entry_t, hash_head)->key == key);
+		++length;
+	}
+	return length;
+}
+
+static void test_multimap(void)
+{
+	enum { NUM_KEYS = 300, VALS_PER_KEY = 7, NUM_ENTRIES = NUM_KEYS * VALS_PER_KEY };
+	genc_chaining_hash_table_t table;
+	test_entry_t* entries = calloc(NUM_ENTRIES, sizeof(entries[0]));
+	unsigned i, key;
+	genc_cht_head_t* found;
+	int res;
+	
+	genc_chaining_hash_table_init(&table, cht_test_hash, cht_test_get_key, cht_test_keys_equal, cht_test_realloc, NULL, 4);
+	genc_cht_set_multimap(&table, 1);
+	genc_cht_set_incremental_resize(&table, 2);
+	/* interleave the keys so equal keys arrive between other insertions and resizes */
+	for (i = 0; i < NUM_ENTRIES; ++i)
+	{
+		entries[i].key = i % NUM_KEYS;
+		entries[i].val = i;
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+		/* the most recent insertion comes first */
+		found = genc_cht_find(&table, &entries[i].key);
+		assert(found == &entries[i].hash_head);
+		if (i % 101 == 0)
+			genc_cht_verify(&table);
+	}
+	assert(genc_cht_count(&table) == NUM_ENTRIES);
+	genc_cht_verify(&table);
+	for (key = 0; key < NUM_KEYS; ++key)
+		assert(cht_test_range_length(&table, key) == VALS_PER_KEY);
+	key = NUM_KEYS;
+	assert(cht_test_range_length(&table, key) == 0);
+	
+	/* runs survive rehashing */
+	genc_cht_set_seeded_hash(&table, genc_uint32_key_hash_seeded, 99);
+	genc_cht_verify(&table);
+	for (key = 0; key < NUM_KEYS; ++key)
+		assert(cht_test_range_length(&table, key) == VALS_PER_KEY);
+	
+	/* remove a value from the middle of each run, then whole runs until the table shrinks */
+	for (key = 0; key < NUM_KEYS; ++key)
+	{
+		res = genc_cht_remove_item(&table, &entries[NUM_KEYS * 3 + key].hash_head);
+		assert(res);
+		res = genc_cht_remove_item(&table, &entries[NUM_KEYS * 3 + key].hash_head);
+		assert(!res);
+	}
+	genc_cht_verify(&table);
+	for (key = 0; key < NUM_KEYS; ++key)
+		assert(cht_test_range_length(&table, key) == VALS_PER_KEY - 1);
+	for (key = 0; key < NUM_KEYS; key += 4)
+	{
+		for (i = 0; i < VALS_PER_KEY - 1; ++i)
+		{
+			found = genc_cht_remove(&table, &key);
+			assert(found);
+		}
+		found = genc_cht_remove(&table, &key);
+		assert(!found);
+	}
+	genc_cht_shrink_by(&table, 1);
+	genc_cht_verify(&table);
+	for (key = 0; key < NUM_KEYS; ++key)
+		assert(cht_test_range_length(&table, key) == (key % 4 == 0 ? 0 : VALS_PER_KEY - 1));
+	
+	genc_cht_destroy(&table);
+	free(entries);
+}
+
+static void test_stats(void)
+{
+	enum { NUM_ENTRIES = 1000 };
+	genc_chaining_hash_table_t table;
+	genc_hash_table_stats_snapshot_t snap;
+	test_entry_t* entries = calloc(NUM_ENTRIES, sizeof(entries[0]));
+	unsigned i;
+	size_t bin, total;
+	genc_cht_head_t* found;
+	int res;
+	
+	genc_chaining_hash_table_init_ext(&table, cht_test_hash, cht_test_get_key, cht_test_keys_equal, cht_test_realloc, NULL, 4, 70, 20);
+	for (i = 0; i < NUM_ENTRIES; ++i)
+	{
+		entries[i].key = i;
+		res = genc_cht_insert_item(&table, &entries[i].hash_head);
+		assert(res);
+	}
+	res = genc_cht_insert_item(&table, &entries[0].hash_head);
+	assert(!res);
+	for (i = 0; i < NUM_ENTRIES + 500; ++i)
+		assert(!genc_cht_find(&table, &i) == (i >= NUM_ENTRIES));
+	for (i = 0; i < NUM_ENTRIES; i += 2)
+	{
+		found = genc_cht_remove(&table, &i);
+		assert(found);
+	}
+	/* half the items are gone, but not enough to trigger shrinking */
+	
+	genc_cht_stats_snapshot(&table, &snap);
+	assert(snap.item_count == NUM_ENTRIES / 2);
+	assert(snap.capacity == genc_cht_capacity(&table));
+	total = 0;
+	for (bin = 0; bin < GENC_HASH_STATS_HISTOGRAM_BINS; ++bin)
+		total += snap.chain_lengths[bin];
+	assert(total == snap.capacity);
+	assert(snap.longest_chain > 0);
+#if GENC_HASH_TABLE_STATS
+	assert(snap.ops.inserts == NUM_ENTRIES + 1);
+	assert(snap.ops.insert_duplicates == 1);
+	assert(snap.ops.lookups == NUM_ENTRIES + 500);
+	assert(snap.ops.lookup_hits == NUM_ENTRIES);
+	assert(snap.ops.removes == NUM_ENTRIES / 2);
+	assert(snap.ops.resizes == 9);
+	assert(snap.ops.items_moved > 0 && snap.ops.bytes_moved == 0);
+	total = 0;
+	for (bin = 0; bin < GENC_HASH_STATS_HISTOGRAM_BINS; ++bin)
+		total += snap.ops.probe_lengths[bin];
+	assert(total == 2 * NUM_ENTRIES + 501);
+	
+	/* counters survive reseeding, which counts as a rehash */
+	genc_cht_set_seeded_hash(&table, genc_uint32_key_hash_seeded, 1);
+	genc_cht_stats_snapshot(&table, &snap);
+	assert(snap.ops.rehashes == 1);
+	assert(snap.ops.inserts == NUM_ENTRIES + 1);
+#else
+	assert(snap.ops.inserts == 0 && snap.ops.lookups == 0);
+#endif
+	genc_cht_destroy(&table);
+	free(entries);
+}
+
 int main()
 {
 	genc_chaining_hash_table_t table;
@@ -219,6 +501,25 @@ int main()
 	assert(count == 3);
 	assert(res == 100 + 300 + 500);
 	
+	/* Test batch lookup of present and absent keys */
+	{
+		unsigned keys[5] = { 1, 2, 3, 4, 5 };
+		void* key_ptrs[5] = { &keys[0], &keys[1], &keys[2], &keys[3], &keys[4] };
+		genc_slist_head_t* found[5];
+		count = genc_cht_find_batch(&table, key_ptrs, found, 5);
+		assert(count == 3);
+		assert(found[0] == &entry1.hash_head);
+		assert(!found[1]);
+		assert(found[2] == &entry3.hash_head);
+		assert(!found[3]);
+		assert(found[4] == &entry5.hash_head);
+	}
+	
 	genc_cht_destroy(&table);
+	
+	test_incremental_resize();
+	test_reseeding();
+	test_multimap();
+	test_stats();
 	return 0;
 }
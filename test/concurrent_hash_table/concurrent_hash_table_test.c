@@ -0,0 +1,266 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/concurrent_hash_table.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define NUM_STABLE 2000
+#define NUM_VOLATILE 4000
+#define NUM_READERS 3
+#define NUM_WRITERS 2
+#define WRITER_ROUNDS 20
+
+struct test_entry
+{
+	struct slist_head hash_head;
+	unsigned key;
+};
+
+static void* ccht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	return realloc(old, new_size);
+}
+
+/* No grace period tracking in this test: retired arrays are kept until the end */
+#define MAX_RETIRED 64
+static void* retired[MAX_RETIRED];
+static unsigned num_retired = 0;
+
+static void ccht_test_retire(void* ptr, size_t size, void* opaque)
+{
+	/* only called with all stripe locks held, so no need for atomics */
+	assert(num_retired < MAX_RETIRED);
+	retired[num_retired++] = ptr;
+}
+
+static genc_hash_t ccht_test_hash(void* key, void* opaque)
+{
+	return genc_hash_uint32(*(unsigned*)key);
+}
+
+static void* ccht_test_get_key(struct slist_head* hash_head, void* opaque)
+{
+	return &genc_container_of(hash_head, struct test_entry, hash_head)->key;
+}
+
+static genc_bool_t ccht_test_keys_equal(void* key1, void* key2, void* opaque)
+{
+	return *(unsigned*)key1 == *(unsigned*)key2;
+}
+
+static genc_concurrent_hash_table_t table;
+static struct test_entry stable_entries[NUM_STABLE];
+static struct test_entry volatile_entries[NUM_VOLATILE];
+static int writers_done = 0;
+
+static void* reader_thread(void* arg)
+{
+	unsigned long lookups = 0;
+	while (!genc_atomic_load_acquire(&writers_done) || lookups < NUM_STABLE)
+	{
+		unsigned key = (unsigned)(lookups % NUM_STABLE);
+		struct test_entry* e = genc_ccht_find_obj(&table, &key, struct test_entry, hash_head);
+		assert(e == &stable_entries[key]);
+		/* keys beyond both ranges are never present */
+		key += NUM_STABLE + NUM_VOLATILE;
+		assert(!genc_ccht_find(&table, &key));
+		++lookups;
+	}
+	return NULL;
+}
+
+static void* writer_thread(void* arg)
+{
+	/* each writer owns alternate volatile entries */
+	unsigned first = (unsigned)(size_t)arg;
+	unsigned round, i;
+	struct slist_head* removed;
+	genc_bool_t ok;
+	for (round = 0; round < WRITER_ROUNDS; ++round)
+	{
+		for (i = first; i < NUM_VOLATILE; i += NUM_WRITERS)
+		{
+			ok = genc_ccht_insert_item(&table, &volatile_entries[i].hash_head);
+			assert(ok);
+		}
+		for (i = first; i < NUM_VOLATILE; i += NUM_WRITERS)
+		{
+			unsigned key = volatile_entries[i].key;
+			assert(genc_ccht_find(&table, &key) == &volatile_entries[i].hash_head);
+			ok = genc_ccht_insert_item(&table, &volatile_entries[i].hash_head);
+			assert(!ok);
+		}
+		for (i = first; i < NUM_VOLATILE; i += NUM_WRITERS)
+		{
+			if (i % 2)
+			{
+				unsigned key = volatile_entries[i].key;
+				removed = genc_ccht_remove(&table, &key);
+				assert(removed == &volatile_entries[i].hash_head);
+			}
+			else
+			{
+				ok = genc_ccht_remove_item(&table, &volatile_entries[i].hash_head);
+				assert(ok);
+			}
+		}
+		/* Reinserting straight away would be unsafe with real reclamation,
+		 * but all entries outlive the readers here. */
+	}
+	return NULL;
+}
+
+/* Items are moved to the new array a few buckets at a time, and stay
+ * findable meanwhile */
+static void test_incremental_resize(void)
+{
+	enum { NUM_ITEMS = 1200 };
+	static struct test_entry entries[NUM_ITEMS];
+	genc_concurrent_hash_table_t t;
+	unsigned i, key, first_resizing = 0;
+	unsigned retired_before = num_retired;
+	struct slist_head* removed;
+	genc_bool_t ok, resizing;
+
+	for (i = 0; i < NUM_ITEMS; ++i)
+		entries[i].key = i;
+	ok = genc_concurrent_hash_table_init(&t, ccht_test_hash, ccht_test_get_key, ccht_test_keys_equal, ccht_test_realloc, ccht_test_retire, NULL, 1024, 16, 100);
+	assert(ok);
+	for (i = 0; i < NUM_ITEMS; ++i)
+	{
+		ok = genc_ccht_insert_item(&t, &entries[i].hash_head);
+		assert(ok);
+		resizing = genc_ccht_resize_step(&t, 0);
+		if (resizing)
+		{
+			first_resizing = i;
+			break;
+		}
+	}
+	assert(resizing);
+	assert(genc_ccht_capacity(&t) == 2048);
+	/* nothing was retired yet, so the insertion didn't move everything */
+	assert(num_retired == retired_before);
+	for (key = 0; key <= first_resizing; ++key)
+		assert(genc_ccht_find(&t, &key) == &entries[key].hash_head);
+	key = NUM_ITEMS;
+	assert(!genc_ccht_find(&t, &key));
+
+	/* each further insertion only moves a few buckets */
+	for (i = first_resizing + 1; i < first_resizing + 4; ++i)
+	{
+		ok = genc_ccht_insert_item(&t, &entries[i].hash_head);
+		assert(ok);
+		resizing = genc_ccht_resize_step(&t, 0);
+		assert(resizing);
+	}
+	key = first_resizing + 1;
+	removed = genc_ccht_remove(&t, &key);
+	assert(removed == &entries[key].hash_head);
+	assert(!genc_ccht_find(&t, &key));
+
+	resizing = genc_ccht_resize_step(&t, 1);
+	assert(resizing);
+	resizing = genc_ccht_resize_step(&t, SIZE_MAX);
+	assert(!resizing);
+	assert(num_retired == retired_before + 1);
+	assert(genc_ccht_count(&t) == first_resizing + 3);
+	for (key = 0; key < first_resizing + 4; ++key)
+		assert(genc_ccht_find(&t, &key) == (key == first_resizing + 1 ? NULL : &entries[key].hash_head));
+	genc_ccht_destroy(&t);
+}
+
+int main(void)
+{
+	pthread_t readers[NUM_READERS];
+	pthread_t writers[NUM_WRITERS];
+	unsigned i;
+	size_t capacity;
+	genc_bool_t ok;
+	int res;
+
+	/* argument checks */
+	ok = genc_concurrent_hash_table_init(&table, ccht_test_hash, ccht_test_get_key, ccht_test_keys_equal, ccht_test_realloc, ccht_test_retire, NULL, 8, 16, 100);
+	assert(!ok);
+	ok = genc_concurrent_hash_table_init(&table, ccht_test_hash, ccht_test_get_key, ccht_test_keys_equal, ccht_test_realloc, ccht_test_retire, NULL, 12, 4, 100);
+	assert(!ok);
+
+	test_incremental_resize();
+
+	ok = genc_concurrent_hash_table_init(&table, ccht_test_hash, ccht_test_get_key, ccht_test_keys_equal, ccht_test_realloc, ccht_test_retire, NULL, 16, 16, 100);
+	assert(ok);
+	assert(genc_ccht_count(&table) == 0);
+	assert(genc_ccht_capacity(&table) == 16);
+
+	for (i = 0; i < NUM_STABLE; ++i)
+	{
+		stable_entries[i].key = i;
+		ok = genc_ccht_insert_item(&table, &stable_entries[i].hash_head);
+		assert(ok);
+	}
+	assert(genc_ccht_count(&table) == NUM_STABLE);
+	capacity = genc_ccht_capacity(&table);
+	assert(capacity >= NUM_STABLE);
+	for (i = 0; i < NUM_VOLATILE; ++i)
+		volatile_entries[i].key = NUM_STABLE + i;
+
+	/* readers must always find all stable keys while writers churn the
+	 * volatile ones and grow the table */
+	for (i = 0; i < NUM_READERS; ++i)
+	{
+		res = pthread_create(&readers[i], NULL, reader_thread, NULL);
+		assert(res == 0);
+	}
+	for (i = 0; i < NUM_WRITERS; ++i)
+	{
+		res = pthread_create(&writers[i], NULL, writer_thread, (void*)(size_t)i);
+		assert(res == 0);
+	}
+	for (i = 0; i < NUM_WRITERS; ++i)
+		pthread_join(writers[i], NULL);
+	ok = genc_ccht_grow_by(&table, 1);
+	assert(ok);
+	ok = genc_ccht_grow_by(&table, sizeof(size_t) * 8);
+	assert(!ok);
+	genc_atomic_store_release(&writers_done, 1);
+	for (i = 0; i < NUM_READERS; ++i)
+		pthread_join(readers[i], NULL);
+
+	assert(genc_ccht_count(&table) == NUM_STABLE);
+	assert(genc_ccht_capacity(&table) > capacity);
+	for (i = 0; i < NUM_STABLE; ++i)
+		assert(genc_ccht_find(&table, &i) == &stable_entries[i].hash_head);
+	for (i = 0; i < NUM_VOLATILE; ++i)
+	{
+		unsigned key = NUM_STABLE + i;
+		assert(!genc_ccht_find(&table, &key));
+	}
+
+	genc_ccht_destroy(&table);
+	assert(num_retired > 0);
+	for (i = 0; i < num_retired; ++i)
+		free(retired[i]);
+	return 0;
+}
@@ -0,0 +1,400 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/* Built with the implementation included, to check where items are placed */
+#include "../../src/cuckoo_hash_table.c"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct ckht_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+GENC_LPHT_DEFINE_BASIC_STRUCT_ITEM_FNS(ckht_test_item, key, 0, static)
+
+static const uint64_t empty_key = 0;
+
+static void* ckht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+/* Deliberately weak hash, so that many keys share groups, and tests can pick
+ * keys by their groups */
+static genc_hash_t identity_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)*(uint64_t*)key;
+}
+
+/* Checks every item is in one of its two groups or the stash, and that
+ * stashed items only stay there while both their groups are full. */
+static void check_placement(genc_cuckoo_hash_table_t* table)
+{
+	size_t i, items = 0, stashed = 0;
+	for (i = 0; i < ckht_main_buckets(table) + GENC_CKHT_STASH_SIZE; ++i)
+	{
+		void* item = ckht_bucket_at(table, i);
+		genc_hash_t hash;
+		size_t group1, group2;
+		if (ckht_item_is_empty(table, item))
+			continue;
+		++items;
+		hash = ckht_item_hash(table, item);
+		group1 = ckht_group1(table, hash);
+		group2 = ckht_group2(table, hash, group1);
+		assert(group1 != group2);
+		if (i < ckht_main_buckets(table))
+		{
+			assert(i / GENC_CKHT_WAYS == group1 || i / GENC_CKHT_WAYS == group2);
+		}
+		else
+		{
+			assert(ckht_group_find_empty(table, group1) == CKHT_NO_BUCKET);
+			assert(ckht_group_find_empty(table, group2) == CKHT_NO_BUCKET);
+			++stashed;
+		}
+	}
+	assert(items == table->item_count);
+	assert(stashed == table->stash_count);
+}
+
+/* Inserts and removes pseudo-random keys, comparing against a shadow array */
+static void test_random_ops(genc_cuckoo_hash_table_t* table)
+{
+	const size_t key_range = 5000;
+	char* present = calloc(1, key_range);
+	size_t count = 0, i;
+	struct ckht_test_item item, *found;
+	void* inserted;
+
+	srand(42);
+	for (i = 0; i < key_range * 20; ++i)
+	{
+		uint64_t key = rand() % (key_range - 1) + 1;
+		item.key = key;
+		item.val = key * 3;
+		found = genc_ckht_find_obj(table, &key, struct ckht_test_item);
+		if (present[key])
+		{
+			assert(found && found->key == key && found->val == key * 3);
+			inserted = genc_ckht_insert_item(table, &item);
+			assert(!inserted);
+			genc_ckht_remove(table, found);
+			present[key] = 0;
+			--count;
+			assert(!genc_ckht_find(table, &key));
+		}
+		else
+		{
+			assert(!found);
+			found = genc_ckht_insert_obj(table, &item, struct ckht_test_item);
+			assert(found && found->key == key);
+			present[key] = 1;
+			++count;
+		}
+		assert(genc_ckht_count(table) == count);
+		if (i % 1024 == 0)
+			check_placement(table);
+	}
+	check_placement(table);
+	assert(genc_ckht_verify(table));
+
+	i = 0;
+	genc_ckht_for_each_obj(struct ckht_test_item, obj, table)
+	{
+		assert(present[obj->key]);
+		++i;
+	}
+	assert(i == count);
+	free(present);
+}
+
+static void ckht_test_insert(genc_cuckoo_hash_table_t* table, uint64_t key)
+{
+	struct ckht_test_item item;
+	void* inserted;
+	item.key = key;
+	item.val = key * 3;
+	inserted = genc_ckht_insert_item(table, &item);
+	assert(inserted);
+}
+
+static size_t ckht_test_group_of(genc_cuckoo_hash_table_t* table, uint64_t key)
+{
+	void* found = genc_ckht_find(table, &key);
+	assert(found);
+	return ckht_bucket_index(table, found) / GENC_CKHT_WAYS;
+}
+
+/* Fills both groups of a new key with items whose other groups are empty, so
+ * inserting it must move exactly one of them to its other group. */
+static void test_displacement(const genc_linear_probing_hash_table_desc_t* desc)
+{
+	genc_cuckoo_hash_table_t table;
+	uint64_t key, new_key = 1, fillers[2 * GENC_CKHT_WAYS];
+	size_t group_a, group_b, found_a = 0, found_b = 0, moved = 0, i;
+	genc_bool_t ok;
+	ok = genc_cuckoo_hash_table_init(&table, desc, NULL, 1024);
+	assert(ok);
+	group_a = ckht_group1(&table, new_key);
+	group_b = ckht_group2(&table, new_key, group_a);
+	for (key = 2; found_a < GENC_CKHT_WAYS || found_b < GENC_CKHT_WAYS; ++key)
+	{
+		size_t group1 = ckht_group1(&table, key);
+		size_t group2 = ckht_group2(&table, key, group1);
+		if (group2 == group_a || group2 == group_b)
+			continue;
+		if (group1 == group_a && found_a < GENC_CKHT_WAYS)
+			fillers[found_a++] = key;
+		else if (group1 == group_b && found_b < GENC_CKHT_WAYS)
+			fillers[GENC_CKHT_WAYS + found_b++] = key;
+	}
+	for (i = 0; i < 2 * GENC_CKHT_WAYS; ++i)
+		ckht_test_insert(&table, fillers[i]);
+	for (i = 0; i < 2 * GENC_CKHT_WAYS; ++i)
+		assert(ckht_test_group_of(&table, fillers[i]) == ckht_group1(&table, fillers[i]));
+
+	ckht_test_insert(&table, new_key);
+	assert(ckht_test_group_of(&table, new_key) == group_a || ckht_test_group_of(&table, new_key) == group_b);
+	for (i = 0; i < 2 * GENC_CKHT_WAYS; ++i)
+	{
+		if (ckht_test_group_of(&table, fillers[i]) != ckht_group1(&table, fillers[i]))
+			++moved;
+	}
+	assert(moved == 1);
+	assert(table.stash_count == 0);
+	assert(genc_ckht_capacity(&table) == 1024);
+	check_placement(&table);
+	genc_ckht_destroy(&table);
+}
+
+/* The table should only need to grow well beyond 90% occupancy */
+static void test_high_load(const genc_linear_probing_hash_table_desc_t* desc)
+{
+	genc_cuckoo_hash_table_t table;
+	struct ckht_test_item item, *found;
+	void* inserted;
+	uint64_t key;
+	size_t capacity;
+	genc_bool_t ok;
+	ok = genc_cuckoo_hash_table_init(&table, desc, NULL, 4096);
+	assert(ok);
+	capacity = genc_ckht_capacity(&table);
+	assert(capacity == 4096);
+	for (key = 1; key <= capacity * 95 / 100; ++key)
+	{
+		item.key = key;
+		item.val = key;
+		inserted = genc_ckht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	assert(genc_ckht_capacity(&table) == capacity);
+	assert(genc_ckht_verify(&table));
+	for (key = 1; key <= capacity * 95 / 100; ++key)
+	{
+		found = genc_ckht_find_obj(&table, &key, struct ckht_test_item);
+		assert(found && found->val == key);
+	}
+	for (key = capacity; key < capacity * 2; ++key)
+		assert(!genc_ckht_find(&table, &key));
+
+	/* update in place */
+	item.key = 7;
+	item.val = 70;
+	inserted = genc_ckht_insert_or_update_item(&table, &item);
+	assert(inserted);
+	key = 7;
+	found = genc_ckht_find_obj(&table, &key, struct ckht_test_item);
+	assert(found && found->val == 70);
+
+	/* filling up completely forces growth */
+	for (key = capacity * 95 / 100 + 1; key <= capacity; ++key)
+	{
+		item.key = key;
+		inserted = genc_ckht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	assert(genc_ckht_count(&table) == capacity);
+	assert(genc_ckht_capacity(&table) > capacity);
+	assert(genc_ckht_verify(&table));
+
+	ok = genc_ckht_reserve_space(&table, capacity * 4);
+	assert(ok);
+	assert(genc_ckht_capacity(&table) >= capacity * 4);
+	assert(genc_ckht_verify(&table));
+	genc_ckht_destroy(&table);
+}
+
+/* A hash with only 16 distinct values puts every key in one of a few groups,
+ * which fill up along with the stash, forcing growth that doesn't help. */
+static genc_hash_t terrible_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)(*(uint64_t*)key % 16);
+}
+
+static void test_degenerate_hash(void)
+{
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_cuckoo_hash_table_t table;
+	struct ckht_test_item item;
+	uint64_t key;
+	genc_bool_t ok;
+	genc_linear_probing_hash_table_desc_init(
+		&desc, terrible_hash, ckht_test_item_get_key, genc_uint64_keys_equal,
+		ckht_test_item_is_empty, ckht_test_item_clear, ckht_test_realloc,
+		sizeof(struct ckht_test_item), 0, 0);
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 64);
+	assert(ok);
+	for (key = 1; key <= 1000; ++key)
+	{
+		item.key = key;
+		item.val = key;
+		if (!genc_ckht_insert_item(&table, &item))
+			break;
+	}
+	/* at most 2 groups per hash value, plus the stash */
+	assert(key <= 16 * 2 * GENC_CKHT_WAYS + GENC_CKHT_STASH_SIZE + 1);
+	assert(genc_ckht_count(&table) == key - 1);
+	assert(genc_ckht_verify(&table));
+	genc_ckht_destroy(&table);
+}
+
+/* Keys sharing a hash value share both groups, so the ones beyond two groups'
+ * worth go to the stash, and move back as soon as a bucket is freed. */
+static void test_stash(void)
+{
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_cuckoo_hash_table_t table;
+	struct ckht_test_item* found;
+	uint64_t key;
+	size_t stash_start;
+	genc_bool_t ok;
+	genc_linear_probing_hash_table_desc_init(
+		&desc, terrible_hash, ckht_test_item_get_key, genc_uint64_keys_equal,
+		ckht_test_item_is_empty, ckht_test_item_clear, ckht_test_realloc,
+		sizeof(struct ckht_test_item), 0, 0);
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 64);
+	assert(ok);
+	stash_start = ckht_main_buckets(&table);
+	for (key = 0; key < 2 * GENC_CKHT_WAYS + 2; ++key)
+		ckht_test_insert(&table, 1 + key * 16);
+	assert(table.stash_count == 2);
+	assert(genc_ckht_capacity(&table) == 64);
+	check_placement(&table);
+
+	/* removing a main table item drains one stashed item into its bucket */
+	key = 1;
+	found = genc_ckht_find_obj(&table, &key, struct ckht_test_item);
+	assert(found && ckht_bucket_index(&table, found) < stash_start);
+	genc_ckht_remove(&table, found);
+	assert(table.stash_count == 1);
+	check_placement(&table);
+
+	/* removing the remaining stashed item leaves the stash empty */
+	for (key = 17; key < 16 * (2 * GENC_CKHT_WAYS + 2); key += 16)
+	{
+		found = genc_ckht_find_obj(&table, &key, struct ckht_test_item);
+		assert(found);
+		if (ckht_bucket_index(&table, found) >= stash_start)
+			break;
+	}
+	genc_ckht_remove(&table, found);
+	assert(table.stash_count == 0);
+	assert(genc_ckht_count(&table) == 2 * GENC_CKHT_WAYS);
+	check_placement(&table);
+	genc_ckht_destroy(&table);
+}
+
+int main(void)
+{
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_cuckoo_hash_table_t table;
+	genc_bool_t ok;
+	void* inserted;
+
+	genc_linear_probing_hash_table_desc_init(
+		&desc, genc_uint64_key_hash, ckht_test_item_get_key, genc_uint64_keys_equal,
+		ckht_test_item_is_empty, ckht_test_item_clear, ckht_test_realloc,
+		sizeof(struct ckht_test_item), 0, 0);
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(ok);
+	test_random_ops(&table);
+	genc_ckht_destroy(&table);
+	test_high_load(&desc);
+
+	desc.hash_fn = identity_hash;
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 64);
+	assert(ok);
+	test_random_ops(&table);
+	genc_ckht_destroy(&table);
+	test_displacement(&desc);
+
+	genc_linear_probing_hash_table_desc_init_inline_key(
+		&desc, genc_uint64_key_hash, ckht_test_realloc, sizeof(struct ckht_test_item),
+		offsetof(struct ckht_test_item, key), sizeof(uint64_t), &empty_key, 0, 0);
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(ok);
+	test_random_ops(&table);
+	genc_ckht_destroy(&table);
+	test_high_load(&desc);
+
+	test_degenerate_hash();
+	test_stash();
+
+	/* unsupported descriptor options */
+	genc_linear_probing_hash_table_desc_init(
+		&desc, genc_uint64_key_hash, ckht_test_item_get_key, genc_uint64_keys_equal,
+		ckht_test_item_is_empty, ckht_test_item_clear, ckht_test_realloc,
+		sizeof(struct ckht_test_item), 0, 0);
+	desc.flags = GENC_LPHT_ROBIN_HOOD;
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(!ok);
+	desc.flags = GENC_LPHT_STORE_HASHES;
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(!ok);
+	desc.flags = 0;
+	desc.seeded_hash_fn = genc_uint64_key_hash_seeded;
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(!ok);
+	desc.seeded_hash_fn = NULL;
+	ok = genc_cuckoo_hash_table_init(&table, &desc, NULL, 0);
+	assert(ok);
+	inserted = genc_ckht_insert_item(&table, NULL);
+	assert(!inserted);
+	inserted = genc_ckht_insert_or_update_item(&table, NULL);
+	assert(!inserted);
+	assert(genc_ckht_count(&table) == 0);
+	genc_ckht_destroy(&table);
+
+	printf("cuckoo_hash_table tests passed\n");
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/hash_shared.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define MAX_LEN 300
+
+static void test_streaming(const uint8_t* data)
+{
+	size_t len, chunk;
+	for (len = 0; len <= MAX_LEN; ++len)
+	{
+		size_t expected = genc_hash_bytes(data, len, 1234);
+		genc_hash_bytes_state_t state;
+
+		/* fixed chunk sizes hit every alignment against the 48 byte blocks */
+		for (chunk = 1; chunk <= 64; ++chunk)
+		{
+			size_t pos = 0;
+			genc_hash_bytes_init(&state, 1234);
+			while (pos < len)
+			{
+				size_t n = len - pos < chunk ? len - pos : chunk;
+				genc_hash_bytes_update(&state, data + pos, n);
+				pos += n;
+			}
+			assert(genc_hash_bytes_final(&state) == expected);
+		}
+
+		/* random fragmentation, with empty updates */
+		{
+			size_t pos = 0;
+			genc_hash_bytes_init(&state, 1234);
+			while (pos < len)
+			{
+				size_t n = (size_t)rand() % 100;
+				if (n > len - pos)
+					n = len - pos;
+				genc_hash_bytes_update(&state, data + pos, n);
+				pos += n;
+			}
+			assert(genc_hash_bytes_final(&state) == expected);
+		}
+	}
+}
+
+static void test_sensitivity(const uint8_t* data)
+{
+	uint8_t copy[MAX_LEN];
+	size_t len, i;
+	memcpy(copy, data, MAX_LEN);
+	for (len = 1; len <= MAX_LEN; len += 7)
+	{
+		size_t h = genc_hash_bytes(copy, len, 0);
+		assert(h != genc_hash_bytes(copy, len, 1));
+		assert(h != genc_hash_bytes(copy, len - 1, 0));
+		/* flipping any bit changes the hash */
+		for (i = 0; i < len; ++i)
+		{
+			copy[i] ^= 1u << (i % 8);
+			assert(h != genc_hash_bytes(copy, len, 0));
+			copy[i] ^= 1u << (i % 8);
+		}
+		assert(h == genc_hash_bytes(copy, len, 0));
+	}
+}
+
+static void test_string_keys(void)
+{
+	char buf1[] = "hello, world";
+	char buf2[] = "hello, world";
+	genc_lstring_t s1, s2;
+
+	assert(genc_cstring_keys_equal(buf1, buf2, NULL));
+	assert(genc_cstring_key_hash(buf1, NULL) == genc_cstring_key_hash(buf2, NULL));
+	assert(genc_cstring_key_hash(buf1, NULL) == genc_hash_bytes(buf1, strlen(buf1), 0));
+	assert(genc_cstring_key_hash_seeded(buf1, 0, NULL) == genc_cstring_key_hash(buf1, NULL));
+	assert(genc_cstring_key_hash_seeded(buf1, 1, NULL) != genc_cstring_key_hash(buf1, NULL));
+	buf2[0] = 'j';
+	assert(!genc_cstring_keys_equal(buf1, buf2, NULL));
+
+	s1.str = buf1;
+	s1.length = 5;
+	s2.str = "hello,_there";
+	s2.length = 5;
+	assert(genc_lstring_keys_equal(&s1, &s2, NULL));
+	assert(genc_lstring_key_hash(&s1, NULL) == genc_lstring_key_hash(&s2, NULL));
+	s2.length = 6;
+	assert(!genc_lstring_keys_equal(&s1, &s2, NULL));
+	s1.length = 6;
+	s2.length = 6;
+	assert(genc_lstring_keys_equal(&s1, &s2, NULL));
+	s1.length = 7;
+	s2.length = 7;
+	assert(!genc_lstring_keys_equal(&s1, &s2, NULL));
+	assert(genc_lstring_key_hash(&s1, NULL) != genc_lstring_key_hash(&s2, NULL));
+	/* embedded NULs are just bytes */
+	s1.str = "a\0b";
+	s1.length = 3;
+	s2.str = "a\0c";
+	s2.length = 3;
+	assert(!genc_lstring_keys_equal(&s1, &s2, NULL));
+}
+
+int main(void)
+{
+	uint8_t data[MAX_LEN];
+	size_t i;
+	srand(42);
+	for (i = 0; i < MAX_LEN; ++i)
+		data[i] = (uint8_t)rand();
+
+	test_streaming(data);
+	test_sensitivity(data);
+	test_string_keys();
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/hash_shared.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Known values, which must be identical whether or not the CPU supports
+ * the instructions (try building with -DGENC_HASH_NO_HW) */
+static const uint64_t test_keys[4] = { 0, 1, 0x123456789abcdef0ull, 0xffffffffffffffffull };
+static const uint32_t expected_uint32_crc[4] = { 0x888097ddu, 0x55c53d65u, 0x0b9e7840u, 0x3f1823e5u };
+#if defined(__LP64__) || defined(_WIN64)
+static const uint64_t expected_uint64_crc[4] =
+	{ 0xa769e8d53cd828a6ull, 0x7a2c426d75e45581ull, 0x6e3d6a5f96540398ull, 0x63261198f897d1ebull };
+/* hash of (test_keys[i], test_keys[3 - i]) */
+static const uint64_t expected_uint128[4] =
+	{ 0x7bdc29bd3d1c7592ull, 0xec9cff0e18070a87ull, 0xa4cc2a73fae48d03ull, 0xa3eb7edf63fa2047ull };
+#endif
+
+/* Sequential keys should fill buckets about evenly */
+#define SPREAD_BUCKETS 1024
+#define SPREAD_KEYS (SPREAD_BUCKETS * 16)
+static void test_spread(int which)
+{
+	static unsigned counts[SPREAD_BUCKETS];
+	unsigned i, max = 0;
+	memset(counts, 0, sizeof(counts));
+	for (i = 0; i < SPREAD_KEYS; ++i)
+	{
+		size_t h;
+		if (which == 0)
+			h = genc_hash_uint32_crc(i);
+		else if (which == 1)
+			h = genc_hash_uint64_crc((uint64_t)i << 32);
+		else
+			h = genc_hash_uint128(0, i);
+		++counts[h & (SPREAD_BUCKETS - 1)];
+	}
+	for (i = 0; i < SPREAD_BUCKETS; ++i)
+		if (counts[i] > max)
+			max = counts[i];
+	assert(max < 16 * 3);
+}
+
+int main(void)
+{
+	unsigned i;
+	genc_uint128_t k1, k2;
+	uint32_t k32;
+	uint64_t k64;
+
+	for (i = 0; i < 4; ++i)
+	{
+		k32 = (uint32_t)test_keys[i];
+		k64 = test_keys[i];
+		assert(genc_hash_uint32_crc(k32) == expected_uint32_crc[i]);
+		assert(genc_uint32_key_hash_crc(&k32, NULL) == expected_uint32_crc[i]);
+		assert(genc_uint64_key_hash_crc(&k64, NULL) == genc_hash_uint64_crc(k64));
+#if defined(__LP64__) || defined(_WIN64)
+		assert(genc_hash_uint64_crc(k64) == expected_uint64_crc[i]);
+		assert(genc_hash_uint128(test_keys[i], test_keys[3 - i]) == expected_uint128[i]);
+#endif
+	}
+
+	k1.lo = 1;
+	k1.hi = 2;
+	k2 = k1;
+	assert(genc_uint128_keys_equal(&k1, &k2, NULL));
+	assert(genc_uint128_key_hash(&k1, NULL) == genc_uint128_key_hash(&k2, NULL));
+	k2.hi = 3;
+	assert(!genc_uint128_keys_equal(&k1, &k2, NULL));
+	assert(genc_uint128_key_hash(&k1, NULL) != genc_uint128_key_hash(&k2, NULL));
+
+	for (i = 0; i < 3; ++i)
+		test_spread(i);
+	return 0;
+}
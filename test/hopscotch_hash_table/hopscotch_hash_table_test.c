@@ -0,0 +1,282 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+/* Built with the implementation included, to check the bitmaps and bucket
+ * positions directly */
+#include "../../src/hopscotch_hash_table.c"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct hsht_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+static void* hsht_test_get_key(void* item, void* opaque)
+{
+	return &((struct hsht_test_item*)item)->key;
+}
+
+static void* hsht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+/* Home bucket is the key modulo the capacity, so tests can pick collisions */
+static genc_hash_t identity_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)*(uint64_t*)key;
+}
+
+/* Recomputes every home bucket's bitmap from the occupied buckets and checks
+ * the stored bitmaps match exactly, and that each item is within reach of its
+ * home bucket. */
+static void check_neighbourhoods(genc_hopscotch_hash_table_t* table)
+{
+	const size_t mask = table->capacity - 1u;
+	uint32_t* expected = calloc(table->capacity, sizeof(uint32_t));
+	size_t i, items = 0;
+	for (i = 0; i < table->capacity; ++i)
+	{
+		void* item;
+		size_t home, dist;
+		if (*hsht_tag_at(table, i) == 0)
+			continue;
+		item = hsht_bucket_at(table, i);
+		home = hsht_item_hash(table, item) & mask;
+		dist = (i - home) & mask;
+		assert(dist < GENC_HSHT_NEIGHBOURHOOD);
+		expected[home] |= UINT32_C(1) << dist;
+		++items;
+	}
+	for (i = 0; i < table->capacity; ++i)
+		assert(*hsht_hop_at(table, i) == expected[i]);
+	assert(items == table->item_count);
+	free(expected);
+}
+
+static size_t hsht_test_index_of(genc_hopscotch_hash_table_t* table, uint64_t key)
+{
+	void* found = genc_hsht_find(table, &key);
+	assert(found);
+	return hsht_bucket_index(table, found);
+}
+
+static void hsht_test_insert(genc_hopscotch_hash_table_t* table, uint64_t key)
+{
+	struct hsht_test_item item;
+	void* inserted;
+	item.key = key;
+	item.val = key * 3;
+	inserted = genc_hsht_insert_item(table, &item);
+	assert(inserted);
+}
+
+static void hsht_test_remove(genc_hopscotch_hash_table_t* table, uint64_t key)
+{
+	void* found = genc_hsht_find(table, &key);
+	assert(found);
+	genc_hsht_remove(table, found);
+	assert(!genc_hsht_find(table, &key));
+}
+
+/* Buckets 0 to 39 each hold the item homed there, so a second item homed at 0
+ * finds its nearest free bucket (40) out of reach. The earliest item which may
+ * move there is the one in bucket 9 (40 - 9 = 31 buckets from its home), and
+ * the new item takes its place. */
+static void test_hop(void)
+{
+	genc_hopscotch_hash_table_t table;
+	struct hsht_test_item item, *found;
+	void* updated;
+	uint64_t key;
+	genc_bool_t ok;
+	ok = genc_hopscotch_hash_table_init(
+		&table, identity_hash, hsht_test_get_key, genc_uint64_keys_equal,
+		hsht_test_realloc, NULL, sizeof(struct hsht_test_item), 64);
+	assert(ok);
+	for (key = 0; key < 40; ++key)
+		hsht_test_insert(&table, key);
+	for (key = 0; key < 40; ++key)
+		assert(hsht_test_index_of(&table, key) == key);
+	check_neighbourhoods(&table);
+
+	hsht_test_insert(&table, 64);
+	assert(genc_hsht_capacity(&table) == 64);
+	assert(hsht_test_index_of(&table, 64) == 9);
+	assert(hsht_test_index_of(&table, 9) == 40);
+	assert(*hsht_hop_at(&table, 0) == ((UINT32_C(1) << 9) | 1u));
+	assert(*hsht_hop_at(&table, 9) == UINT32_C(1) << 31);
+	key = 9;
+	found = genc_hsht_find_obj(&table, &key, struct hsht_test_item);
+	assert(found && found->val == 27);
+	check_neighbourhoods(&table);
+
+	/* removals clear exactly the item's bit in its home bucket's bitmap */
+	hsht_test_remove(&table, 9);
+	assert(*hsht_hop_at(&table, 9) == 0);
+	hsht_test_remove(&table, 0);
+	assert(*hsht_hop_at(&table, 0) == UINT32_C(1) << 9);
+	check_neighbourhoods(&table);
+	/* the vacated buckets are reused without further moves */
+	hsht_test_insert(&table, 128);
+	assert(hsht_test_index_of(&table, 128) == 0);
+	assert(hsht_test_index_of(&table, 64) == 9);
+	check_neighbourhoods(&table);
+
+	/* updates stay in place */
+	item.key = 64;
+	item.val = 70;
+	updated = genc_hsht_insert_or_update_item(&table, &item);
+	assert(updated && hsht_bucket_index(&table, updated) == 9);
+	found = genc_hsht_find_obj(&table, &item.key, struct hsht_test_item);
+	assert(found && found->val == 70);
+	genc_hsht_destroy(&table);
+}
+
+/* Keys colliding in groups of 64 apart, inserted and removed at random, with
+ * the bitmaps rechecked against the buckets after every operation. */
+static void test_random_ops(void)
+{
+	const size_t key_range = 2048;
+	genc_hopscotch_hash_table_t table;
+	char* present = calloc(1, key_range);
+	size_t count = 0, i;
+	genc_bool_t ok;
+	ok = genc_hopscotch_hash_table_init(
+		&table, identity_hash, hsht_test_get_key, genc_uint64_keys_equal,
+		hsht_test_realloc, NULL, sizeof(struct hsht_test_item), 64);
+	assert(ok);
+
+	srand(42);
+	for (i = 0; i < key_range * 8; ++i)
+	{
+		/* keys are multiples of 64 plus a small offset, crowding few homes */
+		size_t slot = (size_t)rand() % key_range;
+		uint64_t key = (uint64_t)(slot / 16) * 64 + slot % 16;
+		if (present[slot])
+		{
+			hsht_test_remove(&table, key);
+			present[slot] = 0;
+			--count;
+		}
+		else
+		{
+			hsht_test_insert(&table, key);
+			present[slot] = 1;
+			++count;
+		}
+		assert(genc_hsht_count(&table) == count);
+		if (i % 64 == 0)
+			check_neighbourhoods(&table);
+	}
+	check_neighbourhoods(&table);
+	assert(genc_hsht_verify(&table));
+	genc_hsht_destroy(&table);
+	free(present);
+}
+
+/* 32 items homed at bucket 0 fill its whole neighbourhood, none of them can
+ * move, so a 33rd makes the table grow well below the load factor threshold. */
+static void test_early_grow(void)
+{
+	genc_hopscotch_hash_table_t table;
+	uint64_t key;
+	genc_bool_t ok;
+	ok = genc_hopscotch_hash_table_init(
+		&table, identity_hash, hsht_test_get_key, genc_uint64_keys_equal,
+		hsht_test_realloc, NULL, sizeof(struct hsht_test_item), 64);
+	assert(ok);
+	for (key = 0; key < GENC_HSHT_NEIGHBOURHOOD; ++key)
+		hsht_test_insert(&table, key * 64);
+	assert(genc_hsht_capacity(&table) == 64);
+	assert(*hsht_hop_at(&table, 0) == UINT32_MAX);
+	check_neighbourhoods(&table);
+
+	hsht_test_insert(&table, GENC_HSHT_NEIGHBOURHOOD * 64);
+	assert(genc_hsht_count(&table) == GENC_HSHT_NEIGHBOURHOOD + 1);
+	assert(genc_hsht_count(&table) < hsht_max_items(64, 85));
+	assert(genc_hsht_capacity(&table) == 128);
+	for (key = 0; key <= GENC_HSHT_NEIGHBOURHOOD; ++key)
+		hsht_test_index_of(&table, key * 64);
+	check_neighbourhoods(&table);
+
+	/* rehashing for a reservation rebuilds the bitmaps */
+	ok = genc_hsht_reserve_space(&table, 1000);
+	assert(ok);
+	assert(genc_hsht_capacity(&table) == 2048);
+	check_neighbourhoods(&table);
+	genc_hsht_clear(&table);
+	assert(genc_hsht_count(&table) == 0);
+	check_neighbourhoods(&table);
+	genc_hsht_destroy(&table);
+}
+
+/* A hash with only 4 distinct values can't fit more than 4 neighbourhoods'
+ * worth of items, however large the table. */
+static genc_hash_t terrible_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)(*(uint64_t*)key % 4) * 64;
+}
+
+static void test_degenerate_hash(void)
+{
+	genc_hopscotch_hash_table_t table;
+	struct hsht_test_item item;
+	uint64_t key;
+	genc_bool_t ok;
+	ok = genc_hopscotch_hash_table_init(
+		&table, terrible_hash, hsht_test_get_key, genc_uint64_keys_equal,
+		hsht_test_realloc, NULL, sizeof(struct hsht_test_item), 256);
+	assert(ok);
+	for (key = 0; key < 1000; ++key)
+	{
+		item.key = key;
+		item.val = key;
+		if (!genc_hsht_insert_item(&table, &item))
+			break;
+	}
+	assert(key == 4 * GENC_HSHT_NEIGHBOURHOOD);
+	assert(genc_hsht_count(&table) == key);
+	assert(genc_hsht_verify(&table));
+	genc_hsht_destroy(&table);
+}
+
+int main(void)
+{
+	test_hop();
+	test_random_ops();
+	test_early_grow();
+	test_degenerate_hash();
+
+	printf("hopscotch_hash_table tests passed\n");
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ Copyright (c) 2026 genccont contributors
+ 
+ This software is provided 'as-is', without any express or implied
+ warranty. In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented; you must not
+ claim that you wrote the original software. If you use this software
+ in a product, an acknowledgment in the product documentation would be
+ appreciated but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such, and must not be
+ misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source
+ distribution.
+ */
+
+#include "../../src/interval_tree.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+static int overlaps(genc_interval_tree_item_t* item, uint64_t start, uint64_t end)
+{
+	return item->range_start < end && start < item->range_end;
+}
+
+/* recomputes the max-end augmentation of the subtree and checks it against the cached values */
+static uint64_t check_max_end(genc_bt_node_head_t* node)
+{
+	genc_interval_tree_item_t* item;
+	uint64_t max_end, child_max;
+	if (!node)
+		return 0;
+	item = genc_container_of(node, genc_interval_tree_item_t, head);
+	max_end = item->range_end;
+	child_max = check_max_end(node->left);
+	if (child_max > max_end)
+		max_end = child_max;
+	child_max = check_max_end(node->right);
+	if (child_max > max_end)
+		max_end = child_max;
+	assert(item->subtree_max_end == max_end);
+	return max_end;
+}
+
+/* compares the tree's overlap query against a brute force scan */
+static void check_query(genc_binary_tree_t* tree, genc_interval_tree_item_t* items, const char* in_tree, size_t num_items, uint64_t start, uint64_t end)
+{
+	size_t expected = 0, found = 0, i;
+	uint64_t prev_start = 0;
+	genc_interval_tree_item_t* cur;
+	for (i = 0; i < num_items; ++i)
+	{
+		if (in_tree[i] && overlaps(items + i, start, end))
+			++expected;
+	}
+	genc_interval_tree_for_each_overlap(cur, tree, start, end)
+	{
+		assert(overlaps(cur, start, end));
+		assert(in_tree[cur - items]);
+		assert(cur->range_start >= prev_start);
+		prev_start = cur->range_start;
+		++found;
+	}
+	assert(found == expected);
+}
+
+static void test_manual(void)
+{
+	genc_interval_tree_item_t
+		a = {{ NULL, NULL, NULL, 0 }, 10, 15, 0 },
+		b = {{ NULL, NULL, NULL, 0 }, 7, 12, 0 },
+		c = {{ NULL, NULL, NULL, 0 }, 10, 15, 0 },
+		d = {{ NULL, NULL, NULL, 0 }, 1, 30, 0 },
+		e = {{ NULL, NULL, NULL, 0 }, 20, 25, 0 };
+	genc_interval_tree_item_t* found;
+	genc_binary_tree_t tree;
+	
+	genc_interval_tree_init(&tree);
+	assert(!genc_interval_tree_first_overlap(&tree, 0, 100));
+	
+	genc_interval_tree_insert(&tree, &a);
+	genc_interval_tree_insert(&tree, &b);
+	genc_interval_tree_insert(&tree, &c);
+	genc_interval_tree_insert(&tree, &d);
+	genc_interval_tree_insert(&tree, &e);
+	assert(genc_bt_verify(&tree));
+	check_max_end(tree.root);
+	
+	/* d spans everything */
+	found = genc_interval_tree_first_overlap(&tree, 16, 19);
+	assert(found == &d);
+	assert(!genc_interval_tree_next_overlap(&tree, found, 16, 19));
+	
+	found = genc_interval_tree_first_overlap(&tree, 12, 13);
+	assert(found == &d);
+	found = genc_interval_tree_next_overlap(&tree, found, 12, 13);
+	assert(found == &a || found == &c);
+	found = genc_interval_tree_next_overlap(&tree, found, 12, 13);
+	assert(found == &a || found == &c);
+	assert(!genc_interval_tree_next_overlap(&tree, found, 12, 13));
+	
+	genc_interval_tree_remove(&tree, &d);
+	assert(genc_bt_verify(&tree));
+	assert(!genc_interval_tree_first_overlap(&tree, 16, 19));
+	assert(!genc_interval_tree_first_overlap(&tree, 30, 40));
+	assert(genc_interval_tree_first_overlap(&tree, 0, 8) == &b);
+	
+	/* extend e in-place */
+	e.range_end = 35;
+	genc_interval_tree_update_end(&tree, &e);
+	assert(genc_interval_tree_first_overlap(&tree, 30, 40) == &e);
+}
+
+static void test_random(void)
+{
+	const size_t num_items = 5000;
+	genc_interval_tree_item_t* items = calloc(sizeof(genc_interval_tree_item_t), num_items);
+	char* in_tree = calloc(1, num_items);
+	genc_binary_tree_t tree;
+	size_t i, j;
+	
+	srand(42);
+	genc_interval_tree_init(&tree);
+	for (i = 0; i < num_items; ++i)
+	{
+		items[i].range_start = rand() % 100000;
+		items[i].range_end = items[i].range_start + 1 + rand() % (i % 10 == 0 ? 5000 : 50);
+	}
+	
+	for (j = 0; j < num_items * 4; ++j)
+	{
+		i = rand() % num_items;
+		if (in_tree[i])
+			genc_interval_tree_remove(&tree, items + i);
+		else
+			genc_interval_tree_insert(&tree, items + i);
+		in_tree[i] = !in_tree[i];
+		
+		if (j % 500 == 0)
+		{
+			uint64_t start = rand() % 100000;
+			assert(genc_bt_verify(&tree));
+			check_max_end(tree.root);
+			check_query(&tree, items, in_tree, num_items, start, start + 1 + rand() % 1000);
+		}
+	}
+	for (j = 0; j < 200; ++j)
+	{
+		uint64_t start = rand() % 110000;
+		check_query(&tree, items, in_tree, num_items, start, start + 1 + rand() % 200);
+	}
+	
+	free(items);
+	free(in_tree);
+}
+
+int main(void)
+{
+	test_manual();
+	test_random();
+	printf("Interval tree tests passed\n");
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+
+#include "../../src/linear_probing_hash_table_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct lpht_file_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+#define TEST_HASH_ID 0x75696e743634ull /* genc_uint64_key_hash */
+
+static void* lpht_file_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+static const uint64_t empty_key = 0;
+static const uint64_t other_empty_key = ~(uint64_t)0;
+
+static void check_contents(
+	genc_linear_probing_hash_table_light_t* table, const genc_linear_probing_hash_table_desc_t* desc, uint64_t num_keys)
+{
+	uint64_t key;
+	size_t count = 0;
+	struct lpht_file_test_item* item;
+	for (key = 1; key <= num_keys; ++key)
+	{
+		item = genc_lphtl_find_obj(table, desc, NULL, &key, struct lpht_file_test_item);
+		assert(item && item->val == key * 5);
+	}
+	assert(!genc_lphtl_find(table, desc, NULL, &key));
+	for (item = genc_lphtl_first_obj(table, desc, NULL, struct lpht_file_test_item); item;
+	     item = genc_lphtl_next_obj(table, desc, NULL, item, struct lpht_file_test_item))
+		++count;
+	assert(count == num_keys);
+	assert(genc_lphtl_count(table) == num_keys);
+}
+
+static void test_save_and_map(unsigned flags)
+{
+	enum { NUM_KEYS = 5000 };
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_linear_probing_hash_table_desc_t other_desc;
+	genc_linear_probing_hash_table_light_t table;
+	genc_linear_probing_hash_table_light_t mapped;
+	genc_lpht_mapping_t mapping;
+	struct lpht_file_test_item item;
+	char path[] = "/tmp/lpht_file_test_XXXXXX";
+	void* buffer;
+	void* inserted;
+	size_t size;
+	int fd, res;
+	genc_bool_t ok;
+	FILE* file;
+	struct stat st;
+	uint64_t key;
+
+	genc_linear_probing_hash_table_desc_init_inline_key(
+		&desc, genc_uint64_key_hash, lpht_file_test_realloc, sizeof(struct lpht_file_test_item),
+		offsetof(struct lpht_file_test_item, key), sizeof(uint64_t), &empty_key, 70, 20);
+	desc.flags |= flags;
+	ok = genc_linear_probing_hash_table_light_init(&table, &desc, NULL, 16);
+	assert(ok);
+	for (key = 1; key <= NUM_KEYS; ++key)
+	{
+		item.key = key;
+		item.val = key * 5;
+		inserted = genc_lphtl_insert_item(&table, &desc, NULL, &item);
+		assert(inserted);
+	}
+
+	/* in-memory image */
+	size = genc_lphtl_image_size(&table, &desc);
+	buffer = NULL;
+	res = posix_memalign(&buffer, GENC_LPHT_FILE_ALIGNMENT, size);
+	assert(res == 0);
+	ok = genc_lphtl_save_to_buffer(&table, &desc, NULL, TEST_HASH_ID, buffer, size - 1);
+	assert(!ok);
+	ok = genc_lphtl_save_to_buffer(&table, &desc, NULL, TEST_HASH_ID, buffer, size);
+	assert(ok);
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size, TEST_HASH_ID, 1);
+	assert(ok);
+	check_contents(&mapped, &desc, NUM_KEYS);
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size - 1, TEST_HASH_ID, 1);
+	assert(!ok);
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size, TEST_HASH_ID + 1, 1);
+	assert(!ok);
+	other_desc = desc;
+	other_desc.flags ^= GENC_LPHT_ROBIN_HOOD;
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+	/* Robin Hood tables store hashes either way */
+	other_desc = desc;
+	other_desc.flags ^= GENC_LPHT_STORE_HASHES;
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(ok == ((flags & GENC_LPHT_ROBIN_HOOD) != 0));
+	other_desc = desc;
+	other_desc.bucket_size = 2 * sizeof(struct lpht_file_test_item);
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+	/* same bucket size, different key layout */
+	other_desc = desc;
+	other_desc.key_offset = offsetof(struct lpht_file_test_item, val);
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+	other_desc = desc;
+	other_desc.key_size = sizeof(uint32_t);
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+	other_desc = desc;
+	other_desc.empty_key = &other_empty_key;
+	ok = genc_lphtl_attach_readonly(&mapped, &other_desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+
+	/* corrupted data is only detected when verifying, a corrupted header always */
+	((char*)buffer)[size - 3] ^= 1;
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size, TEST_HASH_ID, 1);
+	assert(!ok);
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size, TEST_HASH_ID, 0);
+	assert(ok);
+	((char*)buffer)[size - 3] ^= 1;
+	++((genc_lpht_file_header_t*)buffer)->item_count;
+	ok = genc_lphtl_attach_readonly(&mapped, &desc, buffer, size, TEST_HASH_ID, 0);
+	assert(!ok);
+	free(buffer);
+
+	/* file round trip */
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	ok = genc_lphtl_save(&table, &desc, NULL, TEST_HASH_ID, path);
+	assert(ok);
+	res = stat(path, &st);
+	assert(res == 0);
+	assert((st.st_mode & 0777) == 0644);
+	ok = genc_lphtl_map_readonly(&mapped, &desc, path, TEST_HASH_ID, 1, &mapping);
+	assert(ok);
+	assert(mapping.length == size);
+	check_contents(&mapped, &desc, NUM_KEYS);
+	genc_lphtl_unmap(&mapped, &mapping);
+	assert(genc_lphtl_capacity(&mapped) == 0);
+
+	/* truncated file */
+	file = fopen(path, "r+");
+	assert(file);
+	res = ftruncate(fileno(file), (off_t)(size / 2));
+	assert(res == 0);
+	fclose(file);
+	ok = genc_lphtl_map_readonly(&mapped, &desc, path, TEST_HASH_ID, 0, &mapping);
+	assert(!ok);
+	unlink(path);
+	ok = genc_lphtl_map_readonly(&mapped, &desc, path, TEST_HASH_ID, 0, &mapping);
+	assert(!ok);
+
+	genc_lphtl_destroy(&table, &desc, NULL);
+}
+
+int main(void)
+{
+	test_save_and_map(0);
+	test_save_and_map(GENC_LPHT_STORE_HASHES);
+	test_save_and_map(GENC_LPHT_ROBIN_HOOD);
+	printf("Linear probing hash table file tests passed\n");
+	return 0;
+}
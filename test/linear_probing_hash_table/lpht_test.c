@@ -0,0 +1,611 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/linear_probing_hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct lpht_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+GENC_LPHT_DEFINE_BASIC_STRUCT_ITEM_FNS(lpht_test_item, key, 0, static)
+
+static void* lpht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+/* Refuses allocations larger than the size limit opaque points to */
+static void* lpht_test_limited_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size > *(size_t*)opaque)
+		return NULL;
+	return lpht_test_realloc(old, old_size, new_size, opaque);
+}
+
+static const uint64_t empty_key = 0;
+static size_t hash_calls = 0;
+
+static genc_hash_t counting_hash(void* key, void* opaque)
+{
+	++hash_calls;
+	return genc_uint64_key_hash(key, opaque);
+}
+
+/* Inserts and removes pseudo-random keys, comparing against a shadow array */
+static void test_random_ops(genc_linear_probing_hash_table_t* table)
+{
+	const size_t key_range = 5000;
+	char* present = calloc(1, key_range);
+	size_t count = 0, i;
+	struct lpht_test_item item, *found;
+	void* inserted;
+	
+	srand(42);
+	for (i = 0; i < key_range * 20; ++i)
+	{
+		uint64_t key = 1 + rand() % key_range;
+		item.key = key;
+		item.val = key * 3;
+		found = genc_lpht_find_obj(table, &key, struct lpht_test_item);
+		if (present[key - 1])
+		{
+			assert(found && found->key == key && found->val == key * 3);
+			genc_lpht_remove(table, found);
+			present[key - 1] = 0;
+			--count;
+			assert(!genc_lpht_find(table, &key));
+		}
+		else
+		{
+			assert(!found);
+			found = genc_lpht_insert_obj(table, &item, struct lpht_test_item);
+			assert(found && found->key == key);
+			inserted = genc_lpht_insert_item(table, &item);
+			assert(!inserted);
+			present[key - 1] = 1;
+			++count;
+		}
+		assert(genc_lpht_count(table) == count);
+		if (i % 1000 == 0)
+			assert(genc_lpht_verify(table));
+	}
+	
+	/* iteration visits each item exactly once */
+	i = 0;
+	genc_lpht_for_each_obj(struct lpht_test_item, cur, table)
+	{
+		assert(present[cur->key - 1]);
+		++i;
+	}
+	assert(i == count);
+	free(present);
+}
+
+/* Batch lookups must agree with individual ones, across several chunks */
+static void test_find_batch(genc_linear_probing_hash_table_t* table)
+{
+	uint64_t keys[100];
+	void* key_ptrs[100];
+	void* found[100];
+	size_t i, expected = 0;
+	for (i = 0; i < 100; ++i)
+	{
+		keys[i] = 1 + i * 37;
+		key_ptrs[i] = &keys[i];
+		if (genc_lpht_find(table, &keys[i]))
+			++expected;
+	}
+	assert(genc_lpht_find_batch(table, key_ptrs, found, 100) == expected);
+	for (i = 0; i < 100; ++i)
+		assert(found[i] == genc_lpht_find(table, &keys[i]));
+}
+
+static void test_callbacks(void)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_ext(
+		&table, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+		lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc, NULL,
+		sizeof(struct lpht_test_item), 16, 70, 20);
+	assert(ok);
+	test_random_ops(&table);
+	test_find_batch(&table);
+	genc_lpht_destroy(&table);
+}
+
+static void test_inline_key(void)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_linear_probing_hash_table_desc_init_inline_key(
+		&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+		offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 70, 20);
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	test_random_ops(&table);
+	genc_lpht_destroy(&table);
+}
+
+static void test_stored_hashes(void)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	size_t calls_before;
+	genc_linear_probing_hash_table_desc_init(
+		&desc, counting_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+		lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+		sizeof(struct lpht_test_item), 70, 20);
+	desc.flags |= GENC_LPHT_STORE_HASHES;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	assert(table.table.hashes);
+	test_random_ops(&table);
+	test_find_batch(&table);
+	
+	/* resizing must work off the stored hashes */
+	calls_before = hash_calls;
+	ok = genc_lpht_grow_by(&table, 2);
+	assert(ok);
+	ok = genc_lpht_shrink_by(&table, 1);
+	assert(ok);
+	assert(hash_calls == calls_before);
+	assert(genc_lpht_verify(&table));
+	genc_lpht_destroy(&table);
+}
+
+static void test_robin_hood(unsigned extra_flags, genc_bool_t inline_key)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	struct lpht_test_item item;
+	void* inserted;
+	uint64_t key;
+	if (inline_key)
+		genc_linear_probing_hash_table_desc_init_inline_key(
+			&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+			offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 90, 20);
+	else
+		genc_linear_probing_hash_table_desc_init(
+			&desc, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+			lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+			sizeof(struct lpht_test_item), 90, 20);
+	desc.flags |= GENC_LPHT_ROBIN_HOOD | extra_flags;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	/* Robin Hood implies stored hashes */
+	assert(table.table.hashes);
+	test_random_ops(&table);
+	genc_lpht_clear(&table);
+	
+	/* fill up to the grow threshold */
+	ok = genc_lpht_resize(&table, 1024);
+	assert(ok);
+	for (key = 1; key <= 1024 * 9 / 10; ++key)
+	{
+		item.key = key;
+		item.val = key * 3;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	assert(genc_lpht_capacity(&table) == 1024);
+	assert(genc_lpht_verify(&table));
+	for (; key < 3000; ++key)
+		assert(!genc_lpht_find(&table, &key));
+	genc_lpht_destroy(&table);
+}
+
+static void test_incremental_resize(unsigned flags, genc_bool_t inline_key)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	struct lpht_test_item item, *found;
+	void* inserted;
+	genc_bool_t saw_resize = false;
+	uint64_t key, k;
+	if (inline_key)
+		genc_linear_probing_hash_table_desc_init_inline_key(
+			&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+			offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 70, 20);
+	else
+		genc_linear_probing_hash_table_desc_init(
+			&desc, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+			lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+			sizeof(struct lpht_test_item), 70, 20);
+	desc.flags |= flags;
+	desc.migrate_buckets_per_op = 4;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	
+	/* grow through several migrations, checking everything stays reachable */
+	for (key = 1; key <= 4000; ++key)
+	{
+		item.key = key;
+		item.val = key * 3;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(!inserted);
+		if (genc_lpht_is_resizing(&table))
+			saw_resize = true;
+		if (key % 97 == 0)
+		{
+			assert(genc_lpht_verify(&table));
+			for (k = 1; k <= key; k += 7)
+			{
+				found = genc_lpht_find_obj(&table, &k, struct lpht_test_item);
+				assert(found && found->val == k * 3);
+			}
+		}
+	}
+	assert(saw_resize);
+	
+	/* updates and removals (which also shrink) while migrating */
+	item.key = 5;
+	item.val = 55;
+	inserted = genc_lpht_insert_or_update_item(&table, &item);
+	assert(inserted);
+	key = 5;
+	found = genc_lpht_find_obj(&table, &key, struct lpht_test_item);
+	assert(found && found->val == 55);
+	for (key = 1; key <= 4000; ++key)
+	{
+		void* bucket = genc_lpht_find(&table, &key);
+		assert(bucket);
+		genc_lpht_remove(&table, bucket);
+		assert(!genc_lpht_find(&table, &key));
+		if (key % 97 == 0)
+			assert(genc_lpht_verify(&table));
+	}
+	assert(genc_lpht_count(&table) == 0);
+	while (genc_lpht_resize_step(&table))
+		;
+	assert(!genc_lpht_is_resizing(&table));
+	
+	/* and the randomised checks */
+	test_random_ops(&table);
+	genc_lpht_destroy(&table);
+}
+
+static void test_bulk_load(unsigned flags, genc_bool_t inline_key)
+{
+	enum { NUM_ITEMS = 20000, NUM_KEYS = 19000 };
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	struct lpht_test_item* items = calloc(NUM_ITEMS, sizeof(items[0]));
+	size_t* first_index = calloc(NUM_KEYS + 1, sizeof(first_index[0]));
+	struct lpht_test_item item;
+	struct lpht_test_item* found;
+	void* inserted;
+	uint64_t key;
+	size_t i, count, limit;
+	if (inline_key)
+		genc_linear_probing_hash_table_desc_init_inline_key(
+			&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+			offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 70, 20);
+	else
+		genc_linear_probing_hash_table_desc_init(
+			&desc, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+			lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+			sizeof(struct lpht_test_item), 70, 20);
+	desc.flags |= flags;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	
+	/* some keys already present, some repeated within the input */
+	for (key = 1; key <= 100; ++key)
+	{
+		item.key = key * 7;
+		item.val = 0;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	for (i = 0; i < NUM_ITEMS; ++i)
+	{
+		items[i].key = 1 + (i * 7) % NUM_KEYS;
+		items[i].val = i + 1;
+		if (!first_index[items[i].key])
+			first_index[items[i].key] = i + 1;
+	}
+	count = genc_lpht_bulk_load(&table, items, NUM_ITEMS);
+	assert(count == NUM_KEYS - 100);
+	assert(genc_lpht_count(&table) == NUM_KEYS);
+	assert(genc_lpht_verify(&table));
+	for (key = 1; key <= NUM_KEYS; ++key)
+	{
+		found = genc_lpht_find_obj(&table, &key, struct lpht_test_item);
+		assert(found);
+		/* pre-existing items stay, otherwise the first occurrence wins */
+		if (key % 7 == 0 && key <= 700)
+			assert(found->val == 0);
+		else
+			assert(found->val == first_index[key]);
+	}
+	assert(!genc_lpht_find(&table, &key));
+	count = genc_lpht_bulk_load(&table, items, 0);
+	assert(count == 0);
+	genc_lpht_destroy(&table);
+	
+	/* growing to fit the whole input fails (though the scratch space and
+	 * smaller steps succeed), so items are inserted one at a time rather
+	 * than overfilling the table */
+	desc.realloc_fn = lpht_test_limited_realloc;
+	limit = 128 * sizeof(struct lpht_test_item) + 128;
+	ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, &limit, 64);
+	assert(ok);
+	assert(genc_lpht_capacity(&table) == 64);
+	count = genc_lpht_bulk_load(&table, items, 100);
+	assert(count == 100);
+	assert(genc_lpht_count(&table) == 100);
+	assert(genc_lpht_capacity(&table) == 128);
+	assert(genc_lpht_verify(&table));
+#if GENC_HASH_TABLE_STATS
+	/* each item is counted once, by the individual insertion */
+	assert(table.table.stats.inserts == 100);
+#endif
+	for (i = 0; i < count; ++i)
+	{
+		found = genc_lpht_find_obj(&table, &items[i].key, struct lpht_test_item);
+		assert(found && found->val == items[i].val);
+	}
+	genc_lpht_destroy(&table);
+	free(items);
+	free(first_index);
+}
+
+/* Seed 0 stands in for a seed known to an attacker: all keys collide */
+static genc_hash_t weak_seeded_hash(void* key, uint64_t seed, void* opaque)
+{
+	if (seed == 0)
+		return 0;
+	return genc_uint64_key_hash_seeded(key, seed, opaque);
+}
+
+static void test_reseeding(unsigned flags)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	struct lpht_test_item item;
+	struct lpht_test_item* found;
+	uint64_t key;
+	genc_linear_probing_hash_table_desc_init(
+		&desc, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+		lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+		sizeof(struct lpht_test_item), 70, 20);
+	desc.flags |= flags;
+	desc.seeded_hash_fn = weak_seeded_hash;
+	desc.max_probe_length = 64;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 64);
+	assert(ok);
+	
+	for (key = 1; key <= 2000; ++key)
+	{
+		item.key = key;
+		item.val = key * 3;
+		found = genc_lpht_insert_obj(&table, &item, struct lpht_test_item);
+		/* the returned bucket must be valid even if the insertion reseeded */
+		assert(found && found->key == key && found->val == key * 3);
+	}
+	assert(table.table.reseed_count >= 1);
+	assert(table.table.seed != 0);
+	assert(genc_lpht_verify(&table));
+	
+	ok = genc_lpht_set_seed(&table, 12345);
+	assert(ok);
+	assert(genc_lpht_verify(&table));
+	for (key = 1; key <= 2000; ++key)
+	{
+		found = genc_lpht_find_obj(&table, &key, struct lpht_test_item);
+		assert(found && found->val == key * 3);
+	}
+	genc_lpht_destroy(&table);
+}
+
+static void test_stats(unsigned flags)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	genc_hash_table_stats_snapshot_t snap;
+	struct lpht_test_item item;
+	void* inserted;
+	uint64_t key;
+	size_t i, total;
+	genc_linear_probing_hash_table_desc_init_inline_key(
+		&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+		offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 70, 20);
+	desc.flags |= flags;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	
+	for (key = 1; key <= 1000; ++key)
+	{
+		item.key = key;
+		item.val = key;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	item.key = 500;
+	inserted = genc_lpht_insert_item(&table, &item);
+	assert(!inserted);
+	for (key = 1; key <= 1500; ++key)
+		assert(!genc_lpht_find(&table, &key) == (key > 1000));
+	for (key = 1; key <= 1000; key += 2)
+		genc_lpht_remove(&table, genc_lpht_find(&table, &key));
+	
+	genc_lpht_stats_snapshot(&table, &snap);
+	assert(snap.item_count == 500);
+	assert(snap.capacity == genc_lpht_capacity(&table));
+	total = 0;
+	for (i = 0; i < GENC_HASH_STATS_HISTOGRAM_BINS; ++i)
+		total += snap.chain_lengths[i];
+	assert(total == 500);
+	assert(snap.longest_chain < snap.capacity);
+	assert(snap.chain_lengths[genc_hash_stats_histogram_bin(snap.longest_chain)] > 0);
+#if GENC_HASH_TABLE_STATS
+	assert(snap.ops.inserts == 1001);
+	assert(snap.ops.insert_duplicates == 1);
+	assert(snap.ops.lookups == 2000);
+	assert(snap.ops.lookup_hits == 1500);
+	assert(snap.ops.removes == 500);
+	assert(snap.ops.resizes >= 6);
+	assert(snap.ops.items_moved > 0);
+	assert(snap.ops.bytes_moved >= snap.ops.items_moved * sizeof(struct lpht_test_item));
+	total = 0;
+	for (i = 0; i < GENC_HASH_STATS_HISTOGRAM_BINS; ++i)
+		total += snap.ops.probe_lengths[i];
+	assert(total == 1000 + 2000);
+#else
+	assert(snap.ops.inserts == 0 && snap.ops.lookups == 0);
+#endif
+	genc_lpht_destroy(&table);
+}
+
+static genc_bool_t lpht_test_key_divisible(void* item, void* data)
+{
+	return ((struct lpht_test_item*)item)->key % *(uint64_t*)data == 0;
+}
+
+static genc_bool_t lpht_test_key_above(void* item, void* data)
+{
+	return ((struct lpht_test_item*)item)->key > *(uint64_t*)data;
+}
+
+static void test_remove_if(unsigned flags, genc_bool_t inline_key)
+{
+	genc_linear_probing_hash_table_t table;
+	genc_linear_probing_hash_table_desc_t desc;
+	struct lpht_test_item item, *found;
+	void* inserted;
+	uint64_t key, divisor;
+	size_t capacity, removed;
+	if (inline_key)
+		genc_linear_probing_hash_table_desc_init_inline_key(
+			&desc, genc_uint64_key_hash, lpht_test_realloc, sizeof(struct lpht_test_item),
+			offsetof(struct lpht_test_item, key), sizeof(uint64_t), &empty_key, 90, 20);
+	else
+		genc_linear_probing_hash_table_desc_init(
+			&desc, genc_uint64_key_hash, lpht_test_item_get_key, genc_uint64_keys_equal,
+			lpht_test_item_is_empty, lpht_test_item_clear, lpht_test_realloc,
+			sizeof(struct lpht_test_item), 90, 20);
+	desc.flags |= flags;
+	genc_bool_t ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 16);
+	assert(ok);
+	
+	/* at 90% load, removing every third key leaves plenty of displaced items */
+	ok = genc_lpht_resize(&table, 4096);
+	assert(ok);
+	for (key = 1; key <= 4096 * 9 / 10; ++key)
+	{
+		item.key = key;
+		item.val = key * 3;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	divisor = 3;
+	removed = genc_lpht_remove_if(&table, lpht_test_key_divisible, &divisor);
+	assert(removed == 4096 * 9 / 10 / 3);
+	assert(genc_lpht_count(&table) == 4096 * 9 / 10 - 4096 * 9 / 10 / 3);
+	assert(genc_lpht_capacity(&table) == 4096);
+	assert(genc_lpht_verify(&table));
+	for (key = 1; key <= 5000; ++key)
+	{
+		found = genc_lpht_find_obj(&table, &key, struct lpht_test_item);
+		assert(!found == (key % 3 == 0 || key > 4096 * 9 / 10));
+		assert(!found || found->val == key * 3);
+	}
+	removed = genc_lpht_remove_if(&table, lpht_test_key_divisible, &divisor);
+	assert(removed == 0);
+	
+	/* dropping below the shrink threshold shrinks once, at the end */
+	divisor = 300;
+	removed = genc_lpht_remove_if(&table, lpht_test_key_above, &divisor);
+	assert(removed == 4096 * 9 / 10 - 4096 * 9 / 10 / 3 - 200);
+	assert(genc_lpht_count(&table) == 200);
+	assert(genc_lpht_capacity(&table) < 4096);
+	assert(genc_lpht_verify(&table));
+	for (key = 1; key <= 300; ++key)
+		assert(!genc_lpht_find(&table, &key) == (key % 3 == 0));
+	genc_lpht_destroy(&table);
+	
+	/* a completely full table has no empty bucket to start the sweep from */
+	desc.load_percent_grow_threshold = 100;
+	desc.load_percent_shrink_threshold = 0;
+	ok = genc_linear_probing_hash_table_init_with_desc(&table, &desc, NULL, 64);
+	assert(ok);
+	capacity = genc_lpht_capacity(&table);
+	for (key = 1; key <= capacity; ++key)
+	{
+		item.key = key;
+		item.val = key * 3;
+		inserted = genc_lpht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	assert(genc_lpht_capacity(&table) == capacity);
+	divisor = 5;
+	removed = genc_lpht_remove_if(&table, lpht_test_key_divisible, &divisor);
+	assert(removed == capacity / 5);
+	assert(genc_lpht_count(&table) == capacity - capacity / 5);
+	assert(genc_lpht_verify(&table));
+	for (key = 1; key <= capacity; ++key)
+		assert(!genc_lpht_find(&table, &key) == (key % 5 == 0));
+	genc_lpht_destroy(&table);
+}
+
+int main(void)
+{
+	test_callbacks();
+	test_inline_key();
+	test_stored_hashes();
+	test_robin_hood(0, false);
+	test_robin_hood(GENC_LPHT_STORE_HASHES, false);
+	test_robin_hood(0, true);
+	test_incremental_resize(0, false);
+	test_incremental_resize(GENC_LPHT_STORE_HASHES, false);
+	test_incremental_resize(0, true);
+	test_bulk_load(0, false);
+	test_bulk_load(GENC_LPHT_STORE_HASHES, false);
+	test_bulk_load(GENC_LPHT_ROBIN_HOOD, true);
+	test_reseeding(0);
+	test_reseeding(GENC_LPHT_STORE_HASHES);
+	test_reseeding(GENC_LPHT_ROBIN_HOOD);
+	test_stats(0);
+	test_stats(GENC_LPHT_ROBIN_HOOD);
+	test_remove_if(0, false);
+	test_remove_if(GENC_LPHT_STORE_HASHES, false);
+	test_remove_if(GENC_LPHT_ROBIN_HOOD, false);
+	test_remove_if(GENC_LPHT_ROBIN_HOOD | GENC_LPHT_STORE_HASHES, false);
+	test_remove_if(0, true);
+	test_remove_if(GENC_LPHT_ROBIN_HOOD, true);
+	printf("Linear probing hash table tests passed\n");
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/lock_free_hash_table.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 5000
+#define SHARED_KEYS 1000
+
+static void* lfht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	return realloc(old, new_size);
+}
+
+/* Values are just tagged key/thread combinations, never dereferenced */
+static void* lfht_test_value(uint64_t key, unsigned thread)
+{
+	return (void*)(uintptr_t)(((key + 1) << 4) | thread);
+}
+
+static genc_lock_free_hash_table_t table;
+static unsigned shared_key_wins[NUM_THREADS];
+
+static void* worker_thread(void* arg)
+{
+	unsigned thread = (unsigned)(uintptr_t)arg;
+	uint64_t first = 1000000u + (uint64_t)thread * KEYS_PER_THREAD;
+	uint64_t key;
+	genc_bool_t ok;
+	void* value;
+
+	for (key = first; key < first + KEYS_PER_THREAD; ++key)
+	{
+		ok = genc_lfht_insert_item(&table, key, lfht_test_value(key, thread));
+		assert(ok);
+	}
+
+	/* all threads race for the same keys, exactly one must win each */
+	for (key = 1; key <= SHARED_KEYS; ++key)
+	{
+		if (genc_lfht_insert_item(&table, key, lfht_test_value(key, thread)))
+			++shared_key_wins[thread];
+		assert(genc_lfht_find(&table, key) != NULL);
+	}
+
+	for (key = first; key < first + KEYS_PER_THREAD; ++key)
+	{
+		assert(genc_lfht_find(&table, key) == lfht_test_value(key, thread));
+		if (key % 2)
+		{
+			value = genc_lfht_remove(&table, key);
+			assert(value == lfht_test_value(key, thread));
+		}
+		else
+		{
+			value = genc_lfht_insert_or_update_item(&table, key, lfht_test_value(key, 0xf));
+			assert(value == lfht_test_value(key, thread));
+		}
+	}
+	return NULL;
+}
+
+static void test_concurrent(void)
+{
+	pthread_t threads[NUM_THREADS];
+	unsigned i, wins = 0;
+	uint64_t key;
+	genc_bool_t ok;
+	int res;
+
+	ok = genc_lock_free_hash_table_init(&table, lfht_test_realloc, NULL, 1u << 15);
+	assert(ok);
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		res = pthread_create(&threads[i], NULL, worker_thread, (void*)(uintptr_t)i);
+		assert(res == 0);
+	}
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		pthread_join(threads[i], NULL);
+		wins += shared_key_wins[i];
+	}
+	assert(wins == SHARED_KEYS);
+	assert(genc_lfht_count(&table) == SHARED_KEYS + NUM_THREADS * KEYS_PER_THREAD / 2);
+
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		uint64_t first = 1000000u + (uint64_t)i * KEYS_PER_THREAD;
+		for (key = first; key < first + KEYS_PER_THREAD; ++key)
+		{
+			if (key % 2)
+				assert(!genc_lfht_find(&table, key));
+			else
+				assert(genc_lfht_find(&table, key) == lfht_test_value(key, 0xf));
+		}
+	}
+	genc_lfht_destroy(&table);
+}
+
+int main(void)
+{
+	genc_lock_free_hash_table_t t;
+	uint64_t key;
+	int dummy;
+	genc_bool_t ok;
+	void* value;
+
+	ok = genc_lock_free_hash_table_init(&t, lfht_test_realloc, NULL, 100);
+	assert(!ok);
+	ok = genc_lock_free_hash_table_init(&t, lfht_test_realloc, NULL, 16);
+	assert(ok);
+	assert(genc_lfht_capacity(&t) == 16);
+	assert(genc_lfht_count(&t) == 0);
+
+	/* key 0 is an ordinary key; NULL values are rejected */
+	assert(!genc_lfht_find(&t, 0));
+	ok = genc_lfht_insert_item(&t, 0, NULL);
+	assert(!ok);
+	ok = genc_lfht_insert_item(&t, 0, &dummy);
+	assert(ok);
+	ok = genc_lfht_insert_item(&t, 0, &dummy);
+	assert(!ok);
+	assert(genc_lfht_find(&t, 0) == &dummy);
+	value = genc_lfht_remove(&t, 0);
+	assert(value == &dummy);
+	assert(!genc_lfht_find(&t, 0));
+
+	/* fill every bucket */
+	for (key = 1; key <= 16; ++key)
+	{
+		ok = genc_lfht_insert_item(&t, key, lfht_test_value(key, 0));
+		assert(ok);
+	}
+	assert(genc_lfht_count(&t) == 16);
+	ok = genc_lfht_insert_item(&t, 17, lfht_test_value(17, 0));
+	assert(!ok);
+	value = genc_lfht_insert_or_update_item(&t, 17, lfht_test_value(17, 0));
+	assert(!value);
+	assert(!genc_lfht_find(&t, 17));
+
+	/* removal leaves a tombstone, so only the same key can reuse the bucket */
+	value = genc_lfht_remove(&t, 5);
+	assert(value == lfht_test_value(5, 0));
+	value = genc_lfht_remove(&t, 5);
+	assert(!value);
+	assert(!genc_lfht_find(&t, 5));
+	assert(genc_lfht_count(&t) == 15);
+	ok = genc_lfht_insert_item(&t, 17, lfht_test_value(17, 0));
+	assert(!ok);
+	value = genc_lfht_insert_or_update_item(&t, 5, lfht_test_value(5, 1));
+	assert(!value);
+	assert(genc_lfht_find(&t, 5) == lfht_test_value(5, 1));
+	value = genc_lfht_insert_or_update_item(&t, 5, lfht_test_value(5, 2));
+	assert(value == lfht_test_value(5, 1));
+	assert(genc_lfht_count(&t) == 16);
+	for (key = 1; key <= 16; ++key)
+		assert(genc_lfht_find(&t, key) == lfht_test_value(key, key == 5 ? 2 : 0));
+	genc_lfht_destroy(&t);
+
+	test_concurrent();
+	return 0;
+}
@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/perfect_hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct mph_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+static void* mph_test_get_key(void* item, void* opaque)
+{
+	return &((struct mph_test_item*)item)->key;
+}
+
+static void* mph_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+/* Weak hash: the table must not rely on the client hash's bit distribution */
+static genc_hash_t identity_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)*(uint64_t*)key;
+}
+
+static void test_build_and_find(genc_key_hash_fn hash_fn, size_t count)
+{
+	genc_perfect_hash_table_t table;
+	struct mph_test_item* items = calloc(count, sizeof(items[0]));
+	char* slot_used = calloc(count + 1, 1);
+	size_t i;
+	uint64_t key;
+	genc_bool_t ok;
+
+	for (i = 0; i < count; ++i)
+	{
+		items[i].key = i * 7 + 3;
+		items[i].val = i;
+	}
+	ok = genc_perfect_hash_table_build(
+		&table, hash_fn, mph_test_get_key, genc_uint64_keys_equal,
+		mph_test_realloc, NULL, sizeof(struct mph_test_item), items, count);
+	assert(ok);
+	assert(genc_mph_count(&table) == count);
+
+	for (i = 0; i < count; ++i)
+	{
+		struct mph_test_item* found;
+		size_t slot;
+		key = items[i].key;
+		slot = genc_mph_slot(&table, &key);
+		/* minimal and perfect: every key has its own slot below count */
+		assert(slot < count && !slot_used[slot]);
+		slot_used[slot] = 1;
+		found = genc_mph_find_obj(&table, &key, struct mph_test_item);
+		assert(found == genc_mph_item_at(&table, slot));
+		assert(found->key == key && found->val == i);
+	}
+	/* keys outside the set are rejected by the key check */
+	for (key = 0; key < count * 7 + 10; ++key)
+	{
+		if (key % 7 != 3 || key >= count * 7)
+			assert(!genc_mph_find(&table, &key));
+	}
+	if (count >= 10000)
+		assert(genc_mph_index_size(&table) * 8 < count * 3 + count / 10);
+
+	genc_mph_destroy(&table);
+	free(slot_used);
+	free(items);
+}
+
+static void test_duplicates(void)
+{
+	genc_perfect_hash_table_t table;
+	struct mph_test_item items[100];
+	size_t i;
+	genc_bool_t ok;
+	for (i = 0; i < 100; ++i)
+	{
+		items[i].key = i;
+		items[i].val = i;
+	}
+	items[60].key = 10;
+	ok = genc_perfect_hash_table_build(
+		&table, genc_uint64_key_hash, mph_test_get_key, genc_uint64_keys_equal,
+		mph_test_realloc, NULL, sizeof(struct mph_test_item), items, 100);
+	assert(!ok);
+}
+
+int main(void)
+{
+	test_build_and_find(genc_uint64_key_hash, 0);
+	test_build_and_find(genc_uint64_key_hash, 1);
+	test_build_and_find(genc_uint64_key_hash, 17);
+	test_build_and_find(genc_uint64_key_hash, 1000);
+	test_build_and_find(genc_uint64_key_hash, 100000);
+	test_build_and_find(identity_hash, 100000);
+	test_duplicates();
+
+	printf("perfect_hash_table tests passed\n");
+	return 0;
+}
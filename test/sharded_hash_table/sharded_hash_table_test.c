@@ -0,0 +1,182 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/sharded_hash_table.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 5000
+#define SHARD_COUNT_LOG2 3
+
+static void* sht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	return realloc(old, new_size);
+}
+
+static genc_hash_t sht_test_hash(void* key, void* opaque)
+{
+	/* deliberately weak, the shard selection has to cope */
+	return (genc_hash_t)*(uint64_t*)key;
+}
+
+struct cht_entry
+{
+	struct slist_head hash_head;
+	uint64_t key;
+};
+
+static void* sht_test_get_key(struct slist_head* hash_head, void* opaque)
+{
+	return &genc_container_of(hash_head, struct cht_entry, hash_head)->key;
+}
+
+static genc_bool_t sht_test_keys_equal(void* key1, void* key2, void* opaque)
+{
+	return *(uint64_t*)key1 == *(uint64_t*)key2;
+}
+
+struct lpht_entry
+{
+	uint64_t key;
+	uint64_t value;
+};
+
+static const uint64_t empty_key = 0;
+
+static genc_sharded_cht_t cht;
+static genc_sharded_lpht_t lpht;
+static struct cht_entry cht_entries[NUM_THREADS * KEYS_PER_THREAD];
+
+static void* worker_thread(void* arg)
+{
+	unsigned thread = (unsigned)(uintptr_t)arg;
+	size_t first = (size_t)thread * KEYS_PER_THREAD, i;
+	struct slist_head* removed;
+	genc_bool_t ok;
+
+	for (i = first; i < first + KEYS_PER_THREAD; ++i)
+	{
+		struct lpht_entry e;
+		e.key = i + 1;
+		e.value = i * 3;
+		cht_entries[i].key = i + 1;
+		ok = genc_sharded_cht_insert_item(&cht, &cht_entries[i].hash_head);
+		assert(ok);
+		ok = genc_sharded_cht_insert_item(&cht, &cht_entries[i].hash_head);
+		assert(!ok);
+		ok = genc_sharded_lpht_insert_item(&lpht, &e);
+		assert(ok);
+		ok = genc_sharded_lpht_insert_item(&lpht, &e);
+		assert(!ok);
+	}
+	for (i = first; i < first + KEYS_PER_THREAD; ++i)
+	{
+		struct lpht_entry e;
+		uint64_t key = i + 1;
+		assert(genc_sharded_cht_find(&cht, &key) == &cht_entries[i].hash_head);
+		ok = genc_sharded_lpht_find(&lpht, &key, &e);
+		assert(ok);
+		assert(e.key == key && e.value == i * 3);
+		if (i % 2)
+		{
+			removed = genc_sharded_cht_remove(&cht, &key);
+			assert(removed == &cht_entries[i].hash_head);
+			e.value = 0;
+			ok = genc_sharded_lpht_remove(&lpht, &key, &e);
+			assert(ok);
+			assert(e.value == i * 3);
+			ok = genc_sharded_lpht_remove(&lpht, &key, NULL);
+			assert(!ok);
+		}
+		else
+		{
+			ok = genc_sharded_cht_remove_item(&cht, &cht_entries[i].hash_head);
+			assert(ok);
+			ok = genc_sharded_cht_remove_item(&cht, &cht_entries[i].hash_head);
+			assert(!ok);
+			e.value = i;
+			ok = genc_sharded_lpht_insert_or_update_item(&lpht, &e);
+			assert(ok);
+		}
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	genc_linear_probing_hash_table_desc_t desc;
+	pthread_t threads[NUM_THREADS];
+	unsigned i;
+	uint64_t key;
+	genc_bool_t ok;
+	int res;
+
+	genc_linear_probing_hash_table_desc_init_inline_key(
+		&desc, sht_test_hash, sht_test_realloc, sizeof(struct lpht_entry),
+		offsetof(struct lpht_entry, key), sizeof(uint64_t), &empty_key, 70, 20);
+
+	ok = genc_sharded_cht_init(&cht, sht_test_hash, sht_test_get_key, sht_test_keys_equal, sht_test_realloc, NULL, SHARD_COUNT_LOG2, 8, 100, 20);
+	assert(ok);
+	ok = genc_sharded_lpht_init(&lpht, &desc, NULL, SHARD_COUNT_LOG2, 8);
+	assert(ok);
+
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		res = pthread_create(&threads[i], NULL, worker_thread, (void*)(uintptr_t)i);
+		assert(res == 0);
+	}
+	for (i = 0; i < NUM_THREADS; ++i)
+		pthread_join(threads[i], NULL);
+
+	assert(genc_sharded_cht_count(&cht) == 0);
+	assert(genc_sharded_lpht_count(&lpht) == NUM_THREADS * KEYS_PER_THREAD / 2);
+
+	/* sequential keys with an identity hash still spread over all shards */
+	for (i = 0; i < (1u << SHARD_COUNT_LOG2); ++i)
+		assert(genc_lphtl_count(&lpht.shards[i].table) > 0);
+
+	for (key = 1; key <= NUM_THREADS * KEYS_PER_THREAD; ++key)
+	{
+		struct lpht_entry e;
+		assert(!genc_sharded_cht_find(&cht, &key));
+		if ((key - 1) % 2)
+		{
+			ok = genc_sharded_lpht_find(&lpht, &key, NULL);
+			assert(!ok);
+		}
+		else
+		{
+			ok = genc_sharded_lpht_find(&lpht, &key, &e);
+			assert(ok);
+			assert(e.value == key - 1);
+			assert(genc_sharded_lpht_shard_for_key(&lpht, &key) == genc_sharded_lpht_shard_for_key(&lpht, &e.key));
+		}
+	}
+
+	genc_sharded_cht_destroy(&cht);
+	genc_sharded_lpht_destroy(&lpht);
+	return 0;
+}
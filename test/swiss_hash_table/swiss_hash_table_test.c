@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2026 genccont contributors
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.
+*/
+
+#include "../../src/swiss_hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+struct sht_test_item
+{
+	uint64_t key;
+	uint64_t val;
+};
+
+static void* sht_test_get_key(void* item, void* opaque)
+{
+	return &((struct sht_test_item*)item)->key;
+}
+
+static void* sht_test_realloc(void* old, size_t old_size, size_t new_size, void* opaque)
+{
+	if (new_size == 0)
+	{
+		free(old);
+		return NULL;
+	}
+	return realloc(old, new_size);
+}
+
+/* Deliberately weak hash, so that many keys share groups and control tags */
+static genc_hash_t identity_hash(void* key, void* opaque)
+{
+	return (genc_hash_t)*(uint64_t*)key;
+}
+
+/* Inserts and removes pseudo-random keys, comparing against a shadow array */
+static void test_random_ops(genc_swiss_hash_table_t* table)
+{
+	const size_t key_range = 5000;
+	char* present = calloc(1, key_range);
+	size_t count = 0, i;
+	struct sht_test_item item, *found;
+	void* inserted;
+
+	srand(42);
+	for (i = 0; i < key_range * 20; ++i)
+	{
+		uint64_t key = rand() % key_range;
+		item.key = key;
+		item.val = key * 3;
+		found = genc_sht_find_obj(table, &key, struct sht_test_item);
+		if (present[key])
+		{
+			assert(found && found->key == key && found->val == key * 3);
+			inserted = genc_sht_insert_item(table, &item);
+			assert(!inserted);
+			genc_sht_remove(table, found);
+			present[key] = 0;
+			--count;
+			assert(!genc_sht_find(table, &key));
+		}
+		else
+		{
+			assert(!found);
+			found = genc_sht_insert_obj(table, &item, struct sht_test_item);
+			assert(found && found->key == key);
+			present[key] = 1;
+			++count;
+		}
+		assert(genc_sht_count(table) == count);
+		if (i % 4096 == 0)
+			assert(genc_sht_verify(table));
+	}
+	assert(genc_sht_verify(table));
+
+	i = 0;
+	genc_sht_for_each_obj(struct sht_test_item, obj, table)
+	{
+		assert(present[obj->key]);
+		++i;
+	}
+	assert(i == count);
+	free(present);
+}
+
+static void test_high_load(void)
+{
+	genc_swiss_hash_table_t table;
+	struct sht_test_item item, *found;
+	void* inserted;
+	uint64_t key;
+	size_t capacity;
+	genc_bool_t ok;
+	ok = genc_swiss_hash_table_init_ext(
+		&table, genc_uint64_key_hash, sht_test_get_key, genc_uint64_keys_equal,
+		sht_test_realloc, NULL, sizeof(struct sht_test_item), 1024, 95);
+	assert(ok);
+	capacity = genc_sht_capacity(&table);
+	for (key = 1; key <= capacity * 9 / 10; ++key)
+	{
+		item.key = key;
+		item.val = key;
+		inserted = genc_sht_insert_item(&table, &item);
+		assert(inserted);
+	}
+	/* no growth yet at 90% */
+	assert(genc_sht_capacity(&table) == capacity);
+	assert(genc_sht_verify(&table));
+	for (key = capacity; key < capacity * 2; ++key)
+		assert(!genc_sht_find(&table, &key));
+
+	/* update in place */
+	item.key = 7;
+	item.val = 70;
+	inserted = genc_sht_insert_or_update_item(&table, &item);
+	assert(inserted);
+	key = 7;
+	found = genc_sht_find_obj(&table, &key, struct sht_test_item);
+	assert(found && found->val == 70);
+
+	genc_sht_clear(&table);
+	assert(genc_sht_count(&table) == 0);
+	assert(!genc_sht_find(&table, &key));
+	ok = genc_sht_reserve_space(&table, capacity * 4);
+	assert(ok);
+	assert(genc_sht_capacity(&table) >= capacity * 4);
+	genc_sht_destroy(&table);
+}
+
+int main(void)
+{
+	genc_swiss_hash_table_t table;
+	genc_bool_t ok;
+
+	ok = genc_swiss_hash_table_init(
+		&table, genc_uint64_key_hash, sht_test_get_key, genc_uint64_keys_equal,
+		sht_test_realloc, NULL, sizeof(struct sht_test_item), 0);
+	assert(ok);
+	test_random_ops(&table);
+	genc_sht_destroy(&table);
+
+	ok = genc_swiss_hash_table_init(
+		&table, identity_hash, sht_test_get_key, genc_uint64_keys_equal,
+		sht_test_realloc, NULL, sizeof(struct sht_test_item), 64);
+	assert(ok);
+	test_random_ops(&table);
+	genc_sht_destroy(&table);
+
+	test_high_load();
+
+	printf("swiss_hash_table tests passed\n");
+	return 0;
+}